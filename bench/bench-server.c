@@ -0,0 +1,120 @@
+/*
+Plugin Name
+Copyright (C) <Year> <Developer> <Email Address>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+/* Runs the plugin's web server core against the libobs stand-in in shim/,
+   for the load generator or manual poking with curl. */
+
+#include "shim.h"
+
+#include <tbar-web.h>
+
+#include <obs.h>
+
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+static volatile sig_atomic_t g_stop;
+
+static void on_signal(int sig)
+{
+	(void)sig;
+	g_stop = 1;
+}
+
+static void usage(void)
+{
+	fprintf(stderr, "usage: tbar-bench-server [--port N] [--udp-port N] [--tick-apply 0|1]\n"
+			"                         [--interpolation off|linear|catmull-rom] [--jitter-delay-ms N]\n"
+			"                         [--header-timeout-ms N] [--body-timeout-ms N]\n"
+			"                         [--max-connections N] [--lease-mode off|reject|queue]\n"
+			"                         [--lease-ms N] [--record PATH] [--record-max-mb N]\n"
+			"                         [--web-root DIR] [--web-cache-mb N] [--verbose]\n");
+}
+
+int main(int argc, char **argv)
+{
+	for (int i = 1; i < argc; i++) {
+		const char *arg = argv[i];
+		const char *val = i + 1 < argc ? argv[i + 1] : NULL;
+
+		if (strcmp(arg, "--verbose") == 0) {
+			shim_set_log_level(LOG_DEBUG);
+			continue;
+		}
+		if (!val) {
+			usage();
+			return 2;
+		}
+		i++;
+
+		if (strcmp(arg, "--port") == 0) {
+			shim_config_set_int("port", atoi(val));
+		} else if (strcmp(arg, "--udp-port") == 0) {
+			shim_config_set_bool("udp_enabled", true);
+			shim_config_set_int("udp_port", atoi(val));
+		} else if (strcmp(arg, "--tick-apply") == 0) {
+			shim_config_set_bool("tick_apply", atoi(val) != 0);
+		} else if (strcmp(arg, "--interpolation") == 0) {
+			shim_config_set_string("interpolation", val);
+		} else if (strcmp(arg, "--jitter-delay-ms") == 0) {
+			shim_config_set_int("jitter_delay_ms", atoi(val));
+		} else if (strcmp(arg, "--header-timeout-ms") == 0) {
+			shim_config_set_int("header_timeout_ms", atoi(val));
+		} else if (strcmp(arg, "--body-timeout-ms") == 0) {
+			shim_config_set_int("body_timeout_ms", atoi(val));
+		} else if (strcmp(arg, "--max-connections") == 0) {
+			shim_config_set_int("max_connections", atoi(val));
+		} else if (strcmp(arg, "--lease-mode") == 0) {
+			shim_config_set_string("lease_mode", val);
+		} else if (strcmp(arg, "--lease-ms") == 0) {
+			shim_config_set_int("lease_ms", atoi(val));
+		} else if (strcmp(arg, "--record") == 0) {
+			shim_config_set_string("record_path", val);
+		} else if (strcmp(arg, "--record-max-mb") == 0) {
+			shim_config_set_int("record_max_mb", atoi(val));
+		} else if (strcmp(arg, "--web-root") == 0) {
+			shim_config_set_string("web_root", val);
+		} else if (strcmp(arg, "--web-cache-mb") == 0) {
+			shim_config_set_int("web_cache_mb", atoi(val));
+		} else {
+			usage();
+			return 2;
+		}
+	}
+	shim_config_set_bool("enabled", true);
+
+	signal(SIGINT, on_signal);
+	signal(SIGTERM, on_signal);
+	signal(SIGPIPE, SIG_IGN);
+
+	tbar_web_apply_config();
+
+	/* The load generator waits for this line */
+	printf("ready\n");
+	fflush(stdout);
+
+	while (!g_stop)
+		pause();
+
+	tbar_web_close_config();
+	tbar_web_stop();
+	return 0;
+}
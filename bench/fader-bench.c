@@ -0,0 +1,195 @@
+/*
+Plugin Name
+Copyright (C) <Year> <Developer> <Email Address>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+/* Microbenchmark for the transition state machine (src/tbar-fader.c) on its
+   own: simulated fader moves against a backend that only counts calls, with
+   a simulated clock. Reports the cost of one decision per scenario and checks
+   that every move ended the way it should. Prints one JSON object. */
+
+#define _GNU_SOURCE
+
+#include <tbar-fader.h>
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define FRAME_MS 16 /* between two updates of a move */
+#define GAP_MS 400  /* between two moves, past both debounces */
+#define STEPS 32    /* updates per move, the release included */
+
+struct counting_backend {
+	unsigned begin_result;
+	bool fixed;
+	uint64_t starts, set_times, finishes, cancels, cuts, clears;
+};
+
+static unsigned cb_begin(void *ctx, bool *fixed)
+{
+	struct counting_backend *b = ctx;
+	*fixed = b->fixed;
+	return b->begin_result;
+}
+
+static unsigned cb_load_scenes(void *ctx)
+{
+	(void)ctx;
+	return 0;
+}
+
+static bool cb_start(void *ctx)
+{
+	((struct counting_backend *)ctx)->starts++;
+	return true;
+}
+
+static void cb_set_time(void *ctx, double t)
+{
+	(void)t;
+	((struct counting_backend *)ctx)->set_times++;
+}
+
+static void cb_finish(void *ctx)
+{
+	((struct counting_backend *)ctx)->finishes++;
+}
+
+static void cb_cancel(void *ctx)
+{
+	((struct counting_backend *)ctx)->cancels++;
+}
+
+static void cb_cut(void *ctx)
+{
+	((struct counting_backend *)ctx)->cuts++;
+}
+
+static void cb_clear(void *ctx)
+{
+	((struct counting_backend *)ctx)->clears++;
+}
+
+static void cb_end(void *ctx)
+{
+	(void)ctx;
+}
+
+static const struct tbar_fader_backend g_backend = {
+	.begin = cb_begin,
+	.load_scenes = cb_load_scenes,
+	.start = cb_start,
+	.set_time = cb_set_time,
+	.finish = cb_finish,
+	.cancel = cb_cancel,
+	.cut = cb_cut,
+	.clear = cb_clear,
+	.end = cb_end,
+};
+
+enum scenario {
+	SCENARIO_FINISH,       /* 0 -> 1, release at 1 */
+	SCENARIO_CANCEL,       /* 0 -> 0.5 -> 0, release at 0 */
+	SCENARIO_FIXED_CUT,    /* fixed transition, release at 1 */
+	SCENARIO_RELEASE_SPAM, /* release on every update: all but one debounced */
+	SCENARIO_IGNORED,      /* main output outside Studio Mode */
+	SCENARIO_COUNT,
+};
+
+static const char *g_names[SCENARIO_COUNT] = {"finish", "cancel", "fixed_cut", "release_spam", "ignored"};
+
+static double position_at(enum scenario s, int step)
+{
+	double x = (double)step / (STEPS - 1);
+	if (s == SCENARIO_CANCEL)
+		return x < 0.5 ? x : 1.0 - x;
+	return x;
+}
+
+static uint64_t now_ns(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static volatile double g_sink;
+
+/* Each move must have ended the way its scenario says */
+static bool check(enum scenario s, const struct counting_backend *b, uint64_t moves, uint64_t debounced)
+{
+	switch (s) {
+	case SCENARIO_FINISH:
+		return b->starts == moves && b->finishes == moves;
+	case SCENARIO_CANCEL:
+		return b->starts == moves && b->cancels == moves;
+	case SCENARIO_FIXED_CUT:
+		return b->starts == 0 && b->cuts == moves;
+	case SCENARIO_RELEASE_SPAM:
+		return b->starts == moves && debounced > 0;
+	default:
+		return b->starts == 0 && b->set_times == 0;
+	}
+}
+
+int main(int argc, char **argv)
+{
+	long moves = argc > 1 ? atol(argv[1]) : 1000000;
+	if (moves <= 0) {
+		fprintf(stderr, "usage: tbar-fader-bench [moves per scenario]\n");
+		return 2;
+	}
+
+	bool ok = true;
+	printf("{\"moves\":%ld,\"updates_per_move\":%d,\"scenarios\":{", moves, STEPS);
+	for (int s = 0; s < SCENARIO_COUNT; s++) {
+		struct counting_backend b = {
+			.begin_result = s == SCENARIO_IGNORED ? TBAR_FADER_IGNORED : 0,
+			.fixed = s == SCENARIO_FIXED_CUT,
+		};
+		struct tbar_fader fader = {0};
+		uint64_t clock_ms = 1000;
+		uint64_t debounced = 0;
+
+		uint64_t start = now_ns();
+		for (long m = 0; m < moves; m++) {
+			for (int i = 0; i < STEPS; i++) {
+				bool release = s == SCENARIO_RELEASE_SPAM || i == STEPS - 1;
+				double left;
+				unsigned flags = tbar_fader_update(&fader, &g_backend, &b, position_at(s, i), release,
+								   clock_ms, &left);
+				debounced += (flags & TBAR_FADER_DEBOUNCED) != 0;
+				g_sink = left;
+				clock_ms += FRAME_MS;
+			}
+			clock_ms += GAP_MS;
+		}
+		double ns = (double)(now_ns() - start) / ((double)moves * STEPS);
+
+		bool move_ok = check(s, &b, (uint64_t)moves, debounced);
+		ok = ok && move_ok;
+
+		printf("%s\"%s\":{\"ns_per_update\":%.2f,\"starts\":%llu,\"finishes\":%llu,\"cancels\":%llu,"
+		       "\"cuts\":%llu,\"debounced\":%llu,\"ok\":%s}",
+		       s ? "," : "", g_names[s], ns, (unsigned long long)b.starts, (unsigned long long)b.finishes,
+		       (unsigned long long)b.cancels, (unsigned long long)b.cuts, (unsigned long long)debounced,
+		       move_ok ? "true" : "false");
+	}
+	printf("}}\n");
+	return ok ? 0 : 1;
+}
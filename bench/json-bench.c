@@ -0,0 +1,159 @@
+/*
+Plugin Name
+Copyright (C) <Year> <Developer> <Email Address>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+/* Microbenchmark for the JSON field extractor against the strstr chain the
+   control endpoints used before (one scan per key). Prints one JSON object. */
+
+#define _GNU_SOURCE
+
+#include <tbar-json.h>
+
+#include <ctype.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static const struct {
+	const char *name;
+	const char *text;
+} g_cases[] = {
+	{"position", "{\"position\":0.5012}"},
+	{"position_release", "{\"position\":0.731,\"release\":false}"},
+	{"timed", "{\"position\":0.731,\"release\":true,\"timestamp\":1718000000123.25}"},
+	{"verbose_client", "{\"client\":\"stream-deck-plugin\",\"version\":\"2.4.1\",\"device\":{\"model\":\"XL\","
+			   "\"serial\":\"CL12345\"},\"seq\":918273,\"timestamp\":1718000000123.25,"
+			   "\"position\":0.25,\"release\":false}"},
+	{"config", "{\"enabled\":true,\"port\":4455}"},
+};
+
+#define NUM_CASES (sizeof(g_cases) / sizeof(g_cases[0]))
+
+static volatile double g_sink;
+
+static uint64_t now_ns(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/* ---- The previous implementation: one strstr per key ---- */
+
+static bool legacy_number(const char *body, const char *key, double *out)
+{
+	const char *p = strstr(body, key);
+	if (!p)
+		return false;
+	p = strchr(p, ':');
+	if (!p)
+		return false;
+	p++;
+	while (*p && isspace((unsigned char)*p))
+		p++;
+	char *end = NULL;
+	double v = strtod(p, &end);
+	if (end == p)
+		return false;
+	*out = v;
+	return true;
+}
+
+static bool legacy_bool(const char *body, const char *key, bool *out)
+{
+	const char *p = strstr(body, key);
+	if (!p)
+		return false;
+	p = strchr(p, ':');
+	if (!p)
+		return false;
+	p++;
+	while (*p && isspace((unsigned char)*p))
+		p++;
+	if (strncasecmp(p, "true", 4) == 0) {
+		*out = true;
+		return true;
+	}
+	if (strncasecmp(p, "false", 5) == 0) {
+		*out = false;
+		return true;
+	}
+	return false;
+}
+
+static void legacy_extract(const char *body)
+{
+	double pos = 0.0, ts = 0.0, port = 0.0;
+	bool release = false, enabled = false;
+	legacy_number(body, "position", &pos);
+	legacy_bool(body, "release", &release);
+	legacy_number(body, "timestamp", &ts);
+	legacy_bool(body, "enabled", &enabled);
+	legacy_number(body, "port", &port);
+	g_sink += pos + ts + port + release + enabled;
+}
+
+static void extract(const char *body, size_t len)
+{
+	struct tbar_json_fields f;
+	if (!tbar_json_extract(body, len, &f))
+		abort();
+	g_sink += f.position + f.timestamp + f.port + f.release + f.enabled;
+}
+
+static double run(bool legacy, const char *text, size_t len, double seconds)
+{
+	uint64_t iterations = 0;
+	uint64_t start = now_ns();
+	uint64_t deadline = start + (uint64_t)(seconds * 1e9);
+	uint64_t now;
+
+	do {
+		for (int i = 0; i < 10000; i++) {
+			if (legacy)
+				legacy_extract(text);
+			else
+				extract(text, len);
+		}
+		iterations += 10000;
+		now = now_ns();
+	} while (now < deadline);
+
+	return (double)(now - start) / (double)iterations;
+}
+
+int main(int argc, char **argv)
+{
+	double seconds = argc > 1 ? atof(argv[1]) : 0.5;
+	if (seconds <= 0.0) {
+		fprintf(stderr, "usage: tbar-json-bench [seconds per case]\n");
+		return 2;
+	}
+
+	printf("{\"seconds_per_case\":%.2f,\"cases\":{", seconds);
+	for (size_t c = 0; c < NUM_CASES; c++) {
+		size_t len = strlen(g_cases[c].text);
+		double single = run(false, g_cases[c].text, len, seconds);
+		double legacy = run(true, g_cases[c].text, len, seconds);
+		printf("%s\"%s\":{\"bytes\":%zu,\"single_pass_ns\":%.1f,\"legacy_strstr_ns\":%.1f,\"speedup\":%.2f}",
+		       c ? "," : "", g_cases[c].name, len, single, legacy, legacy / single);
+	}
+	printf("}}\n");
+	return 0;
+}
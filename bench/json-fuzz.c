@@ -0,0 +1,216 @@
+/*
+Plugin Name
+Copyright (C) <Year> <Developer> <Email Address>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+/* Fuzz harness for the JSON field extractor.
+
+   Built with -DBENCH_LIBFUZZER=ON (clang) this is a libFuzzer target; start it
+   with fuzz/json as the seed corpus. The default build is a standalone
+   driver that runs every seed and a fixed number of random mutations of it,
+   best combined with -DBENCH_SANITIZE=ON. Besides not crashing, every input
+   must satisfy:
+
+   - the result is deterministic
+   - an accepted object still parses, identically, with whitespace appended
+   - an accepted object is rejected with a trailing non-whitespace byte */
+
+#define _GNU_SOURCE
+
+#include <tbar-json.h>
+
+#include <dirent.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static bool same_fields(const struct tbar_json_fields *a, const struct tbar_json_fields *b)
+{
+	/* Compare field by field; NaN cannot occur, the extractor only yields finite or inf */
+	return a->present == b->present && a->position == b->position && a->release == b->release &&
+	       a->timestamp == b->timestamp && a->seq == b->seq && a->enabled == b->enabled && a->port == b->port &&
+	       strcmp(a->client_id, b->client_id) == 0 && strcmp(a->easing, b->easing) == 0 &&
+	       strcmp(a->scene, b->scene) == 0 && a->duration_ms == b->duration_ms && a->from == b->from &&
+	       a->to == b->to && a->abort == b->abort && a->ping == b->ping;
+}
+
+static void check(const uint8_t *data, size_t size)
+{
+	/* Exact-size copies so a sanitizer catches any read past the end */
+	char *buf = malloc(size + 1);
+	if (!buf)
+		abort();
+	memcpy(buf, data, size);
+
+	struct tbar_json_fields a, b;
+	bool ok = tbar_json_extract(buf, size, &a);
+	if (ok != tbar_json_extract(buf, size, &b) || (ok && !same_fields(&a, &b)))
+		abort();
+
+	/* Reading keyframes changes nothing else */
+	struct tbar_json_keyframe kf[4];
+	if (ok != tbar_json_extract_keyframes(buf, size, &b, kf, 4))
+		abort();
+	if (ok) {
+		if ((b.present & TBAR_JSON_KEYFRAMES) && (b.num_keyframes < 0 || b.num_keyframes > 4))
+			abort();
+		b.present &= ~(unsigned)TBAR_JSON_KEYFRAMES;
+		if (!same_fields(&a, &b))
+			abort();
+	}
+
+	if (ok) {
+		buf[size] = '\n';
+		if (!tbar_json_extract(buf, size + 1, &b) || !same_fields(&a, &b))
+			abort();
+		buf[size] = 'x';
+		if (tbar_json_extract(buf, size + 1, &b))
+			abort();
+	}
+	free(buf);
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size);
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+	check(data, size);
+	return 0;
+}
+
+#ifndef TBAR_LIBFUZZER
+
+static uint64_t g_rng = 0x9E3779B97F4A7C15ULL;
+
+static uint32_t rnd(uint32_t n)
+{
+	g_rng ^= g_rng << 13;
+	g_rng ^= g_rng >> 7;
+	g_rng ^= g_rng << 17;
+	return (uint32_t)(g_rng % n);
+}
+
+static const char g_alphabet[] = "{}[]\":,\\ \t\n0123456789.-+eEtruefalsnu/bfnrtpositionreleaseportclient_idkeyframes";
+
+static size_t mutate(uint8_t *buf, size_t len, size_t cap)
+{
+	int rounds = 1 + (int)rnd(4);
+	for (int i = 0; i < rounds; i++) {
+		switch (rnd(5)) {
+		case 0: /* replace a byte */
+			if (len)
+				buf[rnd((uint32_t)len)] = rnd(4) ? (uint8_t)g_alphabet[rnd(sizeof(g_alphabet) - 1)]
+								: (uint8_t)rnd(256);
+			break;
+		case 1: /* insert a byte */
+			if (len < cap) {
+				size_t at = rnd((uint32_t)len + 1);
+				memmove(buf + at + 1, buf + at, len - at);
+				buf[at] = (uint8_t)g_alphabet[rnd(sizeof(g_alphabet) - 1)];
+				len++;
+			}
+			break;
+		case 2: /* delete a byte */
+			if (len) {
+				size_t at = rnd((uint32_t)len);
+				memmove(buf + at, buf + at + 1, len - at - 1);
+				len--;
+			}
+			break;
+		case 3: /* duplicate a slice */
+			if (len) {
+				size_t from = rnd((uint32_t)len);
+				size_t n = 1 + rnd((uint32_t)(len - from));
+				if (len + n <= cap) {
+					size_t at = rnd((uint32_t)len + 1);
+					memmove(buf + at + n, buf + at, len - at);
+					memmove(buf + at, buf + (from >= at ? from + n : from), n);
+					len += n;
+				}
+			}
+			break;
+		default: /* truncate */
+			if (len)
+				len = rnd((uint32_t)len + 1);
+			break;
+		}
+	}
+	return len;
+}
+
+static int run_file(const char *path, int iterations)
+{
+	FILE *f = fopen(path, "rb");
+	if (!f) {
+		fprintf(stderr, "json-fuzz: cannot open %s\n", path);
+		return 1;
+	}
+	uint8_t seed[4096];
+	size_t seed_len = fread(seed, 1, sizeof(seed), f);
+	fclose(f);
+
+	check(seed, seed_len);
+
+	struct tbar_json_fields fields;
+	bool ok = tbar_json_extract((const char *)seed, seed_len, &fields);
+	printf("%-60s %s present=0x%02x\n", path, ok ? "ok     " : "invalid", ok ? fields.present : 0);
+
+	uint8_t buf[8192];
+	for (int i = 0; i < iterations; i++) {
+		memcpy(buf, seed, seed_len);
+		size_t len = mutate(buf, seed_len, sizeof(buf));
+		check(buf, len);
+	}
+	return 0;
+}
+
+int main(int argc, char **argv)
+{
+	int iterations = 20000;
+	int failed = 0;
+	int first = 1;
+
+	if (argc > 2 && strcmp(argv[1], "--iterations") == 0) {
+		iterations = atoi(argv[2]);
+		first = 3;
+	}
+	if (first >= argc) {
+		fprintf(stderr, "usage: tbar-json-fuzz [--iterations N] <file or directory>...\n");
+		return 2;
+	}
+
+	for (int a = first; a < argc; a++) {
+		DIR *dir = opendir(argv[a]);
+		if (!dir) {
+			failed |= run_file(argv[a], iterations);
+			continue;
+		}
+
+		struct dirent *e;
+		while ((e = readdir(dir)) != NULL) {
+			if (e->d_name[0] == '.')
+				continue;
+			char path[4096];
+			snprintf(path, sizeof(path), "%s/%s", argv[a], e->d_name);
+			failed |= run_file(path, iterations);
+		}
+		closedir(dir);
+	}
+	return failed;
+}
+
+#endif
@@ -0,0 +1,702 @@
+/*
+Plugin Name
+Copyright (C) <Year> <Developer> <Email Address>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+/* HTTP load generator for the T-bar web server.
+
+   Drives N connections from one epoll loop, either closed-loop (each
+   connection sends its next request as soon as the previous answer arrived)
+   or open-loop at a fixed total rate. In open-loop mode latency is measured
+   from the time a request was scheduled, not sent, so a stalled server is not
+   hidden by the client backing off. Results are printed as one JSON object.
+
+   --slowloris N adds N hostile connections next to the measured ones, each
+   trickling an endless request head one byte per interval. Comparing the
+   measured latency with and without them shows whether slow clients can
+   delay healthy ones. */
+
+#define _GNU_SOURCE
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+enum route {
+	ROUTE_POST_TBAR,
+	ROUTE_GET_STATUS,
+	ROUTE_GET_ROOT,
+	ROUTE_COUNT,
+};
+
+static const char *g_route_names[ROUTE_COUNT] = {"post_tbar", "get_status", "get_root"};
+
+enum conn_state {
+	CONN_IDLE, /* open-loop: waiting for the next scheduled send */
+	CONN_CONNECTING,
+	CONN_SENDING,
+	CONN_RECEIVING,
+};
+
+struct conn {
+	int fd;
+	enum conn_state state;
+	enum route route;
+	uint64_t start_ns; /* scheduled (open-loop) or send time (closed-loop) */
+	uint64_t next_ns;  /* open-loop schedule */
+	char out[512];
+	size_t out_len;
+	size_t out_off;
+	char in[8192];
+	size_t in_len;
+	long long body_left; /* -1 while reading headers */
+	int status;
+	bool server_closes;
+};
+
+/* A slowloris connection; never completes a request */
+struct loris {
+	int fd;
+	size_t sent;
+	uint64_t next_ns;
+};
+
+static const char g_loris_head[] = "POST /tbar HTTP/1.1\r\nHost: bench\r\nContent-Type: application/json\r\nX-Pad: ";
+
+struct samples {
+	uint32_t *us;
+	size_t len;
+	size_t cap;
+};
+
+static struct {
+	const char *host;
+	int port;
+	int connections;
+	double duration_s;
+	double warmup_s;
+	double rate; /* total requests/s, 0 = closed loop */
+	bool keep_alive;
+	int weights[ROUTE_COUNT];
+	const char *label;
+	int slowloris;
+	int slowloris_interval_ms;
+} g_opt = {
+	.host = "127.0.0.1",
+	.port = 4455,
+	.connections = 8,
+	.duration_s = 10.0,
+	.warmup_s = 1.0,
+	.keep_alive = true,
+	.weights = {8, 1, 1},
+	.label = "",
+	.slowloris_interval_ms = 500,
+};
+
+static struct {
+	int epoll_fd;
+	struct sockaddr_in addr;
+	struct conn *conns;
+	uint64_t measure_from_ns;
+	uint64_t end_ns;
+	uint64_t seq;
+	struct samples all;
+	struct samples by_route[ROUTE_COUNT];
+	uint64_t errors;
+	uint64_t non_2xx;
+	uint64_t connect_errors;
+	uint64_t bytes_in;
+
+	struct loris *loris;
+	uint64_t loris_connects;
+	uint64_t loris_bytes;
+	uint64_t loris_408;
+	uint64_t loris_503;
+	uint64_t loris_closed; /* without either response */
+} g;
+
+static uint64_t now_ns(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static void samples_add(struct samples *s, uint32_t us)
+{
+	if (s->len == s->cap) {
+		s->cap = s->cap ? s->cap * 2 : 65536;
+		s->us = realloc(s->us, s->cap * sizeof(*s->us));
+		if (!s->us) {
+			fprintf(stderr, "loadgen: out of memory\n");
+			exit(1);
+		}
+	}
+	s->us[s->len++] = us;
+}
+
+static int cmp_u32(const void *a, const void *b)
+{
+	uint32_t x = *(const uint32_t *)a;
+	uint32_t y = *(const uint32_t *)b;
+	return x < y ? -1 : x > y;
+}
+
+static uint32_t percentile(const struct samples *s, double p)
+{
+	if (!s->len)
+		return 0;
+	size_t idx = (size_t)(p * (double)(s->len - 1) + 0.5);
+	return s->us[idx];
+}
+
+static enum route pick_route(void)
+{
+	int total = 0;
+	for (int r = 0; r < ROUTE_COUNT; r++)
+		total += g_opt.weights[r];
+
+	/* Deterministic interleaving so runs are comparable */
+	int slot = (int)(g.seq % (uint64_t)total);
+	for (int r = 0; r < ROUTE_COUNT; r++) {
+		if (slot < g_opt.weights[r])
+			return (enum route)r;
+		slot -= g_opt.weights[r];
+	}
+	return ROUTE_POST_TBAR;
+}
+
+static void build_request(struct conn *c)
+{
+	const char *connection = g_opt.keep_alive ? "" : "Connection: close\r\n";
+	c->route = pick_route();
+	uint64_t seq = g.seq++;
+
+	switch (c->route) {
+	case ROUTE_POST_TBAR: {
+		/* Sweep up and down so the server always sees movement */
+		unsigned step = (unsigned)(seq % 2000);
+		double pos = (step < 1000 ? step : 2000 - step) / 1000.0;
+		char body[64];
+		int body_len = snprintf(body, sizeof(body), "{\"position\":%.4f}", pos);
+		c->out_len = (size_t)snprintf(c->out, sizeof(c->out),
+					      "POST /tbar HTTP/1.1\r\nHost: bench\r\n%s"
+					      "Content-Type: application/json\r\nContent-Length: %d\r\n\r\n%s",
+					      connection, body_len, body);
+		break;
+	}
+	case ROUTE_GET_STATUS:
+		c->out_len = (size_t)snprintf(c->out, sizeof(c->out), "GET /status HTTP/1.1\r\nHost: bench\r\n%s\r\n",
+					      connection);
+		break;
+	default:
+		c->out_len = (size_t)snprintf(c->out, sizeof(c->out), "GET / HTTP/1.1\r\nHost: bench\r\n%s\r\n",
+					      connection);
+		break;
+	}
+	c->out_off = 0;
+	c->in_len = 0;
+	c->body_left = -1;
+	c->status = 0;
+	c->server_closes = !g_opt.keep_alive;
+}
+
+static void conn_watch(struct conn *c, uint32_t events, int op)
+{
+	struct epoll_event ev;
+	memset(&ev, 0, sizeof(ev));
+	ev.events = events;
+	ev.data.ptr = c;
+	epoll_ctl(g.epoll_fd, op, c->fd, &ev);
+}
+
+static void conn_drop(struct conn *c)
+{
+	if (c->fd >= 0) {
+		epoll_ctl(g.epoll_fd, EPOLL_CTL_DEL, c->fd, NULL);
+		close(c->fd);
+	}
+	c->fd = -1;
+}
+
+/* Non-blocking connect; returns the socket or -1 */
+static int open_socket(void)
+{
+	int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, IPPROTO_TCP);
+	if (fd < 0)
+		return -1;
+
+	int one = 1;
+	setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+	if (connect(fd, (struct sockaddr *)&g.addr, sizeof(g.addr)) != 0 && errno != EINPROGRESS) {
+		close(fd);
+		return -1;
+	}
+	return fd;
+}
+
+static bool conn_open(struct conn *c)
+{
+	c->fd = open_socket();
+	if (c->fd < 0)
+		return false;
+	c->state = CONN_CONNECTING;
+	conn_watch(c, EPOLLOUT, EPOLL_CTL_ADD);
+	return true;
+}
+
+static void conn_send(struct conn *c)
+{
+	while (c->out_off < c->out_len) {
+		ssize_t n = send(c->fd, c->out + c->out_off, c->out_len - c->out_off, MSG_NOSIGNAL);
+		if (n < 0) {
+			if (errno == EINTR)
+				continue;
+			if (errno == EAGAIN) {
+				conn_watch(c, EPOLLOUT, EPOLL_CTL_MOD);
+				return;
+			}
+			g.errors++;
+			conn_drop(c);
+			return;
+		}
+		c->out_off += (size_t)n;
+	}
+	c->state = CONN_RECEIVING;
+	conn_watch(c, EPOLLIN, EPOLL_CTL_MOD);
+}
+
+/* Starts the next request on `c`, reconnecting first if needed */
+static void conn_start(struct conn *c, uint64_t start_ns)
+{
+	build_request(c);
+	c->start_ns = start_ns;
+
+	if (c->fd < 0) {
+		if (!conn_open(c)) {
+			g.connect_errors++;
+			c->state = CONN_IDLE;
+		}
+		return;
+	}
+	c->state = CONN_SENDING;
+	conn_send(c);
+}
+
+static void conn_schedule_next(struct conn *c, uint64_t now)
+{
+	if (g_opt.rate > 0.0) {
+		c->state = CONN_IDLE;
+		return;
+	}
+	if (now < g.end_ns)
+		conn_start(c, now);
+	else
+		c->state = CONN_IDLE;
+}
+
+static void request_done(struct conn *c)
+{
+	uint64_t now = now_ns();
+
+	if (c->start_ns >= g.measure_from_ns && now <= g.end_ns) {
+		uint64_t us = (now - c->start_ns) / 1000;
+		uint32_t v = us > UINT32_MAX ? UINT32_MAX : (uint32_t)us;
+		samples_add(&g.all, v);
+		samples_add(&g.by_route[c->route], v);
+		if (c->status < 200 || c->status > 299)
+			g.non_2xx++;
+	}
+
+	if (c->server_closes)
+		conn_drop(c);
+	conn_schedule_next(c, now);
+}
+
+/* Parses what has arrived; true once the whole response is in */
+static bool parse_response(struct conn *c, size_t fresh)
+{
+	if (c->body_left < 0) {
+		c->in[c->in_len] = '\0';
+		char *end = strstr(c->in, "\r\n\r\n");
+		if (!end)
+			return false;
+
+		c->status = atoi(c->in + 9);
+		const char *cl = strcasestr(c->in, "\r\nContent-Length:");
+		long long content_len = cl ? atoll(cl + 17) : 0;
+		const char *conn = strcasestr(c->in, "\r\nConnection: close");
+		if (conn && conn < end)
+			c->server_closes = true;
+
+		size_t header_len = (size_t)(end - c->in) + 4;
+		c->body_left = content_len - (long long)(c->in_len - header_len);
+		c->in_len = 0;
+	} else {
+		c->body_left -= (long long)fresh;
+	}
+	return c->body_left <= 0;
+}
+
+static void conn_readable(struct conn *c)
+{
+	for (;;) {
+		/* Bodies are counted and discarded; only headers are kept */
+		size_t space = sizeof(c->in) - 1 - c->in_len;
+		char *dst = c->in + c->in_len;
+		char discard[16384];
+		if (c->body_left >= 0) {
+			dst = discard;
+			space = sizeof(discard);
+		}
+
+		ssize_t n = recv(c->fd, dst, space, 0);
+		if (n < 0) {
+			if (errno == EINTR)
+				continue;
+			if (errno == EAGAIN)
+				return;
+			g.errors++;
+			conn_drop(c);
+			conn_schedule_next(c, now_ns());
+			return;
+		}
+		if (n == 0) {
+			g.errors++;
+			conn_drop(c);
+			conn_schedule_next(c, now_ns());
+			return;
+		}
+
+		g.bytes_in += (uint64_t)n;
+		if (c->body_left < 0)
+			c->in_len += (size_t)n;
+		if (parse_response(c, (size_t)n)) {
+			request_done(c);
+			return;
+		}
+		if (c->body_left < 0 && c->in_len >= sizeof(c->in) - 1) {
+			g.errors++;
+			conn_drop(c);
+			conn_schedule_next(c, now_ns());
+			return;
+		}
+	}
+}
+
+static void conn_event(struct conn *c, uint32_t events)
+{
+	if (c->state == CONN_CONNECTING) {
+		int err = 0;
+		socklen_t len = sizeof(err);
+		getsockopt(c->fd, SOL_SOCKET, SO_ERROR, &err, &len);
+		if (err || (events & (EPOLLERR | EPOLLHUP))) {
+			g.connect_errors++;
+			conn_drop(c);
+			c->state = CONN_IDLE;
+			return;
+		}
+		c->state = CONN_SENDING;
+		conn_send(c);
+		return;
+	}
+
+	if (events & EPOLLOUT) {
+		conn_send(c);
+		return;
+	}
+	if (events & (EPOLLIN | EPOLLERR | EPOLLHUP))
+		conn_readable(c);
+}
+
+/* Sends the next byte of the endless head, reconnecting when the server has
+   answered (408/503) or dropped the connection. Not registered with epoll;
+   the main loop calls this on schedule. */
+static void loris_tick(struct loris *l, uint64_t now)
+{
+	l->next_ns = now + (uint64_t)g_opt.slowloris_interval_ms * 1000000;
+
+	if (l->fd >= 0) {
+		char buf[64];
+		ssize_t n = recv(l->fd, buf, sizeof(buf), MSG_DONTWAIT);
+		if (n >= 0 || (errno != EAGAIN && errno != EINTR)) {
+			if (n >= 12 && memcmp(buf, "HTTP/1.1 408", 12) == 0)
+				g.loris_408++;
+			else if (n >= 12 && memcmp(buf, "HTTP/1.1 503", 12) == 0)
+				g.loris_503++;
+			else
+				g.loris_closed++;
+			close(l->fd);
+			l->fd = -1;
+			/* Come back on the next tick, like a client retrying */
+			return;
+		}
+	}
+
+	if (l->fd < 0) {
+		l->fd = open_socket();
+		l->sent = 0;
+		if (l->fd < 0)
+			return;
+		g.loris_connects++;
+	}
+
+	char byte = l->sent < sizeof(g_loris_head) - 1 ? g_loris_head[l->sent] : 'a';
+	if (send(l->fd, &byte, 1, MSG_NOSIGNAL | MSG_DONTWAIT) == 1) {
+		l->sent++;
+		g.loris_bytes++;
+	}
+}
+
+static void print_samples(FILE *out, const struct samples *s)
+{
+	double mean = 0.0;
+	for (size_t i = 0; i < s->len; i++)
+		mean += s->us[i];
+	if (s->len)
+		mean /= (double)s->len;
+
+	fprintf(out,
+		"{\"requests\":%zu,\"min\":%u,\"mean\":%.1f,\"p50\":%u,\"p90\":%u,\"p99\":%u,\"p999\":%u,\"max\":%u}",
+		s->len, s->len ? s->us[0] : 0, mean, percentile(s, 0.50), percentile(s, 0.90), percentile(s, 0.99),
+		percentile(s, 0.999), s->len ? s->us[s->len - 1] : 0);
+}
+
+static void report(FILE *out, double measured_s)
+{
+	qsort(g.all.us, g.all.len, sizeof(uint32_t), cmp_u32);
+	for (int r = 0; r < ROUTE_COUNT; r++)
+		qsort(g.by_route[r].us, g.by_route[r].len, sizeof(uint32_t), cmp_u32);
+
+	fprintf(out, "{\"label\":\"%s\",\"config\":{\"connections\":%d,\"duration_s\":%.1f,\"warmup_s\":%.1f,",
+		g_opt.label, g_opt.connections, g_opt.duration_s, g_opt.warmup_s);
+	fprintf(out, "\"rate\":%.0f,\"keep_alive\":%s,\"mix\":{", g_opt.rate, g_opt.keep_alive ? "true" : "false");
+	for (int r = 0; r < ROUTE_COUNT; r++)
+		fprintf(out, "%s\"%s\":%d", r ? "," : "", g_route_names[r], g_opt.weights[r]);
+	fprintf(out, "}},");
+
+	fprintf(out, "\"requests\":%zu,\"errors\":%llu,\"connect_errors\":%llu,\"non_2xx\":%llu,", g.all.len,
+		(unsigned long long)g.errors, (unsigned long long)g.connect_errors, (unsigned long long)g.non_2xx);
+	fprintf(out, "\"throughput_rps\":%.1f,\"latency_us\":", measured_s > 0 ? (double)g.all.len / measured_s : 0.0);
+	print_samples(out, &g.all);
+	fprintf(out, ",\"routes\":{");
+	for (int r = 0; r < ROUTE_COUNT; r++) {
+		fprintf(out, "%s\"%s\":", r ? "," : "", g_route_names[r]);
+		print_samples(out, &g.by_route[r]);
+	}
+	fprintf(out, "}");
+	if (g_opt.slowloris) {
+		fprintf(out,
+			",\"slowloris\":{\"connections\":%d,\"interval_ms\":%d,\"connects\":%llu,\"bytes\":%llu,"
+			"\"got_408\":%llu,\"got_503\":%llu,\"closed\":%llu}",
+			g_opt.slowloris, g_opt.slowloris_interval_ms, (unsigned long long)g.loris_connects,
+			(unsigned long long)g.loris_bytes, (unsigned long long)g.loris_408,
+			(unsigned long long)g.loris_503, (unsigned long long)g.loris_closed);
+	}
+	fprintf(out, "}\n");
+}
+
+static bool parse_mix(const char *spec)
+{
+	int weights[ROUTE_COUNT] = {0};
+	char buf[128];
+	snprintf(buf, sizeof(buf), "%s", spec);
+
+	for (char *tok = strtok(buf, ","); tok; tok = strtok(NULL, ",")) {
+		char *eq = strchr(tok, '=');
+		if (!eq)
+			return false;
+		*eq = '\0';
+		int r = 0;
+		while (r < ROUTE_COUNT && strcmp(tok, g_route_names[r]) != 0)
+			r++;
+		if (r == ROUTE_COUNT)
+			return false;
+		weights[r] = atoi(eq + 1);
+	}
+
+	int total = 0;
+	for (int r = 0; r < ROUTE_COUNT; r++)
+		total += weights[r] > 0 ? weights[r] : 0;
+	if (!total)
+		return false;
+	for (int r = 0; r < ROUTE_COUNT; r++)
+		g_opt.weights[r] = weights[r] > 0 ? weights[r] : 0;
+	return true;
+}
+
+static void usage(void)
+{
+	fprintf(stderr,
+		"usage: tbar-loadgen [options]\n"
+		"  --host ADDR          server address (127.0.0.1)\n"
+		"  --port N             server port (4455)\n"
+		"  --connections N      concurrent connections (8)\n"
+		"  --duration S         measured seconds (10)\n"
+		"  --warmup S           unmeasured seconds before that (1)\n"
+		"  --rate R             total requests/s, 0 = as fast as possible (0)\n"
+		"  --keep-alive 0|1     reuse connections (1)\n"
+		"  --mix SPEC           route weights, e.g. post_tbar=8,get_status=1,get_root=1\n"
+		"  --label TEXT         copied into the JSON output\n"
+		"  --slowloris N        extra connections trickling a request head that never ends (0)\n"
+		"  --slowloris-interval-ms N  delay between their bytes (500)\n");
+}
+
+static bool parse_args(int argc, char **argv)
+{
+	for (int i = 1; i < argc; i++) {
+		const char *arg = argv[i];
+		const char *val = i + 1 < argc ? argv[++i] : NULL;
+		if (!val)
+			return false;
+
+		if (strcmp(arg, "--host") == 0)
+			g_opt.host = val;
+		else if (strcmp(arg, "--port") == 0)
+			g_opt.port = atoi(val);
+		else if (strcmp(arg, "--connections") == 0)
+			g_opt.connections = atoi(val);
+		else if (strcmp(arg, "--duration") == 0)
+			g_opt.duration_s = atof(val);
+		else if (strcmp(arg, "--warmup") == 0)
+			g_opt.warmup_s = atof(val);
+		else if (strcmp(arg, "--rate") == 0)
+			g_opt.rate = atof(val);
+		else if (strcmp(arg, "--keep-alive") == 0)
+			g_opt.keep_alive = atoi(val) != 0;
+		else if (strcmp(arg, "--mix") == 0) {
+			if (!parse_mix(val))
+				return false;
+		} else if (strcmp(arg, "--label") == 0)
+			g_opt.label = val;
+		else if (strcmp(arg, "--slowloris") == 0)
+			g_opt.slowloris = atoi(val);
+		else if (strcmp(arg, "--slowloris-interval-ms") == 0)
+			g_opt.slowloris_interval_ms = atoi(val);
+		else
+			return false;
+	}
+	return g_opt.connections > 0 && g_opt.duration_s > 0.0 && g_opt.port > 0 && g_opt.slowloris >= 0 &&
+	       g_opt.slowloris_interval_ms > 0;
+}
+
+int main(int argc, char **argv)
+{
+	if (!parse_args(argc, argv)) {
+		usage();
+		return 2;
+	}
+
+	memset(&g.addr, 0, sizeof(g.addr));
+	g.addr.sin_family = AF_INET;
+	g.addr.sin_port = htons((uint16_t)g_opt.port);
+	if (inet_pton(AF_INET, g_opt.host, &g.addr.sin_addr) != 1) {
+		fprintf(stderr, "loadgen: bad host '%s'\n", g_opt.host);
+		return 2;
+	}
+
+	g.epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+	g.conns = calloc((size_t)g_opt.connections, sizeof(*g.conns));
+	g.loris = calloc((size_t)g_opt.slowloris + 1, sizeof(*g.loris));
+	if (g.epoll_fd < 0 || !g.conns || !g.loris)
+		return 1;
+
+	uint64_t begin = now_ns();
+	g.measure_from_ns = begin + (uint64_t)(g_opt.warmup_s * 1e9);
+	g.end_ns = g.measure_from_ns + (uint64_t)(g_opt.duration_s * 1e9);
+
+	/* Open-loop: each connection carries rate/N, staggered across one interval */
+	uint64_t interval = g_opt.rate > 0.0 ? (uint64_t)(1e9 * g_opt.connections / g_opt.rate) : 0;
+	for (int i = 0; i < g_opt.connections; i++) {
+		struct conn *c = &g.conns[i];
+		c->fd = -1;
+		c->state = CONN_IDLE;
+		c->next_ns = begin + interval * (uint64_t)i / (uint64_t)g_opt.connections;
+		if (!interval)
+			conn_start(c, begin);
+	}
+
+	/* Spread the slow connections' bytes across one interval */
+	uint64_t loris_interval = (uint64_t)g_opt.slowloris_interval_ms * 1000000;
+	for (int i = 0; i < g_opt.slowloris; i++) {
+		g.loris[i].fd = -1;
+		g.loris[i].next_ns = begin + loris_interval * (uint64_t)i / (uint64_t)g_opt.slowloris;
+	}
+
+	struct epoll_event events[256];
+	for (;;) {
+		uint64_t now = now_ns();
+		if (now >= g.end_ns)
+			break;
+
+		int timeout_ms = 100;
+		if (interval) {
+			uint64_t next = g.end_ns;
+			for (int i = 0; i < g_opt.connections; i++) {
+				struct conn *c = &g.conns[i];
+				if (c->state == CONN_IDLE && c->next_ns <= now) {
+					uint64_t scheduled = c->next_ns;
+					c->next_ns += interval;
+					conn_start(c, scheduled);
+				}
+				/* Busy connections wake epoll themselves when they finish */
+				if (c->state == CONN_IDLE && c->next_ns < next)
+					next = c->next_ns;
+			}
+			/* epoll only has millisecond resolution; spin through the last one */
+			timeout_ms = next > now ? (int)((next - now) / 1000000) : 0;
+		} else {
+			/* Closed loop: revive connections that failed to connect */
+			for (int i = 0; i < g_opt.connections; i++) {
+				if (g.conns[i].state == CONN_IDLE)
+					conn_start(&g.conns[i], now);
+			}
+		}
+
+		if (g_opt.slowloris) {
+			uint64_t next = now + (uint64_t)timeout_ms * 1000000;
+			for (int i = 0; i < g_opt.slowloris; i++) {
+				if (g.loris[i].next_ns <= now)
+					loris_tick(&g.loris[i], now);
+				if (g.loris[i].next_ns < next)
+					next = g.loris[i].next_ns;
+			}
+			timeout_ms = next > now ? (int)((next - now) / 1000000) : 0;
+		}
+
+		int n = epoll_wait(g.epoll_fd, events, 256, timeout_ms);
+		if (n < 0 && errno != EINTR) {
+			perror("epoll_wait");
+			return 1;
+		}
+		for (int i = 0; i < n; i++)
+			conn_event(events[i].data.ptr, events[i].events);
+	}
+
+	report(stdout, g_opt.duration_s);
+	return g.all.len ? 0 : 1;
+}
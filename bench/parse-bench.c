@@ -0,0 +1,254 @@
+/*
+Plugin Name
+Copyright (C) <Year> <Developer> <Email Address>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+/* Microbenchmark for the HTTP request head parser.
+
+   Parses a few representative requests whole, split in two segments and fed
+   one byte at a time (the worst case for resuming), and compares against the
+   strstr/sscanf approach the server used before. Prints one JSON object. */
+
+#define _GNU_SOURCE
+
+#include <tbar-http-parser.h>
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static const struct {
+	const char *name;
+	const char *text;
+} g_cases[] = {
+	{"post_tbar", "POST /tbar HTTP/1.1\r\n"
+		      "Host: 127.0.0.1:4455\r\n"
+		      "User-Agent: curl/8.5.0\r\n"
+		      "Accept: */*\r\n"
+		      "Content-Type: application/json\r\n"
+		      "Content-Length: 35\r\n"
+		      "\r\n"
+		      "{\"position\":0.5012,\"release\":false}"},
+	{"browser_get",
+	 "GET /status HTTP/1.1\r\n"
+	 "Host: 127.0.0.1:4455\r\n"
+	 "Connection: keep-alive\r\n"
+	 "sec-ch-ua: \"Chromium\";v=\"128\", \"Not;A=Brand\";v=\"24\", \"Google Chrome\";v=\"128\"\r\n"
+	 "sec-ch-ua-mobile: ?0\r\n"
+	 "User-Agent: Mozilla/5.0 (Windows NT 10.0; Win64; x64) AppleWebKit/537.36 (KHTML, like Gecko) "
+	 "Chrome/128.0.0.0 Safari/537.36\r\n"
+	 "sec-ch-ua-platform: \"Windows\"\r\n"
+	 "Accept: */*\r\n"
+	 "Sec-Fetch-Site: same-origin\r\n"
+	 "Sec-Fetch-Mode: cors\r\n"
+	 "Sec-Fetch-Dest: empty\r\n"
+	 "Referer: http://127.0.0.1:4455/\r\n"
+	 "Accept-Encoding: gzip, deflate, br, zstd\r\n"
+	 "Accept-Language: en-US,en;q=0.9,sv;q=0.8\r\n"
+	 "\r\n"},
+	{"ws_upgrade", "GET /tbar/ws HTTP/1.1\r\n"
+		       "Host: 127.0.0.1:4455\r\n"
+		       "Connection: Upgrade\r\n"
+		       "Pragma: no-cache\r\n"
+		       "Cache-Control: no-cache\r\n"
+		       "Upgrade: websocket\r\n"
+		       "Origin: http://127.0.0.1:4455\r\n"
+		       "Sec-WebSocket-Version: 13\r\n"
+		       "Sec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\n"
+		       "Sec-WebSocket-Extensions: permessage-deflate; client_max_window_bits\r\n"
+		       "\r\n"},
+};
+
+#define NUM_CASES (sizeof(g_cases) / sizeof(g_cases[0]))
+
+static volatile uint64_t g_sink;
+
+static uint64_t now_ns(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static void consume(const struct tbar_http_request *r)
+{
+	struct tbar_http_str host = tbar_http_header(r, "Host");
+	g_sink += r->content_length + r->header_len + (uint64_t)r->method + host.len + r->keep_alive;
+}
+
+static void parse_whole(const char *buf, size_t len)
+{
+	struct tbar_http_parser p;
+	tbar_http_parser_reset(&p);
+	if (tbar_http_parse(&p, buf, len, 8191) != TBAR_HTTP_COMPLETE)
+		abort();
+	consume(&p.req);
+}
+
+static void parse_split(const char *buf, size_t len)
+{
+	struct tbar_http_parser p;
+	tbar_http_parser_reset(&p);
+	if (tbar_http_parse(&p, buf, len / 2, 8191) != TBAR_HTTP_INCOMPLETE)
+		abort();
+	if (tbar_http_parse(&p, buf, len, 8191) != TBAR_HTTP_COMPLETE)
+		abort();
+	consume(&p.req);
+}
+
+static void parse_bytewise(const char *buf, size_t len)
+{
+	struct tbar_http_parser p;
+	tbar_http_parser_reset(&p);
+	for (size_t i = 1; i <= len; i++) {
+		if (tbar_http_parse(&p, buf, i, 8191) == TBAR_HTTP_COMPLETE) {
+			consume(&p.req);
+			return;
+		}
+	}
+	abort();
+}
+
+/* ---- The previous implementation, for comparison ---- */
+
+static int legacy_starts_with(const char *s, const char *prefix)
+{
+	while (*prefix && *s) {
+		if ((*s | 0x20) != (*prefix | 0x20))
+			return 0;
+		s++;
+		prefix++;
+	}
+	return *prefix == '\0';
+}
+
+static const char *legacy_find_header(const char *headers, const char *key)
+{
+	const char *p = headers;
+	size_t key_len = strlen(key);
+
+	while (*p) {
+		const char *line = p;
+		const char *eol = strstr(line, "\r\n");
+		if (!eol)
+			break;
+		if ((size_t)(eol - line) > key_len + 1 && legacy_starts_with(line, key) && line[key_len] == ':') {
+			const char *v = line + key_len + 1;
+			while (*v == ' ' || *v == '\t')
+				v++;
+			return v;
+		}
+		p = eol + 2;
+	}
+	return NULL;
+}
+
+static void parse_legacy(char *buf, size_t len)
+{
+	(void)len;
+	const char *end = strstr(buf, "\r\n\r\n");
+	if (!end)
+		abort();
+	size_t header_len = (size_t)(end - buf) + 4;
+
+	buf[header_len - 2] = '\0';
+	const char *cl = legacy_find_header(buf, "Content-Length");
+	const char *conn = legacy_find_header(buf, "Connection");
+	const char *host = legacy_find_header(buf, "Host");
+	buf[header_len - 2] = '\r';
+
+	char method[16];
+	char path[256];
+	if (sscanf(buf, "%15s %255s", method, path) != 2)
+		abort();
+	g_sink += (cl ? (uint64_t)atoi(cl) : 0) + header_len + (uint64_t)method[0] + (conn != NULL) + (host != NULL);
+}
+
+/* ---- Driver ---- */
+
+enum mode {
+	MODE_WHOLE,
+	MODE_SPLIT,
+	MODE_BYTEWISE,
+	MODE_LEGACY,
+	MODE_COUNT,
+};
+
+static const char *g_mode_names[MODE_COUNT] = {"whole", "split", "bytewise", "legacy_strstr"};
+
+static double run(enum mode mode, char *buf, size_t len, double seconds)
+{
+	uint64_t iterations = 0;
+	uint64_t batch = mode == MODE_BYTEWISE ? 100 : 10000;
+	uint64_t start = now_ns();
+	uint64_t deadline = start + (uint64_t)(seconds * 1e9);
+	uint64_t now;
+
+	do {
+		for (uint64_t i = 0; i < batch; i++) {
+			switch (mode) {
+			case MODE_WHOLE:
+				parse_whole(buf, len);
+				break;
+			case MODE_SPLIT:
+				parse_split(buf, len);
+				break;
+			case MODE_BYTEWISE:
+				parse_bytewise(buf, len);
+				break;
+			default:
+				parse_legacy(buf, len);
+				break;
+			}
+		}
+		iterations += batch;
+		now = now_ns();
+	} while (now < deadline);
+
+	return (double)(now - start) / (double)iterations;
+}
+
+int main(int argc, char **argv)
+{
+	double seconds = argc > 1 ? atof(argv[1]) : 0.5;
+	if (seconds <= 0.0) {
+		fprintf(stderr, "usage: tbar-parse-bench [seconds per case]\n");
+		return 2;
+	}
+
+	printf("{\"seconds_per_case\":%.2f,\"cases\":{", seconds);
+	for (size_t c = 0; c < NUM_CASES; c++) {
+		/* Writable copy with spare room; the legacy path NUL-terminates */
+		size_t len = strlen(g_cases[c].text);
+		char *buf = malloc(len + 1);
+		if (!buf)
+			return 1;
+		memcpy(buf, g_cases[c].text, len + 1);
+
+		printf("%s\"%s\":{\"bytes\":%zu", c ? "," : "", g_cases[c].name, len);
+		for (int m = 0; m < MODE_COUNT; m++) {
+			double ns = run((enum mode)m, buf, len, seconds);
+			printf(",\"%s\":{\"ns_per_request\":%.1f,\"mb_per_s\":%.1f}", g_mode_names[m], ns,
+			       (double)len / ns * 1e3);
+		}
+		printf("}");
+		free(buf);
+	}
+	printf("}}\n");
+	return 0;
+}
@@ -0,0 +1,271 @@
+/*
+Plugin Name
+Copyright (C) <Year> <Developer> <Email Address>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+/* Replays a session recording (record_path) through the plugin's ingest and
+   apply pipeline, running against the libobs stand-in in shim/.
+
+   Every ingest record is submitted again with its original source, position,
+   release flag and controller timestamp, either at its original pace or as
+   fast as possible (--fast). The replay itself is recorded to --out, and the
+   apply latency measured from that is printed as one JSON object, so a
+   captured session doubles as a repeatable regression test for the
+   ingest -> apply path. --dump prints a recording as text instead. */
+
+#define _GNU_SOURCE
+
+#include "shim.h"
+
+#include <tbar-web.h>
+
+#include <obs.h>
+#include <util/platform.h>
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static const char *g_source_names[] = {"-", "http", "ws", "udp", "trajectory"};
+static const char *g_thread_names[] = {"server", "ui", "video"};
+
+static struct {
+	const char *path;
+	const char *out;
+	int port;
+	bool fast;
+	bool dump;
+} g_opt = {
+	.port = 4456,
+};
+
+static void usage(void)
+{
+	fprintf(stderr, "usage: tbar-replay [--fast] [--port N] [--out PATH] <recording>\n"
+			"       tbar-replay --dump <recording>\n");
+}
+
+static uint64_t event_ns(const struct tbar_record *r)
+{
+	return r->kind == TBAR_RECORD_APPLY ? r->apply_ns : r->recv_ns;
+}
+
+static int cmp_event(const void *a, const void *b)
+{
+	uint64_t x = event_ns(a);
+	uint64_t y = event_ns(b);
+	return x < y ? -1 : x > y;
+}
+
+/* Returns the non-empty records of a recording in event order */
+static struct tbar_record *load(const char *path, struct tbar_record_header *header, size_t *count)
+{
+	FILE *f = fopen(path, "rb");
+	if (!f) {
+		fprintf(stderr, "replay: cannot open %s\n", path);
+		return NULL;
+	}
+
+	struct tbar_record *records = NULL;
+	if (fread(header, sizeof(*header), 1, f) != 1 ||
+	    memcmp(header->magic, TBAR_RECORD_MAGIC, sizeof(header->magic)) != 0 ||
+	    header->version != TBAR_RECORD_VERSION || header->record_size != sizeof(struct tbar_record) ||
+	    header->capacity > ((uint64_t)1 << 31)) {
+		fprintf(stderr, "replay: %s is not a recording\n", path);
+		goto out;
+	}
+
+	records = malloc((size_t)header->capacity * sizeof(*records));
+	if (!records || fread(records, sizeof(*records), (size_t)header->capacity, f) != header->capacity) {
+		fprintf(stderr, "replay: %s is truncated\n", path);
+		free(records);
+		records = NULL;
+		goto out;
+	}
+
+	size_t n = 0;
+	for (size_t i = 0; i < header->capacity; i++) {
+		if (records[i].kind == TBAR_RECORD_INGEST || records[i].kind == TBAR_RECORD_APPLY)
+			records[n++] = records[i];
+	}
+	qsort(records, n, sizeof(*records), cmp_event);
+	*count = n;
+
+out:
+	fclose(f);
+	return records;
+}
+
+static const char *source_name(uint8_t source)
+{
+	return source < sizeof(g_source_names) / sizeof(g_source_names[0]) ? g_source_names[source] : "?";
+}
+
+static int dump(const char *path)
+{
+	struct tbar_record_header header;
+	size_t count;
+	struct tbar_record *records = load(path, &header, &count);
+	if (!records)
+		return 1;
+
+	time_t start = (time_t)header.start_unix_s;
+	char when[64];
+	strftime(when, sizeof(when), "%Y-%m-%d %H:%M:%S", localtime(&start));
+	printf("# %s: %zu records (ring of %llu), started %s\n", path, count, (unsigned long long)header.capacity,
+	       when);
+	printf("#   time_ms  event   source      ch  position  release  detail\n");
+
+	for (size_t i = 0; i < count; i++) {
+		const struct tbar_record *r = &records[i];
+		double t_ms = ((double)event_ns(r) - (double)header.start_ns) / 1000000.0;
+		printf("%11.3f  %-6s  %-10s  %2d  %8.6f  %-7s  ", t_ms,
+		       r->kind == TBAR_RECORD_APPLY ? "apply" : "ingest", source_name(r->source),
+		       r->flags >> TBAR_RECORD_CHANNEL_SHIFT, r->position, r->flags & TBAR_RECORD_RELEASE ? "yes" : "no");
+		if (r->kind == TBAR_RECORD_APPLY)
+			printf("latency_us=%.1f thread=%s\n", (double)(r->apply_ns - r->recv_ns) / 1000.0,
+			       r->thread < 3 ? g_thread_names[r->thread] : "?");
+		else if (r->sender_ms >= 0.0)
+			printf("sender_ms=%.3f\n", r->sender_ms);
+		else
+			printf("-\n");
+	}
+
+	free(records);
+	return 0;
+}
+
+static void sleep_until(uint64_t ns)
+{
+	struct timespec ts = {(time_t)(ns / 1000000000), (long)(ns % 1000000000)};
+	clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
+}
+
+static int cmp_u32(const void *a, const void *b)
+{
+	uint32_t x = *(const uint32_t *)a;
+	uint32_t y = *(const uint32_t *)b;
+	return x < y ? -1 : x > y;
+}
+
+static uint32_t percentile(const uint32_t *us, size_t len, double p)
+{
+	return len ? us[(size_t)(p * (double)(len - 1) + 0.5)] : 0;
+}
+
+static int replay(void)
+{
+	struct tbar_record_header header;
+	size_t count;
+	struct tbar_record *records = load(g_opt.path, &header, &count);
+	if (!records)
+		return 1;
+
+	shim_config_set_bool("enabled", true);
+	shim_config_set_int("port", g_opt.port);
+	shim_config_set_string("record_path", g_opt.out);
+	/* Room for every ingest record and one apply per ingest */
+	shim_config_set_int("record_max_mb", (long long)(count * 2 * sizeof(struct tbar_record) >> 20) + 1);
+	tbar_web_apply_config();
+
+	size_t ingested = 0;
+	uint64_t first_ns = 0;
+	uint64_t start_ns = os_gettime_ns();
+	for (size_t i = 0; i < count; i++) {
+		const struct tbar_record *r = &records[i];
+		if (r->kind != TBAR_RECORD_INGEST)
+			continue;
+		if (!ingested)
+			first_ns = r->recv_ns;
+		if (!g_opt.fast)
+			sleep_until(start_ns + (r->recv_ns - first_ns));
+		int channel = r->flags >> TBAR_RECORD_CHANNEL_SHIFT;
+		tbar_web_submit_timed_position(channel, (enum tbar_record_source)r->source, r->position,
+					       (r->flags & TBAR_RECORD_RELEASE) != 0, r->sender_ms);
+		ingested++;
+	}
+	double replay_s = (double)(os_gettime_ns() - start_ns) / 1e9;
+
+	/* Let the last updates reach the transition, then close the recording */
+	sleep_until(os_gettime_ns() + 250000000);
+	tbar_web_close_config();
+	tbar_web_stop();
+	free(records);
+
+	records = load(g_opt.out, &header, &count);
+	if (!records)
+		return 1;
+
+	uint32_t *us = malloc((count ? count : 1) * sizeof(*us));
+	if (!us) {
+		free(records);
+		return 1;
+	}
+	size_t applied = 0;
+	for (size_t i = 0; i < count; i++) {
+		const struct tbar_record *r = &records[i];
+		/* Positions generated on the tick have no network latency to measure */
+		if (r->kind == TBAR_RECORD_APPLY && r->source == TBAR_SOURCE_NONE)
+			us[applied++] = (uint32_t)((r->apply_ns - r->recv_ns) / 1000);
+	}
+	qsort(us, applied, sizeof(*us), cmp_u32);
+
+	printf("{\"recording\":\"%s\",\"mode\":\"%s\",\"ingested\":%zu,\"applied\":%zu,\"replay_s\":%.3f,"
+	       "\"apply_latency_us\":{\"p50\":%u,\"p90\":%u,\"p99\":%u,\"max\":%u}}\n",
+	       g_opt.path, g_opt.fast ? "fast" : "realtime", ingested, applied, replay_s, percentile(us, applied, 0.50),
+	       percentile(us, applied, 0.90), percentile(us, applied, 0.99), applied ? us[applied - 1] : 0);
+
+	free(us);
+	free(records);
+	return 0;
+}
+
+int main(int argc, char **argv)
+{
+	for (int i = 1; i < argc; i++) {
+		const char *arg = argv[i];
+		if (strcmp(arg, "--fast") == 0) {
+			g_opt.fast = true;
+		} else if (strcmp(arg, "--dump") == 0) {
+			g_opt.dump = true;
+		} else if (strcmp(arg, "--port") == 0 && i + 1 < argc) {
+			g_opt.port = atoi(argv[++i]);
+		} else if (strcmp(arg, "--out") == 0 && i + 1 < argc) {
+			g_opt.out = argv[++i];
+		} else if (arg[0] != '-' && !g_opt.path) {
+			g_opt.path = arg;
+		} else {
+			usage();
+			return 2;
+		}
+	}
+	if (!g_opt.path) {
+		usage();
+		return 2;
+	}
+
+	if (g_opt.dump)
+		return dump(g_opt.path);
+
+	char out[1024];
+	if (!g_opt.out) {
+		snprintf(out, sizeof(out), "%s.replay", g_opt.path);
+		g_opt.out = out;
+	}
+	return replay();
+}
@@ -0,0 +1,26 @@
+#!/bin/sh
+# usage: run-bench.sh SERVER LOADGEN PORT [loadgen options...]
+#
+# Starts the benchmark server, runs the load generator against it and prints
+# the load generator's JSON result on stdout.
+set -e
+
+server="$1"
+loadgen="$2"
+port="$3"
+shift 3
+
+fifo="$(mktemp -u)"
+mkfifo "$fifo"
+"$server" --port "$port" >"$fifo" &
+pid=$!
+trap 'kill "$pid" 2>/dev/null; wait "$pid" 2>/dev/null; rm -f "$fifo"' EXIT
+
+# The server prints "ready" once it is listening
+read -r line <"$fifo"
+if [ "$line" != "ready" ]; then
+	echo "run-bench: server did not start" >&2
+	exit 1
+fi
+
+"$loadgen" --port "$port" "$@"
@@ -0,0 +1,53 @@
+/*
+Plugin Name
+Copyright (C) <Year> <Developer> <Email Address>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#pragma once
+
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct obs_data obs_data_t;
+
+obs_data_t *obs_data_create(void);
+obs_data_t *obs_data_create_from_json_file(const char *path);
+obs_data_t *obs_data_create_from_json_file_safe(const char *path, const char *backup_ext);
+void obs_data_release(obs_data_t *data);
+bool obs_data_save_json_pretty_safe(obs_data_t *data, const char *file, const char *temp_ext, const char *backup_ext);
+
+void obs_data_set_default_bool(obs_data_t *data, const char *name, bool val);
+void obs_data_set_default_int(obs_data_t *data, const char *name, long long val);
+void obs_data_set_default_double(obs_data_t *data, const char *name, double val);
+void obs_data_set_default_string(obs_data_t *data, const char *name, const char *val);
+
+void obs_data_set_bool(obs_data_t *data, const char *name, bool val);
+void obs_data_set_int(obs_data_t *data, const char *name, long long val);
+void obs_data_set_double(obs_data_t *data, const char *name, double val);
+void obs_data_set_string(obs_data_t *data, const char *name, const char *val);
+
+bool obs_data_get_bool(obs_data_t *data, const char *name);
+long long obs_data_get_int(obs_data_t *data, const char *name);
+double obs_data_get_double(obs_data_t *data, const char *name);
+const char *obs_data_get_string(obs_data_t *data, const char *name);
+bool obs_data_has_user_value(obs_data_t *data, const char *name);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,85 @@
+/*
+Plugin Name
+Copyright (C) <Year> <Developer> <Email Address>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <obs-data.h>
+#include <util/bmem.h>
+#include <util/platform.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define LOG_ERROR 100
+#define LOG_WARNING 200
+#define LOG_INFO 300
+#define LOG_DEBUG 400
+
+typedef struct obs_source obs_source_t;
+typedef struct signal_handler signal_handler_t;
+typedef struct calldata calldata_t;
+typedef void (*signal_callback_t)(void *data, calldata_t *cd);
+
+enum obs_task_type {
+	OBS_TASK_UI,
+	OBS_TASK_GRAPHICS,
+	OBS_TASK_AUDIO,
+	OBS_TASK_DESTROY,
+};
+
+typedef void (*obs_task_t)(void *param);
+
+void obs_queue_task(enum obs_task_type type, obs_task_t task, void *param, bool wait);
+void obs_add_tick_callback(void (*tick)(void *param, float seconds), void *param);
+void obs_remove_tick_callback(void (*tick)(void *param, float seconds), void *param);
+/* Timestamp of the frame being rendered, for tick callbacks */
+uint64_t obs_get_video_frame_time(void);
+
+obs_source_t *obs_get_output_source(uint32_t channel);
+obs_source_t *obs_source_get_ref(obs_source_t *source);
+void obs_source_release(obs_source_t *source);
+const char *obs_source_get_name(const obs_source_t *source);
+obs_source_t *obs_get_source_by_name(const char *name);
+signal_handler_t *obs_source_get_signal_handler(const obs_source_t *source);
+
+void signal_handler_connect(signal_handler_t *handler, const char *signal, signal_callback_t callback, void *data);
+void signal_handler_disconnect(signal_handler_t *handler, const char *signal, signal_callback_t callback,
+			       void *data);
+
+enum obs_transition_mode {
+	OBS_TRANSITION_MODE_AUTO,
+	OBS_TRANSITION_MODE_MANUAL,
+};
+
+bool obs_transition_fixed(obs_source_t *transition);
+bool obs_transition_start(obs_source_t *transition, enum obs_transition_mode mode, uint32_t duration_ms,
+			  obs_source_t *dest);
+void obs_transition_set_manual_time(obs_source_t *transition, float t);
+void obs_transition_force_stop(obs_source_t *transition);
+float obs_transition_get_time(obs_source_t *transition);
+void obs_transition_set(obs_source_t *transition, obs_source_t *source);
+obs_source_t *obs_transition_get_active_source(obs_source_t *transition);
+
+#ifdef __cplusplus
+}
+#endif
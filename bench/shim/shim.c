@@ -0,0 +1,725 @@
+/*
+Plugin Name
+Copyright (C) <Year> <Developer> <Email Address>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+/* Minimal libobs / obs-frontend-api stand-in so the server core can be built
+   and driven without OBS: a UI task thread, a 60 Hz video tick thread, a flat
+   key/value obs_data and a fake Studio Mode with two scenes and one manual
+   transition. */
+
+#define _GNU_SOURCE /* pthread_setname_np */
+
+#include "shim.h"
+
+#include <obs-frontend-api.h>
+#include <obs-module.h>
+#include <util/threading.h>
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+static int g_log_level = LOG_WARNING;
+
+void shim_set_log_level(int level)
+{
+	g_log_level = level;
+}
+
+void blogva(int log_level, const char *format, va_list args)
+{
+	if (log_level > g_log_level)
+		return;
+	vfprintf(stderr, format, args);
+	fputc('\n', stderr);
+}
+
+uint64_t os_gettime_ns(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+FILE *os_fopen(const char *path, const char *mode)
+{
+	return fopen(path, mode);
+}
+
+void os_sleep_ms(uint32_t duration)
+{
+	usleep(duration * 1000);
+}
+
+void os_set_thread_name(const char *name)
+{
+	pthread_setname_np(pthread_self(), name);
+}
+
+char *obs_module_config_path(const char *file)
+{
+	char buf[512];
+	snprintf(buf, sizeof(buf), "/tmp/%s", file);
+	return bstrdup(buf);
+}
+
+/* ------------------------------ */
+/* UI task queue                  */
+/* ------------------------------ */
+
+struct task {
+	obs_task_t fn;
+	void *param;
+	struct task *next;
+};
+
+static struct {
+	pthread_mutex_t mutex;
+	pthread_cond_t cond;
+	struct task *head;
+	struct task *tail;
+	pthread_t thread;
+	bool started;
+} g_ui = {
+	.mutex = PTHREAD_MUTEX_INITIALIZER,
+	.cond = PTHREAD_COND_INITIALIZER,
+};
+
+static void *ui_thread(void *unused)
+{
+	(void)unused;
+	os_set_thread_name("shim: ui");
+
+	for (;;) {
+		pthread_mutex_lock(&g_ui.mutex);
+		while (!g_ui.head)
+			pthread_cond_wait(&g_ui.cond, &g_ui.mutex);
+		struct task *t = g_ui.head;
+		g_ui.head = t->next;
+		if (!g_ui.head)
+			g_ui.tail = NULL;
+		pthread_mutex_unlock(&g_ui.mutex);
+
+		t->fn(t->param);
+		free(t);
+	}
+	return NULL;
+}
+
+void obs_queue_task(enum obs_task_type type, obs_task_t task, void *param, bool wait)
+{
+	(void)type;
+	(void)wait;
+
+	struct task *t = calloc(1, sizeof(*t));
+	t->fn = task;
+	t->param = param;
+
+	pthread_mutex_lock(&g_ui.mutex);
+	if (!g_ui.started) {
+		pthread_create(&g_ui.thread, NULL, ui_thread, NULL);
+		g_ui.started = true;
+	}
+	if (g_ui.tail)
+		g_ui.tail->next = t;
+	else
+		g_ui.head = t;
+	g_ui.tail = t;
+	pthread_cond_signal(&g_ui.cond);
+	pthread_mutex_unlock(&g_ui.mutex);
+}
+
+/* ------------------------------ */
+/* Video tick                     */
+/* ------------------------------ */
+
+/* Callbacks run under the mutex, like libobs, so removal waits for a running tick */
+static struct {
+	pthread_mutex_t mutex;
+	void (*callback)(void *param, float seconds);
+	void *param;
+	pthread_t thread;
+	bool started;
+	volatile uint64_t frame_ns;
+} g_tick = {
+	.mutex = PTHREAD_MUTEX_INITIALIZER,
+};
+
+static void *tick_thread(void *unused)
+{
+	(void)unused;
+	os_set_thread_name("shim: video");
+
+	uint64_t next = os_gettime_ns();
+	for (;;) {
+		next += 16666667;
+		struct timespec ts = {(time_t)(next / 1000000000), (long)(next % 1000000000)};
+		clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
+
+		pthread_mutex_lock(&g_tick.mutex);
+		g_tick.frame_ns = next;
+		if (g_tick.callback)
+			g_tick.callback(g_tick.param, 1.0f / 60.0f);
+		pthread_mutex_unlock(&g_tick.mutex);
+	}
+	return NULL;
+}
+
+void obs_add_tick_callback(void (*tick)(void *param, float seconds), void *param)
+{
+	pthread_mutex_lock(&g_tick.mutex);
+	g_tick.callback = tick;
+	g_tick.param = param;
+	if (!g_tick.started) {
+		pthread_create(&g_tick.thread, NULL, tick_thread, NULL);
+		g_tick.started = true;
+	}
+	pthread_mutex_unlock(&g_tick.mutex);
+}
+
+uint64_t obs_get_video_frame_time(void)
+{
+	return g_tick.frame_ns;
+}
+
+void obs_remove_tick_callback(void (*tick)(void *param, float seconds), void *param)
+{
+	(void)tick;
+	(void)param;
+
+	pthread_mutex_lock(&g_tick.mutex);
+	g_tick.callback = NULL;
+	pthread_mutex_unlock(&g_tick.mutex);
+}
+
+/* ------------------------------ */
+/* obs_data                       */
+/* ------------------------------ */
+
+#define MAX_KEYS 32
+
+struct kv {
+	char key[64];
+	bool set;
+	bool b;
+	long long i;
+	double d;
+	char str[256];
+	bool def_b;
+	long long def_i;
+	double def_d;
+	char def_str[256];
+};
+
+struct obs_data {
+	struct kv kv[MAX_KEYS];
+	int count;
+};
+
+static obs_data_t g_config;
+
+static struct kv *kv_get(obs_data_t *data, const char *name)
+{
+	for (int i = 0; i < data->count; i++) {
+		if (strcmp(data->kv[i].key, name) == 0)
+			return &data->kv[i];
+	}
+	if (data->count == MAX_KEYS)
+		return &data->kv[MAX_KEYS - 1];
+
+	struct kv *kv = &data->kv[data->count++];
+	snprintf(kv->key, sizeof(kv->key), "%s", name);
+	return kv;
+}
+
+obs_data_t *obs_data_create(void)
+{
+	return calloc(1, sizeof(obs_data_t));
+}
+
+obs_data_t *obs_data_create_from_json_file_safe(const char *path, const char *backup_ext)
+{
+	(void)path;
+	(void)backup_ext;
+
+	if (!g_config.count)
+		return NULL;
+	obs_data_t *data = obs_data_create();
+	*data = g_config;
+	return data;
+}
+
+void obs_data_release(obs_data_t *data)
+{
+	free(data);
+}
+
+/* Values stay in memory. The file is still replaced on every save, the same
+   way libobs does it, so that the plugin's config watcher has something to see. */
+obs_data_t *obs_data_create_from_json_file(const char *path)
+{
+	FILE *f = fopen(path, "rb");
+	if (!f)
+		return NULL;
+	fclose(f);
+	obs_data_t *data = obs_data_create();
+	*data = g_config;
+	return data;
+}
+
+bool obs_data_save_json_pretty_safe(obs_data_t *data, const char *file, const char *temp_ext, const char *backup_ext)
+{
+	static long saves;
+	char tmp[512];
+	char bak[512];
+	snprintf(tmp, sizeof(tmp), "%s.%s", file, temp_ext);
+	snprintf(bak, sizeof(bak), "%s.%s", file, backup_ext);
+
+	g_config = *data;
+	FILE *f = fopen(tmp, "wb");
+	if (!f)
+		return false;
+	fprintf(f, "{\n    \"shim_saves\": %ld\n}\n", ++saves);
+	fclose(f);
+	rename(file, bak);
+	return rename(tmp, file) == 0;
+}
+
+void obs_data_set_default_bool(obs_data_t *data, const char *name, bool val)
+{
+	kv_get(data, name)->def_b = val;
+}
+
+void obs_data_set_default_int(obs_data_t *data, const char *name, long long val)
+{
+	kv_get(data, name)->def_i = val;
+}
+
+void obs_data_set_default_double(obs_data_t *data, const char *name, double val)
+{
+	kv_get(data, name)->def_d = val;
+}
+
+void obs_data_set_default_string(obs_data_t *data, const char *name, const char *val)
+{
+	struct kv *kv = kv_get(data, name);
+	snprintf(kv->def_str, sizeof(kv->def_str), "%s", val ? val : "");
+}
+
+void obs_data_set_bool(obs_data_t *data, const char *name, bool val)
+{
+	struct kv *kv = kv_get(data, name);
+	kv->b = val;
+	kv->set = true;
+}
+
+void obs_data_set_int(obs_data_t *data, const char *name, long long val)
+{
+	struct kv *kv = kv_get(data, name);
+	kv->i = val;
+	kv->set = true;
+}
+
+void obs_data_set_double(obs_data_t *data, const char *name, double val)
+{
+	struct kv *kv = kv_get(data, name);
+	kv->d = val;
+	kv->set = true;
+}
+
+void obs_data_set_string(obs_data_t *data, const char *name, const char *val)
+{
+	struct kv *kv = kv_get(data, name);
+	snprintf(kv->str, sizeof(kv->str), "%s", val ? val : "");
+	kv->set = true;
+}
+
+bool obs_data_get_bool(obs_data_t *data, const char *name)
+{
+	struct kv *kv = kv_get(data, name);
+	return kv->set ? kv->b : kv->def_b;
+}
+
+long long obs_data_get_int(obs_data_t *data, const char *name)
+{
+	struct kv *kv = kv_get(data, name);
+	return kv->set ? kv->i : kv->def_i;
+}
+
+double obs_data_get_double(obs_data_t *data, const char *name)
+{
+	struct kv *kv = kv_get(data, name);
+	return kv->set ? kv->d : kv->def_d;
+}
+
+const char *obs_data_get_string(obs_data_t *data, const char *name)
+{
+	struct kv *kv = kv_get(data, name);
+	return kv->set ? kv->str : kv->def_str;
+}
+
+bool obs_data_has_user_value(obs_data_t *data, const char *name)
+{
+	for (int i = 0; i < data->count; i++) {
+		if (strcmp(data->kv[i].key, name) == 0)
+			return data->kv[i].set;
+	}
+	return false;
+}
+
+void shim_config_set_bool(const char *name, bool val)
+{
+	obs_data_set_bool(&g_config, name, val);
+}
+
+void shim_config_set_int(const char *name, long long val)
+{
+	obs_data_set_int(&g_config, name, val);
+}
+
+void shim_config_set_string(const char *name, const char *val)
+{
+	obs_data_set_string(&g_config, name, val);
+}
+
+/* ------------------------------ */
+/* Sources and frontend           */
+/* ------------------------------ */
+
+#define SIGNAL_SLOTS 8
+
+struct signal_handler {
+	pthread_mutex_t mutex;
+	struct {
+		const char *signal;
+		signal_callback_t callback;
+		void *data;
+	} slots[SIGNAL_SLOTS];
+};
+
+struct obs_source {
+	const char *name;
+	signal_handler_t *signals;
+
+	/* Transitions, under g_frontend.mutex */
+	obs_source_t *shown; /* source A; the frontend's program scene on channel 0 */
+	obs_source_t *dest;  /* source B while running */
+	bool active;
+	float time;
+};
+
+#define SHIM_CHANNELS 4
+
+static signal_handler_t g_transition_signals[SHIM_CHANNELS] = {
+	{.mutex = PTHREAD_MUTEX_INITIALIZER},
+	{.mutex = PTHREAD_MUTEX_INITIALIZER},
+	{.mutex = PTHREAD_MUTEX_INITIALIZER},
+	{.mutex = PTHREAD_MUTEX_INITIALIZER},
+};
+
+static obs_source_t g_scene_a = {.name = "Scene A"};
+static obs_source_t g_scene_b = {.name = "Scene B"};
+static obs_source_t g_scene_c = {.name = "Scene C"};
+
+/* One transition per output channel; the extra channels start on Scene A */
+static obs_source_t g_transitions[SHIM_CHANNELS] = {
+	{.name = "Fade", .signals = &g_transition_signals[0]},
+	{.name = "Fade 1", .signals = &g_transition_signals[1], .shown = &g_scene_a},
+	{.name = "Fade 2", .signals = &g_transition_signals[2], .shown = &g_scene_a},
+	{.name = "Fade 3", .signals = &g_transition_signals[3], .shown = &g_scene_a},
+};
+#define g_transition g_transitions[0]
+
+signal_handler_t *obs_source_get_signal_handler(const obs_source_t *source)
+{
+	return source ? source->signals : NULL;
+}
+
+void signal_handler_connect(signal_handler_t *handler, const char *signal, signal_callback_t callback, void *data)
+{
+	if (!handler)
+		return;
+	pthread_mutex_lock(&handler->mutex);
+	for (int i = 0; i < SIGNAL_SLOTS; i++) {
+		if (!handler->slots[i].callback) {
+			handler->slots[i].signal = signal;
+			handler->slots[i].callback = callback;
+			handler->slots[i].data = data;
+			break;
+		}
+	}
+	pthread_mutex_unlock(&handler->mutex);
+}
+
+void signal_handler_disconnect(signal_handler_t *handler, const char *signal, signal_callback_t callback,
+			       void *data)
+{
+	if (!handler)
+		return;
+	pthread_mutex_lock(&handler->mutex);
+	for (int i = 0; i < SIGNAL_SLOTS; i++) {
+		if (handler->slots[i].callback == callback && handler->slots[i].data == data &&
+		    strcmp(handler->slots[i].signal, signal) == 0)
+			handler->slots[i].callback = NULL;
+	}
+	pthread_mutex_unlock(&handler->mutex);
+}
+
+/* Calls the connected callbacks outside the lock, as libobs does */
+static void signal_emit(signal_handler_t *handler, const char *signal)
+{
+	signal_callback_t callbacks[SIGNAL_SLOTS];
+	void *data[SIGNAL_SLOTS];
+	int n = 0;
+
+	pthread_mutex_lock(&handler->mutex);
+	for (int i = 0; i < SIGNAL_SLOTS; i++) {
+		if (handler->slots[i].callback && strcmp(handler->slots[i].signal, signal) == 0) {
+			callbacks[n] = handler->slots[i].callback;
+			data[n++] = handler->slots[i].data;
+		}
+	}
+	pthread_mutex_unlock(&handler->mutex);
+
+	for (int i = 0; i < n; i++)
+		callbacks[i](data[i], NULL);
+}
+
+/* Written from the UI thread and the video tick, like the real transition */
+static struct {
+	pthread_mutex_t mutex;
+	obs_source_t *program;
+	obs_source_t *preview;
+	obs_frontend_event_cb event_cb;
+	void *event_data;
+} g_frontend = {
+	.mutex = PTHREAD_MUTEX_INITIALIZER,
+	.program = &g_scene_a,
+	.preview = &g_scene_b,
+};
+
+obs_source_t *obs_get_output_source(uint32_t channel)
+{
+	return channel < SHIM_CHANNELS ? &g_transitions[channel] : NULL;
+}
+
+obs_source_t *obs_get_source_by_name(const char *name)
+{
+	obs_source_t *scenes[] = {&g_scene_a, &g_scene_b, &g_scene_c};
+	for (size_t i = 0; i < sizeof(scenes) / sizeof(scenes[0]); i++) {
+		if (strcmp(scenes[i]->name, name) == 0)
+			return scenes[i];
+	}
+	return NULL;
+}
+
+obs_source_t *obs_source_get_ref(obs_source_t *source)
+{
+	return source;
+}
+
+void obs_source_release(obs_source_t *source)
+{
+	(void)source;
+}
+
+const char *obs_source_get_name(const obs_source_t *source)
+{
+	return source ? source->name : NULL;
+}
+
+bool obs_transition_fixed(obs_source_t *transition)
+{
+	(void)transition;
+	return false;
+}
+
+/* Ends a transition on source B, as libobs does when it reaches the end or is
+   stopped; called with the mutex held, returns whether it was running */
+static bool transition_end(obs_source_t *transition)
+{
+	bool was_active = transition->active;
+	transition->active = false;
+	if (transition != &g_transition && transition->dest)
+		transition->shown = transition->dest;
+	transition->dest = NULL;
+	return was_active;
+}
+
+bool obs_transition_start(obs_source_t *transition, enum obs_transition_mode mode, uint32_t duration_ms,
+			  obs_source_t *dest)
+{
+	pthread_mutex_lock(&g_frontend.mutex);
+	transition->active = true;
+	transition->time = 0.0f;
+	transition->dest = dest;
+	/* Cuts end right away */
+	bool done = mode == OBS_TRANSITION_MODE_AUTO && duration_ms == 0 && transition_end(transition);
+	pthread_mutex_unlock(&g_frontend.mutex);
+	signal_emit(transition->signals, "transition_start");
+	if (done)
+		signal_emit(transition->signals, "transition_stop");
+	return true;
+}
+
+void obs_transition_set_manual_time(obs_source_t *transition, float t)
+{
+	pthread_mutex_lock(&g_frontend.mutex);
+	transition->time = t;
+	/* The main transition ends with the frontend's scene switch instead */
+	bool done = transition != &g_transition && t >= 1.0f && transition_end(transition);
+	pthread_mutex_unlock(&g_frontend.mutex);
+	if (done)
+		signal_emit(transition->signals, "transition_stop");
+}
+
+void obs_transition_force_stop(obs_source_t *transition)
+{
+	pthread_mutex_lock(&g_frontend.mutex);
+	transition_end(transition);
+	pthread_mutex_unlock(&g_frontend.mutex);
+	signal_emit(transition->signals, "transition_stop");
+}
+
+void obs_transition_set(obs_source_t *transition, obs_source_t *source)
+{
+	pthread_mutex_lock(&g_frontend.mutex);
+	transition->shown = source;
+	pthread_mutex_unlock(&g_frontend.mutex);
+}
+
+obs_source_t *obs_transition_get_active_source(obs_source_t *transition)
+{
+	pthread_mutex_lock(&g_frontend.mutex);
+	obs_source_t *source = transition == &g_transition ? g_frontend.program : transition->shown;
+	pthread_mutex_unlock(&g_frontend.mutex);
+	return source;
+}
+
+float obs_transition_get_time(obs_source_t *transition)
+{
+	pthread_mutex_lock(&g_frontend.mutex);
+	float t = transition->time;
+	pthread_mutex_unlock(&g_frontend.mutex);
+	return t;
+}
+
+float shim_transition_time(void)
+{
+	return obs_transition_get_time(&g_transition);
+}
+
+bool shim_transition_active(void)
+{
+	pthread_mutex_lock(&g_frontend.mutex);
+	bool active = g_transition.active;
+	pthread_mutex_unlock(&g_frontend.mutex);
+	return active;
+}
+
+void obs_frontend_add_event_callback(obs_frontend_event_cb callback, void *private_data)
+{
+	pthread_mutex_lock(&g_frontend.mutex);
+	g_frontend.event_cb = callback;
+	g_frontend.event_data = private_data;
+	pthread_mutex_unlock(&g_frontend.mutex);
+}
+
+void obs_frontend_remove_event_callback(obs_frontend_event_cb callback, void *private_data)
+{
+	pthread_mutex_lock(&g_frontend.mutex);
+	if (g_frontend.event_cb == callback && g_frontend.event_data == private_data)
+		g_frontend.event_cb = NULL;
+	pthread_mutex_unlock(&g_frontend.mutex);
+}
+
+/* Delivered synchronously on the caller's thread (the UI thread in practice) */
+static void emit_event(enum obs_frontend_event event)
+{
+	pthread_mutex_lock(&g_frontend.mutex);
+	obs_frontend_event_cb cb = g_frontend.event_cb;
+	void *data = g_frontend.event_data;
+	pthread_mutex_unlock(&g_frontend.mutex);
+
+	if (cb)
+		cb(event, data);
+}
+
+bool obs_frontend_preview_program_mode_active(void)
+{
+	return true;
+}
+
+obs_source_t *obs_frontend_get_current_scene(void)
+{
+	pthread_mutex_lock(&g_frontend.mutex);
+	obs_source_t *scene = g_frontend.program;
+	pthread_mutex_unlock(&g_frontend.mutex);
+	return scene;
+}
+
+obs_source_t *obs_frontend_get_current_preview_scene(void)
+{
+	pthread_mutex_lock(&g_frontend.mutex);
+	obs_source_t *scene = g_frontend.preview;
+	pthread_mutex_unlock(&g_frontend.mutex);
+	return scene;
+}
+
+obs_source_t *obs_frontend_get_current_transition(void)
+{
+	return &g_transition;
+}
+
+void obs_frontend_set_current_scene(obs_source_t *scene)
+{
+	pthread_mutex_lock(&g_frontend.mutex);
+	g_frontend.program = scene;
+	bool was_active = g_transition.active;
+	g_transition.active = false;
+	pthread_mutex_unlock(&g_frontend.mutex);
+	/* Finishing a manual transition ends it */
+	if (was_active)
+		signal_emit(g_transition.signals, "transition_stop");
+	emit_event(OBS_FRONTEND_EVENT_SCENE_CHANGED);
+}
+
+void obs_frontend_set_current_preview_scene(obs_source_t *scene)
+{
+	pthread_mutex_lock(&g_frontend.mutex);
+	g_frontend.preview = scene;
+	pthread_mutex_unlock(&g_frontend.mutex);
+	emit_event(OBS_FRONTEND_EVENT_PREVIEW_SCENE_CHANGED);
+}
+
+int obs_frontend_get_transition_duration(void)
+{
+	return 300;
+}
+
+void obs_frontend_preview_program_trigger_transition(void)
+{
+	pthread_mutex_lock(&g_frontend.mutex);
+	obs_source_t *program = g_frontend.program;
+	g_frontend.program = g_frontend.preview;
+	g_frontend.preview = program;
+	pthread_mutex_unlock(&g_frontend.mutex);
+	emit_event(OBS_FRONTEND_EVENT_SCENE_CHANGED);
+	emit_event(OBS_FRONTEND_EVENT_PREVIEW_SCENE_CHANGED);
+}
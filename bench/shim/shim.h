@@ -0,0 +1,44 @@
+/*
+Plugin Name
+Copyright (C) <Year> <Developer> <Email Address>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#pragma once
+
+/* Bench-only hooks into the libobs stand-in */
+
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Messages below this level (LOG_ERROR < LOG_WARNING < ...) are printed to stderr */
+void shim_set_log_level(int level);
+
+/* Values returned by the next obs_data_create_from_json_file_safe(), i.e. what
+   the plugin reads as its config file */
+void shim_config_set_bool(const char *name, bool val);
+void shim_config_set_int(const char *name, long long val);
+void shim_config_set_string(const char *name, const char *val);
+
+/* Fake frontend state, for checking what the plugin did */
+float shim_transition_time(void);
+bool shim_transition_active(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,52 @@
+/*
+Plugin Name
+Copyright (C) <Year> <Developer> <Email Address>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#pragma once
+
+#include <stdlib.h>
+#include <string.h>
+
+static inline void *bmalloc(size_t size)
+{
+	return malloc(size ? size : 1);
+}
+
+static inline void *bzalloc(size_t size)
+{
+	return calloc(1, size ? size : 1);
+}
+
+static inline void *brealloc(void *ptr, size_t size)
+{
+	return realloc(ptr, size ? size : 1);
+}
+
+static inline void bfree(void *ptr)
+{
+	free(ptr);
+}
+
+static inline char *bstrdup(const char *str)
+{
+	if (!str)
+		return NULL;
+	size_t len = strlen(str) + 1;
+	char *dup = malloc(len);
+	memcpy(dup, str, len);
+	return dup;
+}
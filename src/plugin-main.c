@@ -36,6 +36,8 @@ bool obs_module_load(void)
 
 void obs_module_unload(void)
 {
+	/* Config first, so a reload queued meanwhile cannot start the server again */
+	tbar_web_close_config();
 	tbar_web_stop();
 	obs_log(LOG_INFO, "plugin unloaded");
 }
@@ -0,0 +1,200 @@
+/*
+Plugin Name
+Copyright (C) <Year> <Developer> <Email Address>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include "tbar-arbiter.h"
+#include "tbar-metrics.h"
+#include "tbar-web.h"
+
+#include <string.h>
+
+/* A client silent this long may restart its sequence from anywhere */
+#define SEQ_RESET_NS 2000000000ULL
+
+struct client {
+	bool used;
+	char id[TBAR_ARBITER_MAX_CLIENT_ID + 1];
+	bool has_seq;
+	uint64_t last_seq;
+	uint64_t last_seen_ns;
+};
+
+/* One per channel: a controller may hold several faders at once */
+struct lease {
+	int owner; /* client slot holding the lease, -1 when free */
+	uint64_t expires_ns;
+
+	int waiters[TBAR_ARBITER_MAX_WAITERS]; /* client slots, in order */
+	int num_waiters;
+};
+
+static struct {
+	enum tbar_lease_mode mode;
+	uint64_t lease_ns;
+	struct client clients[TBAR_ARBITER_MAX_CLIENTS];
+	struct lease leases[TBAR_MAX_CHANNELS];
+} g_arb;
+
+void tbar_arbiter_reset(enum tbar_lease_mode mode, uint64_t lease_ns)
+{
+	memset(&g_arb, 0, sizeof(g_arb));
+	g_arb.mode = mode;
+	g_arb.lease_ns = lease_ns;
+	for (int i = 0; i < TBAR_MAX_CHANNELS; i++)
+		g_arb.leases[i].owner = -1;
+}
+
+static void remove_waiter(struct lease *l, int at)
+{
+	l->num_waiters--;
+	memmove(&l->waiters[at], &l->waiters[at + 1], (size_t)(l->num_waiters - at) * sizeof(int));
+}
+
+static int find_waiter(const struct lease *l, int slot)
+{
+	for (int i = 0; i < l->num_waiters; i++) {
+		if (l->waiters[i] == slot)
+			return i;
+	}
+	return -1;
+}
+
+static bool is_owner(int slot)
+{
+	for (int i = 0; i < TBAR_MAX_CHANNELS; i++) {
+		if (g_arb.leases[i].owner == slot)
+			return true;
+	}
+	return false;
+}
+
+static int find_client(const char *id, uint64_t now_ns)
+{
+	int oldest = -1;
+	for (int i = 0; i < TBAR_ARBITER_MAX_CLIENTS; i++) {
+		struct client *cl = &g_arb.clients[i];
+		if (cl->used && strcmp(cl->id, id) == 0)
+			return i;
+		/* Never recycle a lease holder */
+		if (!is_owner(i) &&
+		    (oldest < 0 || (g_arb.clients[oldest].used &&
+				    (!cl->used || cl->last_seen_ns < g_arb.clients[oldest].last_seen_ns))))
+			oldest = i;
+	}
+
+	for (int ch = 0; ch < TBAR_MAX_CHANNELS; ch++) {
+		int w = find_waiter(&g_arb.leases[ch], oldest);
+		if (w >= 0)
+			remove_waiter(&g_arb.leases[ch], w);
+	}
+
+	struct client *cl = &g_arb.clients[oldest];
+	memset(cl, 0, sizeof(*cl));
+	cl->used = true;
+	strncpy(cl->id, id, TBAR_ARBITER_MAX_CLIENT_ID);
+	cl->last_seen_ns = now_ns;
+	return oldest;
+}
+
+/* Frees the lease at time `at`; in queue mode it passes to the first waiter
+   that was still sending then */
+static void lease_end(struct lease *l, uint64_t at)
+{
+	l->owner = -1;
+	if (g_arb.mode != TBAR_LEASE_QUEUE)
+		return;
+
+	while (l->num_waiters) {
+		int slot = l->waiters[0];
+		remove_waiter(l, 0);
+		if (g_arb.clients[slot].last_seen_ns + g_arb.lease_ns >= at) {
+			l->owner = slot;
+			l->expires_ns = at + g_arb.lease_ns;
+			return;
+		}
+	}
+}
+
+static void expire(struct lease *l, uint64_t now_ns)
+{
+	/* Evaluated lazily: a lease granted to a waiter that never used it
+	   expires in turn, as of the time it was granted */
+	while (l->owner >= 0 && now_ns >= l->expires_ns)
+		lease_end(l, l->expires_ns);
+}
+
+struct tbar_arbiter_result tbar_arbiter_check(int channel, const char *client_id, bool has_seq, uint64_t seq,
+					      bool release, uint64_t now_ns)
+{
+	struct tbar_arbiter_result res = {TBAR_ARBITER_ACCEPT, NULL, 0};
+	int slot = find_client(client_id ? client_id : "", now_ns);
+	struct client *cl = &g_arb.clients[slot];
+
+	if (has_seq) {
+		if (cl->has_seq && now_ns - cl->last_seen_ns <= SEQ_RESET_NS && seq <= cl->last_seq) {
+			tbar_metrics_add(TBAR_THREAD_SERVER, TBAR_COUNTER_ARBITER_STALE, 1);
+			res.verdict = TBAR_ARBITER_STALE;
+			return res;
+		}
+		cl->has_seq = true;
+		cl->last_seq = seq;
+	}
+	cl->last_seen_ns = now_ns;
+
+	if (g_arb.mode == TBAR_LEASE_OFF)
+		return res;
+
+	struct lease *l = &g_arb.leases[channel];
+	expire(l, now_ns);
+	if (l->owner < 0)
+		l->owner = slot;
+
+	if (l->owner == slot) {
+		l->expires_ns = now_ns + g_arb.lease_ns;
+		if (release)
+			lease_end(l, now_ns);
+		return res;
+	}
+
+	res.owner = g_arb.clients[l->owner].id;
+	res.verdict = TBAR_ARBITER_NOT_OWNER;
+	if (g_arb.mode == TBAR_LEASE_QUEUE) {
+		int w = find_waiter(l, slot);
+		if (w < 0 && l->num_waiters < TBAR_ARBITER_MAX_WAITERS) {
+			w = l->num_waiters++;
+			l->waiters[w] = slot;
+		}
+		if (w >= 0) {
+			res.verdict = TBAR_ARBITER_QUEUED;
+			res.queue_pos = w + 1;
+		}
+	}
+	tbar_metrics_add(TBAR_THREAD_SERVER,
+			 res.verdict == TBAR_ARBITER_QUEUED ? TBAR_COUNTER_ARBITER_QUEUED
+							     : TBAR_COUNTER_ARBITER_NOT_OWNER,
+			 1);
+	return res;
+}
+
+const char *tbar_arbiter_owner(int channel, uint64_t now_ns)
+{
+	if (g_arb.mode == TBAR_LEASE_OFF)
+		return NULL;
+	struct lease *l = &g_arb.leases[channel];
+	expire(l, now_ns);
+	return l->owner >= 0 ? g_arb.clients[l->owner].id : NULL;
+}
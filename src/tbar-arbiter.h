@@ -0,0 +1,78 @@
+/*
+Plugin Name
+Copyright (C) <Year> <Developer> <Email Address>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Arbitration between several controllers, decided on the socket thread
+   before an update is submitted, so a rejected update never reaches the UI
+   thread or the video tick. Only the socket thread may call these.
+
+   Controllers identify themselves with a client id. Updates carrying a
+   sequence number are dropped unless it is newer than the last one accepted
+   from that client, whichever channel they address. With a lease mode set,
+   the first controller to move a channel's fader holds it until it releases
+   the fader or stays silent for the lease time; the others are rejected, or
+   queued and handed the lease in turn. Each channel has its own lease. */
+
+#define TBAR_ARBITER_MAX_CLIENT_ID 63
+/* Clients tracked; the least recently seen is recycled */
+#define TBAR_ARBITER_MAX_CLIENTS 32
+#define TBAR_ARBITER_MAX_WAITERS 8
+
+enum tbar_lease_mode {
+	TBAR_LEASE_OFF,    /* sequence checks only */
+	TBAR_LEASE_REJECT, /* non-owners are turned away */
+	TBAR_LEASE_QUEUE,  /* non-owners wait in line for the lease */
+};
+
+enum tbar_arbiter_verdict {
+	TBAR_ARBITER_ACCEPT,
+	TBAR_ARBITER_STALE,     /* seq not newer than the client's last one */
+	TBAR_ARBITER_NOT_OWNER, /* another client holds the lease */
+	TBAR_ARBITER_QUEUED,    /* another client holds the lease; this one is next in line at `queue_pos` */
+};
+
+struct tbar_arbiter_result {
+	enum tbar_arbiter_verdict verdict;
+	const char *owner; /* lease holder when not accepted, valid until the next call */
+	int queue_pos;     /* 1 = next */
+};
+
+/* Forgets all clients and any lease (server start) */
+void tbar_arbiter_reset(enum tbar_lease_mode mode, uint64_t lease_ns);
+
+/* Decides on one update for `channel` (0..TBAR_MAX_CHANNELS-1). `client_id`
+   may be NULL (anonymous controllers share one identity); `seq` is only
+   checked when `has_seq`. A release from the lease holder is accepted and
+   ends the lease. */
+struct tbar_arbiter_result tbar_arbiter_check(int channel, const char *client_id, bool has_seq, uint64_t seq,
+					      bool release, uint64_t now_ns);
+
+/* Current lease holder of `channel`, or NULL */
+const char *tbar_arbiter_owner(int channel, uint64_t now_ns);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,366 @@
+/*
+Plugin Name
+Copyright (C) <Year> <Developer> <Email Address>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include "tbar-config.h"
+
+#include <obs-module.h>
+#include <plugin-support.h>
+#include <util/bmem.h>
+#include <util/platform.h>
+#include <util/threading.h>
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#ifdef __linux__
+#include <errno.h>
+#include <poll.h>
+#include <stdalign.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#endif
+
+#define WRITE_QUIET_MS 250  /* write once changes stop for this long */
+#define WRITE_MAX_DELAY_MS 1000 /* ...or this long after the first one, at the latest */
+#define WATCH_SETTLE_MS 100 /* an editor's save is often several events */
+
+static struct {
+	pthread_mutex_t mutex; /* guards pending, first_ns, last_ns, stop */
+	pthread_cond_t cond;
+	pthread_t writer;
+	bool open;
+	bool stop;
+	char *path;
+	tbar_config_change_cb on_change;
+
+	obs_data_t *pending; /* not written yet; owned here */
+	uint64_t first_ns;
+	uint64_t last_ns;
+
+#ifdef __linux__
+	/* Held while the file is replaced and while the watcher looks at it, so
+	   the watcher never sees our write before we have noted its identity */
+	pthread_mutex_t file_mutex;
+	bool known;
+	struct stat known_st; /* the file as we last wrote or read it */
+
+	pthread_t watcher;
+	bool watching;
+	int inotify_fd;
+	int wake_fd;
+	const char *name; /* file name within the watched directory */
+#endif
+} g_cfgio = {
+	.mutex = PTHREAD_MUTEX_INITIALIZER,
+	.cond = PTHREAD_COND_INITIALIZER,
+#ifdef __linux__
+	.file_mutex = PTHREAD_MUTEX_INITIALIZER,
+	.inotify_fd = -1,
+	.wake_fd = -1,
+#endif
+};
+
+/* fsync() the file and, on POSIX, the directory holding the rename */
+static void flush_to_disk(const char *path)
+{
+#ifdef _WIN32
+	FILE *f = os_fopen(path, "r+b");
+	if (f) {
+		_commit(_fileno(f));
+		fclose(f);
+	}
+#else
+	int fd = open(path, O_RDONLY);
+	if (fd >= 0) {
+		fsync(fd);
+		close(fd);
+	}
+
+	const char *slash = strrchr(path, '/');
+	if (!slash)
+		return;
+	char dir[1024];
+	snprintf(dir, sizeof(dir), "%.*s", (int)(slash - path), path);
+	fd = open(dir[0] ? dir : "/", O_RDONLY);
+	if (fd >= 0) {
+		fsync(fd);
+		close(fd);
+	}
+#endif
+}
+
+static void write_file(obs_data_t *data)
+{
+#ifdef __linux__
+	pthread_mutex_lock(&g_cfgio.file_mutex);
+#endif
+	if (obs_data_save_json_pretty_safe(data, g_cfgio.path, "tmp", "bak"))
+		flush_to_disk(g_cfgio.path);
+	else
+		obs_log(LOG_WARNING, "tbar-web: failed to write %s", g_cfgio.path);
+#ifdef __linux__
+	g_cfgio.known = stat(g_cfgio.path, &g_cfgio.known_st) == 0;
+	pthread_mutex_unlock(&g_cfgio.file_mutex);
+#endif
+	obs_data_release(data);
+}
+
+static void cond_wait_ns(uint64_t ns)
+{
+	struct timespec ts;
+	timespec_get(&ts, TIME_UTC);
+	ns += (uint64_t)ts.tv_nsec;
+	ts.tv_sec += (time_t)(ns / 1000000000);
+	ts.tv_nsec = (long)(ns % 1000000000);
+	pthread_cond_timedwait(&g_cfgio.cond, &g_cfgio.mutex, &ts);
+}
+
+static void *writer_thread(void *unused)
+{
+	(void)unused;
+	os_set_thread_name("tbar-web: config");
+
+	pthread_mutex_lock(&g_cfgio.mutex);
+	for (;;) {
+		if (!g_cfgio.pending) {
+			if (g_cfgio.stop)
+				break;
+			pthread_cond_wait(&g_cfgio.cond, &g_cfgio.mutex);
+			continue;
+		}
+
+		/* On stop, write right away */
+		uint64_t due = g_cfgio.last_ns + (uint64_t)WRITE_QUIET_MS * 1000000;
+		uint64_t latest = g_cfgio.first_ns + (uint64_t)WRITE_MAX_DELAY_MS * 1000000;
+		if (due > latest)
+			due = latest;
+		uint64_t now = os_gettime_ns();
+		if (!g_cfgio.stop && now < due) {
+			cond_wait_ns(due - now);
+			continue;
+		}
+
+		obs_data_t *data = g_cfgio.pending;
+		g_cfgio.pending = NULL;
+		pthread_mutex_unlock(&g_cfgio.mutex);
+		write_file(data);
+		pthread_mutex_lock(&g_cfgio.mutex);
+	}
+	pthread_mutex_unlock(&g_cfgio.mutex);
+	return NULL;
+}
+
+void tbar_config_save(obs_data_t *data)
+{
+	uint64_t now = os_gettime_ns();
+	pthread_mutex_lock(&g_cfgio.mutex);
+	if (!g_cfgio.open) {
+		pthread_mutex_unlock(&g_cfgio.mutex);
+		obs_data_release(data);
+		return;
+	}
+	if (g_cfgio.pending)
+		obs_data_release(g_cfgio.pending);
+	else
+		g_cfgio.first_ns = now;
+	g_cfgio.pending = data;
+	g_cfgio.last_ns = now;
+	pthread_cond_signal(&g_cfgio.cond);
+	pthread_mutex_unlock(&g_cfgio.mutex);
+}
+
+/* ------------------------------ */
+/* Watcher (Linux)                */
+/* ------------------------------ */
+
+#ifdef __linux__
+
+/* Drains the inotify queue; true if our file was replaced or rewritten */
+static bool read_events(void)
+{
+	alignas(struct inotify_event) char buf[4096];
+	bool touched = false;
+	for (;;) {
+		ssize_t n = read(g_cfgio.inotify_fd, buf, sizeof(buf));
+		if (n <= 0)
+			return touched;
+		for (char *p = buf; p < buf + n;) {
+			const struct inotify_event *ev = (const struct inotify_event *)p;
+			if (ev->len && strcmp(ev->name, g_cfgio.name) == 0)
+				touched = true;
+			p += sizeof(*ev) + ev->len;
+		}
+	}
+}
+
+static bool same_file(const struct stat *a, const struct stat *b)
+{
+	return a->st_ino == b->st_ino && a->st_size == b->st_size && a->st_mtim.tv_sec == b->st_mtim.tv_sec &&
+	       a->st_mtim.tv_nsec == b->st_mtim.tv_nsec;
+}
+
+static void check_file(void)
+{
+	struct stat st;
+	pthread_mutex_lock(&g_cfgio.file_mutex);
+	bool ours = stat(g_cfgio.path, &st) != 0 || (g_cfgio.known && same_file(&st, &g_cfgio.known_st));
+	if (!ours) {
+		g_cfgio.known = true;
+		g_cfgio.known_st = st;
+	}
+	pthread_mutex_unlock(&g_cfgio.file_mutex);
+	if (ours)
+		return;
+
+	obs_data_t *data = obs_data_create_from_json_file(g_cfgio.path);
+	if (!data) {
+		obs_log(LOG_WARNING, "tbar-web: %s could not be read, keeping the current config", g_cfgio.path);
+		return;
+	}
+
+	/* The edit is newer than a change still waiting to be written */
+	pthread_mutex_lock(&g_cfgio.mutex);
+	if (g_cfgio.pending) {
+		obs_data_release(g_cfgio.pending);
+		g_cfgio.pending = NULL;
+	}
+	pthread_mutex_unlock(&g_cfgio.mutex);
+
+	obs_log(LOG_INFO, "tbar-web: %s changed, reloading", g_cfgio.path);
+	g_cfgio.on_change(data);
+}
+
+static void *watch_thread(void *unused)
+{
+	(void)unused;
+	os_set_thread_name("tbar-web: config watch");
+
+	struct pollfd fds[2] = {
+		{.fd = g_cfgio.inotify_fd, .events = POLLIN},
+		{.fd = g_cfgio.wake_fd, .events = POLLIN},
+	};
+	bool touched = false;
+	for (;;) {
+		int n = poll(fds, 2, touched ? WATCH_SETTLE_MS : -1);
+		if (n < 0 && errno != EINTR)
+			break;
+		if (fds[1].revents)
+			break;
+		if (n == 0) {
+			touched = false;
+			check_file();
+		} else if (n > 0 && (fds[0].revents & POLLIN) && read_events()) {
+			touched = true;
+		}
+	}
+	return NULL;
+}
+
+static void watch_start(void)
+{
+	const char *slash = strrchr(g_cfgio.path, '/');
+	char dir[1024];
+	snprintf(dir, sizeof(dir), "%.*s", slash ? (int)(slash - g_cfgio.path) : 1, slash ? g_cfgio.path : ".");
+	g_cfgio.name = slash ? slash + 1 : g_cfgio.path;
+
+	g_cfgio.known = stat(g_cfgio.path, &g_cfgio.known_st) == 0;
+
+	/* The directory, not the file: saving usually replaces the file by a rename */
+	g_cfgio.inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	g_cfgio.wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if (g_cfgio.inotify_fd < 0 || g_cfgio.wake_fd < 0 ||
+	    inotify_add_watch(g_cfgio.inotify_fd, dir[0] ? dir : "/", IN_CLOSE_WRITE | IN_MOVED_TO) < 0 ||
+	    pthread_create(&g_cfgio.watcher, NULL, watch_thread, NULL) != 0) {
+		obs_log(LOG_WARNING, "tbar-web: not watching %s for changes", g_cfgio.path);
+		if (g_cfgio.inotify_fd >= 0)
+			close(g_cfgio.inotify_fd);
+		if (g_cfgio.wake_fd >= 0)
+			close(g_cfgio.wake_fd);
+		g_cfgio.inotify_fd = g_cfgio.wake_fd = -1;
+		return;
+	}
+	g_cfgio.watching = true;
+}
+
+static void watch_stop(void)
+{
+	if (!g_cfgio.watching)
+		return;
+	uint64_t one = 1;
+	ssize_t r = write(g_cfgio.wake_fd, &one, sizeof(one));
+	(void)r;
+	pthread_join(g_cfgio.watcher, NULL);
+	close(g_cfgio.inotify_fd);
+	close(g_cfgio.wake_fd);
+	g_cfgio.inotify_fd = g_cfgio.wake_fd = -1;
+	g_cfgio.watching = false;
+}
+
+#endif
+
+void tbar_config_open(const char *path, tbar_config_change_cb on_change)
+{
+	if (g_cfgio.open)
+		return;
+
+	g_cfgio.path = bstrdup(path);
+	g_cfgio.on_change = on_change;
+	g_cfgio.stop = false;
+	if (pthread_create(&g_cfgio.writer, NULL, writer_thread, NULL) != 0) {
+		obs_log(LOG_ERROR, "tbar-web: failed to start the config writer (pthread_create)");
+		bfree(g_cfgio.path);
+		g_cfgio.path = NULL;
+		return;
+	}
+	pthread_mutex_lock(&g_cfgio.mutex);
+	g_cfgio.open = true;
+	pthread_mutex_unlock(&g_cfgio.mutex);
+
+#ifdef __linux__
+	watch_start();
+#endif
+}
+
+void tbar_config_close(void)
+{
+	if (!g_cfgio.open)
+		return;
+
+#ifdef __linux__
+	watch_stop();
+#endif
+
+	pthread_mutex_lock(&g_cfgio.mutex);
+	g_cfgio.open = false;
+	g_cfgio.stop = true;
+	pthread_cond_signal(&g_cfgio.cond);
+	pthread_mutex_unlock(&g_cfgio.mutex);
+	pthread_join(g_cfgio.writer, NULL);
+
+	bfree(g_cfgio.path);
+	g_cfgio.path = NULL;
+}
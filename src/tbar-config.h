@@ -0,0 +1,50 @@
+/*
+Plugin Name
+Copyright (C) <Year> <Developer> <Email Address>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#pragma once
+
+#include <obs-data.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* The plugin's config file, written and watched off the request path.
+
+   tbar_config_save() only hands the settings over. A writer thread waits
+   until changes have been quiet for a moment, then writes the file (with the
+   usual tmp/bak rotation) and flushes it to disk. On Linux the file is also
+   watched with inotify: an edit made by anything else is parsed and passed
+   to `on_change` on the watcher thread, which then owns the data. The
+   plugin's own writes are recognized and not reported. */
+
+typedef void (*tbar_config_change_cb)(obs_data_t *data);
+
+/* Starts the writer (and the watcher); does nothing if already open */
+void tbar_config_open(const char *path, tbar_config_change_cb on_change);
+
+/* Takes ownership of `data`; replaces a write that has not happened yet.
+   Never touches the disk, so it is safe on the socket thread. */
+void tbar_config_save(obs_data_t *data);
+
+/* Writes whatever is still pending, then stops both threads */
+void tbar_config_close(void);
+
+#ifdef __cplusplus
+}
+#endif
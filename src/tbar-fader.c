@@ -0,0 +1,86 @@
+/*
+Plugin Name
+Copyright (C) <Year> <Developer> <Email Address>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include "tbar-fader.h"
+
+unsigned tbar_fader_update(struct tbar_fader *fader, const struct tbar_fader_backend *backend, void *ctx, double pos,
+			   bool release, uint64_t now_ms, double *left_at)
+{
+	double t = pos;
+	if (t < 0.0)
+		t = 0.0;
+	if (t > 1.0)
+		t = 1.0;
+	*left_at = t;
+
+	bool fixed = false;
+	unsigned flags = backend->begin(ctx, &fixed);
+	if (flags)
+		return flags;
+
+	/* Start a manual transition the first time we move away from 0 */
+	if (!fader->manual_active && t > 0.0 && now_ms - fader->last_start_ms > TBAR_FADER_DEBOUNCE_MS) {
+		fader->last_start_ms = now_ms;
+		backend->clear(ctx);
+		unsigned scenes = backend->load_scenes(ctx);
+		if (scenes) {
+			flags |= scenes;
+			backend->clear(ctx);
+		} else if (fixed) {
+			/* Nothing to drive; a release at max triggers it instead */
+			flags |= TBAR_FADER_FIXED;
+			backend->clear(ctx);
+		} else if (backend->start(ctx)) {
+			fader->manual_active = true;
+			flags |= TBAR_FADER_STARTED;
+		} else {
+			flags |= TBAR_FADER_START_FAILED;
+			backend->clear(ctx);
+		}
+	}
+
+	if (fader->manual_active)
+		backend->set_time(ctx, t);
+
+	/* Finish (near 1), cancel (near 0) or cut, and reset */
+	if (release && now_ms - fader->last_release_ms < TBAR_FADER_DEBOUNCE_MS) {
+		flags |= TBAR_FADER_DEBOUNCED;
+	} else if (release) {
+		fader->last_release_ms = now_ms;
+		unsigned ended = 0;
+		if (fixed && t >= TBAR_T_FINISH) {
+			backend->cut(ctx);
+			ended = TBAR_FADER_CUT;
+		} else if (fader->manual_active && t >= TBAR_T_FINISH) {
+			backend->finish(ctx);
+			ended = TBAR_FADER_FINISHED;
+		} else if (fader->manual_active && t <= TBAR_T_CANCEL) {
+			backend->cancel(ctx);
+			ended = TBAR_FADER_CANCELLED;
+		}
+		if (ended) {
+			flags |= ended;
+			fader->manual_active = false;
+			backend->clear(ctx);
+			*left_at = 0.0;
+		}
+	}
+
+	backend->end(ctx);
+	return flags;
+}
@@ -0,0 +1,85 @@
+/*
+Plugin Name
+Copyright (C) <Year> <Developer> <Email Address>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* The manual-transition decisions behind one T-bar: when a move starts, when
+   a release finishes, cancels or cuts, and the debounces around both. It
+   knows nothing about OBS; every effect goes through a backend, and the time
+   is passed in, so it runs the same under the plugin, a test or a benchmark. */
+
+/* A release at or beyond these finishes or cancels the move: 10 steps from
+   either end of the frontend's 0..1023 T-bar */
+#define TBAR_T_FINISH ((1023.0 - 10.0) / 1023.0)
+#define TBAR_T_CANCEL (10.0 / 1023.0)
+
+/* Minimum time between two starts and between two releases */
+#define TBAR_FADER_DEBOUNCE_MS 250
+
+/* What tbar_fader_update() did or declined to do, as a set of flags */
+enum tbar_fader_flag {
+	TBAR_FADER_IGNORED = 1 << 0,       /* backend: main output outside Studio Mode */
+	TBAR_FADER_NO_TRANSITION = 1 << 1, /* backend: no transition on the output */
+	TBAR_FADER_NO_SCENES = 1 << 2,     /* backend: program or preview missing */
+	TBAR_FADER_SAME_SCENE = 1 << 3,    /* backend: program == preview */
+	TBAR_FADER_FIXED = 1 << 4,         /* fixed transition: no move, cut on a release at max */
+	TBAR_FADER_STARTED = 1 << 5,
+	TBAR_FADER_START_FAILED = 1 << 6,
+	TBAR_FADER_DEBOUNCED = 1 << 7, /* release too soon after the previous one */
+	TBAR_FADER_CUT = 1 << 8,
+	TBAR_FADER_FINISHED = 1 << 9,
+	TBAR_FADER_CANCELLED = 1 << 10,
+};
+
+struct tbar_fader_backend {
+	/* Acquires the transition for this update. Returns 0, or TBAR_FADER_IGNORED
+	   / TBAR_FADER_NO_TRANSITION to skip the update (end() is not called then). */
+	unsigned (*begin)(void *ctx, bool *fixed);
+	/* Looks up the scenes for a new move: 0, TBAR_FADER_NO_SCENES or TBAR_FADER_SAME_SCENE */
+	unsigned (*load_scenes)(void *ctx);
+	bool (*start)(void *ctx);
+	void (*set_time)(void *ctx, double t);
+	void (*finish)(void *ctx); /* to the end, then swap the scenes */
+	void (*cancel)(void *ctx); /* back to the start */
+	void (*cut)(void *ctx);    /* fixed transition released at max */
+	void (*clear)(void *ctx);  /* forget the scenes of the last move */
+	void (*end)(void *ctx);    /* releases what begin() acquired */
+};
+
+struct tbar_fader {
+	bool manual_active;
+	uint64_t last_start_ms;
+	uint64_t last_release_ms;
+};
+
+/* Applies one position (clamped to 0..1) at time `now_ms` (any monotonic
+   millisecond clock). `*left_at` is where the fader is left: the position, or
+   0 once a release has finished, cancelled or cut. Returns tbar_fader_flag bits. */
+unsigned tbar_fader_update(struct tbar_fader *fader, const struct tbar_fader_backend *backend, void *ctx, double pos,
+			   bool release, uint64_t now_ms, double *left_at);
+
+#ifdef __cplusplus
+}
+#endif
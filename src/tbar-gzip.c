@@ -0,0 +1,207 @@
+/*
+Plugin Name
+Copyright (C) <Year> <Developer> <Email Address>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include "tbar-gzip.h"
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define WINDOW_SIZE 32768
+#define HASH_BITS 15
+#define MIN_MATCH 3
+#define MAX_MATCH 258
+#define MAX_CHAIN 128
+
+struct bit_writer {
+	uint8_t *out;
+	size_t cap;
+	size_t len;
+	uint32_t bits;
+	int nbits;
+	bool overflow;
+};
+
+static void put_bits(struct bit_writer *w, uint32_t value, int count)
+{
+	w->bits |= value << w->nbits;
+	w->nbits += count;
+	while (w->nbits >= 8) {
+		if (w->len < w->cap)
+			w->out[w->len++] = (uint8_t)w->bits;
+		else
+			w->overflow = true;
+		w->bits >>= 8;
+		w->nbits -= 8;
+	}
+}
+
+static void put_byte(struct bit_writer *w, uint8_t b)
+{
+	put_bits(w, b, 8);
+}
+
+/* Huffman codes go out most significant bit first */
+static void put_code(struct bit_writer *w, uint32_t code, int count)
+{
+	uint32_t rev = 0;
+	for (int i = 0; i < count; i++)
+		rev |= ((code >> i) & 1) << (count - 1 - i);
+	put_bits(w, rev, count);
+}
+
+/* Fixed literal/length code (RFC 1951 3.2.6) */
+static void put_symbol(struct bit_writer *w, int sym)
+{
+	if (sym < 144)
+		put_code(w, 0x30 + (uint32_t)sym, 8);
+	else if (sym < 256)
+		put_code(w, 0x190 + (uint32_t)(sym - 144), 9);
+	else if (sym < 280)
+		put_code(w, (uint32_t)(sym - 256), 7);
+	else
+		put_code(w, 0xc0 + (uint32_t)(sym - 280), 8);
+}
+
+static const uint16_t g_len_base[29] = {3,  4,  5,  6,  7,  8,  9,  10, 11,  13,  15,  17,  19,  23, 27,
+					31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+static const uint8_t g_len_extra[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2,
+					2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+static const uint16_t g_dist_base[30] = {1,   2,   3,   4,   5,   7,    9,    13,   17,   25,
+					 33,  49,  65,  97,  129, 193,  257,  385,  513,  769,
+					 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+static const uint8_t g_dist_extra[30] = {0, 0, 0, 0, 1, 1, 2, 2,  3,  3,  4,  4,  5,  5,  6,
+					 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+
+static void put_match(struct bit_writer *w, int length, int distance)
+{
+	int l = 28;
+	while (g_len_base[l] > length)
+		l--;
+	put_symbol(w, 257 + l);
+	put_bits(w, (uint32_t)(length - g_len_base[l]), g_len_extra[l]);
+
+	int d = 29;
+	while (g_dist_base[d] > distance)
+		d--;
+	put_code(w, (uint32_t)d, 5);
+	put_bits(w, (uint32_t)(distance - g_dist_base[d]), g_dist_extra[d]);
+}
+
+static uint32_t crc32(const uint8_t *p, size_t len)
+{
+	uint32_t crc = 0xffffffffu;
+	for (size_t i = 0; i < len; i++) {
+		crc ^= p[i];
+		for (int k = 0; k < 8; k++)
+			crc = (crc >> 1) ^ (0xedb88320u & (0u - (crc & 1)));
+	}
+	return ~crc;
+}
+
+static uint32_t hash3(const uint8_t *p)
+{
+	uint32_t v = (uint32_t)p[0] << 16 | (uint32_t)p[1] << 8 | p[2];
+	return (v * 2654435761u) >> (32 - HASH_BITS);
+}
+
+size_t tbar_gzip_compress(const uint8_t *in, size_t len, uint8_t *out, size_t cap)
+{
+	int32_t *head = malloc(sizeof(int32_t) << HASH_BITS);
+	int32_t *prev = malloc(sizeof(int32_t) * WINDOW_SIZE);
+	if (!head || !prev) {
+		free(head);
+		free(prev);
+		return 0;
+	}
+	for (size_t i = 0; i < ((size_t)1 << HASH_BITS); i++)
+		head[i] = -1;
+
+	struct bit_writer w = {out, cap, 0, 0, 0, false};
+
+	/* Header: magic, deflate, no flags, no mtime, no extra flags, unknown OS */
+	static const uint8_t header[10] = {0x1f, 0x8b, 8, 0, 0, 0, 0, 0, 0, 255};
+	for (int i = 0; i < 10; i++)
+		put_byte(&w, header[i]);
+
+	/* One final block with the fixed code */
+	put_bits(&w, 1, 1);
+	put_bits(&w, 1, 2);
+
+	size_t pos = 0;
+	while (pos < len) {
+		int best_len = 0;
+		int best_dist = 0;
+
+		if (pos + MIN_MATCH <= len) {
+			uint32_t h = hash3(in + pos);
+			size_t max_len = len - pos < MAX_MATCH ? len - pos : MAX_MATCH;
+			int32_t cand = head[h];
+
+			for (int chain = 0; cand >= 0 && chain < MAX_CHAIN; chain++) {
+				size_t dist = pos - (size_t)cand;
+				if (dist > WINDOW_SIZE)
+					break;
+				if (in[cand + best_len] == in[pos + best_len]) {
+					size_t n = 0;
+					while (n < max_len && in[cand + n] == in[pos + n])
+						n++;
+					if ((int)n > best_len) {
+						best_len = (int)n;
+						best_dist = (int)dist;
+						if (n == max_len)
+							break;
+					}
+				}
+				int32_t next = prev[cand & (WINDOW_SIZE - 1)];
+				if (next >= cand)
+					break;
+				cand = next;
+			}
+		}
+
+		size_t advance = best_len >= MIN_MATCH ? (size_t)best_len : 1;
+		if (best_len >= MIN_MATCH)
+			put_match(&w, best_len, best_dist);
+		else
+			put_symbol(&w, in[pos]);
+
+		/* Index every position covered so later matches can start anywhere */
+		for (size_t i = 0; i < advance; i++, pos++) {
+			if (pos + MIN_MATCH <= len) {
+				uint32_t h = hash3(in + pos);
+				prev[pos & (WINDOW_SIZE - 1)] = head[h];
+				head[h] = (int32_t)pos;
+			}
+		}
+	}
+
+	put_symbol(&w, 256);
+	if (w.nbits)
+		put_bits(&w, 0, 8 - w.nbits);
+
+	uint32_t crc = crc32(in, len);
+	for (int i = 0; i < 4; i++)
+		put_byte(&w, (uint8_t)(crc >> (8 * i)));
+	for (int i = 0; i < 4; i++)
+		put_byte(&w, (uint8_t)((uint32_t)len >> (8 * i)));
+
+	free(head);
+	free(prev);
+	return w.overflow ? 0 : w.len;
+}
@@ -0,0 +1,36 @@
+/*
+Plugin Name
+Copyright (C) <Year> <Developer> <Email Address>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Small gzip (RFC 1952) encoder for precompressing the built-in assets once
+   at startup: LZ77 with hash chains and the fixed Huffman code. Not fast or
+   optimal, but needs no zlib. Returns the compressed size, or 0 if it did not
+   fit in `cap` bytes. */
+size_t tbar_gzip_compress(const uint8_t *in, size_t len, uint8_t *out, size_t cap);
+
+#ifdef __cplusplus
+}
+#endif
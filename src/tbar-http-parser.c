@@ -0,0 +1,321 @@
+/*
+Plugin Name
+Copyright (C) <Year> <Developer> <Email Address>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include "tbar-http-parser.h"
+
+#include <string.h>
+
+enum parse_state {
+	STATE_REQUEST_LINE,
+	STATE_HEADERS,
+	STATE_DONE,
+	STATE_FAILED,
+};
+
+static inline char lower(char ch)
+{
+	return ch >= 'A' && ch <= 'Z' ? (char)(ch + ('a' - 'A')) : ch;
+}
+
+static bool mem_case_eq(const char *a, const char *lit, size_t len)
+{
+	for (size_t i = 0; i < len; i++) {
+		if (lower(a[i]) != lit[i])
+			return false;
+	}
+	return true;
+}
+
+bool tbar_http_str_eq(struct tbar_http_str s, const char *lit)
+{
+	size_t len = strlen(lit);
+	return s.len == len && memcmp(s.ptr, lit, len) == 0;
+}
+
+bool tbar_http_str_case_eq(struct tbar_http_str s, const char *lit)
+{
+	size_t len = strlen(lit);
+	if (s.len != len)
+		return false;
+	for (size_t i = 0; i < len; i++) {
+		if (lower(s.ptr[i]) != lower(lit[i]))
+			return false;
+	}
+	return true;
+}
+
+bool tbar_http_has_token(struct tbar_http_str value, const char *token)
+{
+	const char *p = value.ptr;
+	const char *end = value.ptr + value.len;
+
+	while (p < end) {
+		while (p < end && (*p == ' ' || *p == '\t' || *p == ','))
+			p++;
+		const char *start = p;
+		while (p < end && *p != ',')
+			p++;
+		const char *stop = p;
+		while (stop > start && (stop[-1] == ' ' || stop[-1] == '\t'))
+			stop--;
+
+		struct tbar_http_str item = {start, (size_t)(stop - start)};
+		if (item.len && tbar_http_str_case_eq(item, token))
+			return true;
+	}
+	return false;
+}
+
+struct tbar_http_str tbar_http_header(const struct tbar_http_request *r, const char *name)
+{
+	for (int i = 0; i < r->header_count; i++) {
+		if (tbar_http_str_case_eq(tbar_http_span_str(r, r->header_names[i]), name))
+			return tbar_http_span_str(r, r->header_values[i]);
+	}
+	struct tbar_http_str none = {NULL, 0};
+	return none;
+}
+
+void tbar_http_parser_reset(struct tbar_http_parser *p)
+{
+	/* The header arrays are only read up to header_count; skip clearing them */
+	p->state = STATE_REQUEST_LINE;
+	p->line_start = 0;
+	p->scan = 0;
+	p->have_content_length = false;
+	p->connection_close = false;
+	p->connection_keep_alive = false;
+	p->error_status = 0;
+	p->error_reason = NULL;
+
+	p->req.base = NULL;
+	p->req.method = TBAR_HTTP_OTHER;
+	p->req.header_count = 0;
+	p->req.header_len = 0;
+	p->req.content_length = 0;
+	p->req.keep_alive = false;
+	p->req.connection_upgrade = false;
+}
+
+/* Records the error response; returns false so helpers can `return reject(...)` */
+static bool reject(struct tbar_http_parser *p, int status, const char *reason)
+{
+	p->state = STATE_FAILED;
+	p->error_status = status;
+	p->error_reason = reason;
+	return false;
+}
+
+static struct tbar_http_span span(size_t off, size_t len)
+{
+	struct tbar_http_span s = {(uint32_t)off, (uint32_t)len};
+	return s;
+}
+
+static enum tbar_http_method method_from(const char *m, size_t len)
+{
+	switch (len) {
+	case 3:
+		return memcmp(m, "GET", 3) == 0 ? TBAR_HTTP_GET : TBAR_HTTP_OTHER;
+	case 4:
+		if (memcmp(m, "POST", 4) == 0)
+			return TBAR_HTTP_POST;
+		return memcmp(m, "HEAD", 4) == 0 ? TBAR_HTTP_HEAD : TBAR_HTTP_OTHER;
+	case 7:
+		return memcmp(m, "OPTIONS", 7) == 0 ? TBAR_HTTP_OPTIONS : TBAR_HTTP_OTHER;
+	default:
+		return TBAR_HTTP_OTHER;
+	}
+}
+
+/* "METHOD SP request-target SP HTTP/1.x" */
+static bool parse_request_line(struct tbar_http_parser *p, const char *buf, size_t off, size_t len)
+{
+	struct tbar_http_request *r = &p->req;
+	const char *line = buf + off;
+
+	const char *sp1 = memchr(line, ' ', len);
+	if (!sp1 || sp1 == line)
+		return reject(p, 400, "Bad Request");
+	size_t method_len = (size_t)(sp1 - line);
+
+	const char *target = sp1 + 1;
+	const char *sp2 = memchr(target, ' ', len - method_len - 1);
+	if (!sp2 || sp2 == target || (*target != '/' && *target != '*'))
+		return reject(p, 400, "Bad Request");
+	size_t target_len = (size_t)(sp2 - target);
+
+	const char *version = sp2 + 1;
+	size_t version_len = len - (size_t)(version - line);
+	if (version_len != 8 || memcmp(version, "HTTP/", 5) != 0 || version[6] != '.' || version[5] < '0' ||
+	    version[5] > '9' || version[7] < '0' || version[7] > '9')
+		return reject(p, 400, "Bad Request");
+	if (version[5] != '1')
+		return reject(p, 505, "HTTP Version Not Supported");
+
+	r->method = method_from(line, method_len);
+	r->method_name = span(off, method_len);
+	r->minor_version = version[7] - '0';
+
+	size_t target_off = off + method_len + 1;
+	const char *q = memchr(target, '?', target_len);
+	if (q) {
+		size_t path_len = (size_t)(q - target);
+		r->path = span(target_off, path_len);
+		r->query = span(target_off + path_len + 1, target_len - path_len - 1);
+	} else {
+		r->path = span(target_off, target_len);
+		r->query = span(target_off + target_len, 0);
+	}
+	return true;
+}
+
+static bool parse_content_length(struct tbar_http_parser *p, const char *v, size_t len)
+{
+	if (!len)
+		return reject(p, 400, "Bad Request");
+
+	uint64_t n = 0;
+	for (size_t i = 0; i < len; i++) {
+		if (v[i] < '0' || v[i] > '9')
+			return reject(p, 400, "Bad Request");
+		/* Anything this large is rejected as too big by the caller anyway */
+		if (n < UINT64_MAX / 100)
+			n = n * 10 + (uint64_t)(v[i] - '0');
+	}
+
+	if (p->have_content_length && p->req.content_length != n)
+		return reject(p, 400, "Bad Request");
+	p->have_content_length = true;
+	p->req.content_length = n;
+	return true;
+}
+
+static bool parse_header(struct tbar_http_parser *p, const char *buf, size_t off, size_t len)
+{
+	struct tbar_http_request *r = &p->req;
+	const char *line = buf + off;
+
+	/* Obsolete line folding is not supported (RFC 9112 allows rejecting it) */
+	if (line[0] == ' ' || line[0] == '\t')
+		return reject(p, 400, "Bad Request");
+
+	const char *colon = memchr(line, ':', len);
+	if (!colon || colon == line)
+		return reject(p, 400, "Bad Request");
+	size_t name_len = (size_t)(colon - line);
+	for (size_t i = 0; i < name_len; i++) {
+		if ((unsigned char)line[i] <= ' ' || line[i] == 0x7f)
+			return reject(p, 400, "Bad Request");
+	}
+
+	size_t v = name_len + 1;
+	size_t e = len;
+	while (v < e && (line[v] == ' ' || line[v] == '\t'))
+		v++;
+	while (e > v && (line[e - 1] == ' ' || line[e - 1] == '\t'))
+		e--;
+
+	if (r->header_count == TBAR_HTTP_MAX_HEADERS)
+		return reject(p, 431, "Request Header Fields Too Large");
+	r->header_names[r->header_count] = span(off, name_len);
+	r->header_values[r->header_count] = span(off + v, e - v);
+	r->header_count++;
+
+	/* The few headers the core itself needs are interpreted right here */
+	struct tbar_http_str value = {line + v, e - v};
+	switch (name_len) {
+	case 10:
+		if (mem_case_eq(line, "connection", 10)) {
+			p->connection_close |= tbar_http_has_token(value, "close");
+			p->connection_keep_alive |= tbar_http_has_token(value, "keep-alive");
+			r->connection_upgrade |= tbar_http_has_token(value, "upgrade");
+		}
+		break;
+	case 14:
+		if (mem_case_eq(line, "content-length", 14))
+			return parse_content_length(p, value.ptr, value.len);
+		break;
+	case 17:
+		/* No chunked request bodies; every client of ours sends Content-Length */
+		if (mem_case_eq(line, "transfer-encoding", 17))
+			return reject(p, 501, "Not Implemented");
+		break;
+	default:
+		break;
+	}
+	return true;
+}
+
+enum tbar_http_parse_result tbar_http_parse(struct tbar_http_parser *p, const char *buf, size_t len,
+					    size_t max_header_len)
+{
+	p->req.base = buf;
+
+	if (p->state == STATE_DONE)
+		return TBAR_HTTP_COMPLETE;
+	if (p->state == STATE_FAILED)
+		return TBAR_HTTP_ERROR;
+
+	size_t limit = len < max_header_len ? len : max_header_len;
+
+	for (;;) {
+		const char *nl = p->scan < limit ? memchr(buf + p->scan, '\n', limit - p->scan) : NULL;
+		if (!nl) {
+			p->scan = limit;
+			if (len >= max_header_len) {
+				if (p->state == STATE_REQUEST_LINE)
+					reject(p, 414, "URI Too Long");
+				else
+					reject(p, 431, "Request Header Fields Too Large");
+				return TBAR_HTTP_ERROR;
+			}
+			return TBAR_HTTP_INCOMPLETE;
+		}
+
+		size_t next = (size_t)(nl - buf) + 1;
+		size_t end = next - 1;
+		if (end > p->line_start && buf[end - 1] == '\r')
+			end--;
+		size_t line_len = end - p->line_start;
+
+		if (p->state == STATE_REQUEST_LINE) {
+			/* Empty lines before a request are ignored (RFC 9112 2.2) */
+			if (line_len) {
+				if (!parse_request_line(p, buf, p->line_start, line_len))
+					return TBAR_HTTP_ERROR;
+				p->state = STATE_HEADERS;
+			}
+		} else if (line_len) {
+			if (!parse_header(p, buf, p->line_start, line_len))
+				return TBAR_HTTP_ERROR;
+		} else {
+			struct tbar_http_request *r = &p->req;
+			r->header_len = next;
+			if (p->connection_close)
+				r->keep_alive = false;
+			else
+				r->keep_alive = p->connection_keep_alive || r->minor_version >= 1;
+			p->state = STATE_DONE;
+			return TBAR_HTTP_COMPLETE;
+		}
+
+		p->line_start = next;
+		p->scan = next;
+	}
+}
@@ -0,0 +1,120 @@
+/*
+Plugin Name
+Copyright (C) <Year> <Developer> <Email Address>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Incremental HTTP/1.x request head parser.
+
+   The parser never copies or modifies the input. It records offsets relative
+   to the start of the request, so the caller may move the bytes (e.g. compact
+   its buffer) between calls as long as the request keeps starting at the
+   buffer passed in. Each call resumes where the previous one stopped. */
+
+#define TBAR_HTTP_MAX_HEADERS 32
+
+enum tbar_http_method {
+	TBAR_HTTP_OTHER,
+	TBAR_HTTP_GET,
+	TBAR_HTTP_HEAD,
+	TBAR_HTTP_POST,
+	TBAR_HTTP_OPTIONS,
+};
+
+enum tbar_http_parse_result {
+	TBAR_HTTP_INCOMPLETE, /* need more bytes */
+	TBAR_HTTP_COMPLETE,   /* request head parsed; body follows at header_len */
+	TBAR_HTTP_ERROR,      /* respond with error_status and close */
+};
+
+/* A view into the request bytes; not NUL-terminated */
+struct tbar_http_str {
+	const char *ptr;
+	size_t len;
+};
+
+struct tbar_http_span {
+	uint32_t off;
+	uint32_t len;
+};
+
+struct tbar_http_request {
+	const char *base; /* request start as of the last parse call */
+
+	enum tbar_http_method method;
+	struct tbar_http_span method_name;
+	struct tbar_http_span path;  /* request target up to '?' */
+	struct tbar_http_span query; /* after '?', empty if none */
+	int minor_version;           /* HTTP/1.x */
+
+	struct tbar_http_span header_names[TBAR_HTTP_MAX_HEADERS];
+	struct tbar_http_span header_values[TBAR_HTTP_MAX_HEADERS]; /* surrounding whitespace trimmed */
+	int header_count;
+
+	size_t header_len; /* request line + headers + blank line */
+	uint64_t content_length;
+	bool keep_alive;         /* HTTP version default, overridden by Connection */
+	bool connection_upgrade; /* Connection lists "upgrade" */
+};
+
+struct tbar_http_parser {
+	int state;
+	size_t line_start; /* start of the line being parsed */
+	size_t scan;       /* bytes already searched for the end of that line */
+	bool have_content_length;
+	bool connection_close;
+	bool connection_keep_alive;
+
+	int error_status;
+	const char *error_reason;
+
+	struct tbar_http_request req;
+};
+
+void tbar_http_parser_reset(struct tbar_http_parser *p);
+
+/* Parses the request starting at buf[0]; `len` is everything received so far.
+   A head longer than `max_header_len` fails with 431 (414 for the request line). */
+enum tbar_http_parse_result tbar_http_parse(struct tbar_http_parser *p, const char *buf, size_t len,
+					    size_t max_header_len);
+
+static inline struct tbar_http_str tbar_http_span_str(const struct tbar_http_request *r, struct tbar_http_span s)
+{
+	struct tbar_http_str str = {r->base + s.off, s.len};
+	return str;
+}
+
+/* Case-insensitive header lookup; returns {NULL, 0} when absent */
+struct tbar_http_str tbar_http_header(const struct tbar_http_request *r, const char *name);
+
+bool tbar_http_str_eq(struct tbar_http_str s, const char *lit);
+bool tbar_http_str_case_eq(struct tbar_http_str s, const char *lit);
+
+/* True if the comma-separated list `value` contains `token` (case-insensitive) */
+bool tbar_http_has_token(struct tbar_http_str value, const char *token);
+
+#ifdef __cplusplus
+}
+#endif
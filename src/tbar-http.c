@@ -0,0 +1,476 @@
+/*
+Plugin Name
+Copyright (C) <Year> <Developer> <Email Address>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include "tbar-http.h"
+#include "tbar-metrics.h"
+#include "tbar-sse.h"
+#include "tbar-ws.h"
+
+#include <util/platform.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static struct tbar_http_limits g_limits = {
+	.header_timeout_ms = 5000,
+	.body_timeout_ms = 5000,
+	.max_conns = TBAR_MAX_CONNS,
+};
+
+void tbar_http_set_limits(const struct tbar_http_limits *limits)
+{
+	g_limits = *limits;
+	if (g_limits.max_conns <= 0 || g_limits.max_conns > TBAR_MAX_CONNS)
+		g_limits.max_conns = TBAR_MAX_CONNS;
+}
+
+int tbar_http_max_conns(void)
+{
+	return g_limits.max_conns;
+}
+
+#define REJECT_RESPONSE(code, reason, body_len)       \
+	"HTTP/1.1 " #code " " reason "\r\n"           \
+	"Content-Type: text/plain; charset=utf-8\r\n" \
+	"Content-Length: " #body_len "\r\n"           \
+	"Connection: close\r\n"                       \
+	"Access-Control-Allow-Origin: *\r\n"          \
+	"\r\n"
+
+static const char g_reject_408[] = REJECT_RESPONSE(408, "Request Timeout", 15) "request timeout";
+static const char g_reject_503[] = REJECT_RESPONSE(503, "Service Unavailable", 20) "too many connections";
+
+const char *tbar_http_reject_response(int code, size_t *len)
+{
+	if (code == 408) {
+		*len = sizeof(g_reject_408) - 1;
+		return g_reject_408;
+	}
+	*len = sizeof(g_reject_503) - 1;
+	return g_reject_503;
+}
+
+int tbar_conn_find_slow(const struct tbar_conn *conns, int count, uint64_t now_ns)
+{
+	const uint64_t min_age = (uint64_t)TBAR_EVICT_MIN_AGE_MS * 1000000;
+	int victim = -1;
+	uint64_t oldest = 0;
+
+	for (int i = 0; i < count; i++) {
+		const struct tbar_conn *c = &conns[i];
+		if (!c->in_use || c->websocket || c->sse)
+			continue;
+		uint64_t since = c->request_start_ns ? c->request_start_ns : c->last_active_ns;
+		uint64_t age = now_ns - since;
+		if (age >= min_age && age > oldest) {
+			oldest = age;
+			victim = i;
+		}
+	}
+	return victim;
+}
+
+struct tbar_shared_buf *tbar_shared_buf_create(const void *data, size_t len, int tag)
+{
+	struct tbar_shared_buf *buf = malloc(sizeof(*buf) + len);
+	if (!buf)
+		return NULL;
+	buf->refs = 1;
+	buf->tag = tag;
+	buf->len = len;
+	buf->bytes = buf->data;
+	buf->free_bytes = NULL;
+	memcpy(buf->data, data, len);
+	return buf;
+}
+
+struct tbar_shared_buf *tbar_shared_buf_wrap(const char *bytes, size_t len,
+					     void (*free_bytes)(const char *bytes, size_t len))
+{
+	struct tbar_shared_buf *buf = malloc(sizeof(*buf));
+	if (!buf) {
+		free_bytes(bytes, len);
+		return NULL;
+	}
+	buf->refs = 1;
+	buf->tag = 0;
+	buf->len = len;
+	buf->bytes = bytes;
+	buf->free_bytes = free_bytes;
+	return buf;
+}
+
+void tbar_shared_buf_release(struct tbar_shared_buf *buf)
+{
+	if (!buf || --buf->refs)
+		return;
+	if (buf->free_bytes)
+		buf->free_bytes(buf->bytes, buf->len);
+	free(buf);
+}
+
+void tbar_conn_reset(struct tbar_conn *c)
+{
+	for (int i = 0; i < c->seg_count; i++)
+		tbar_shared_buf_release(c->segs[(c->seg_head + i) % TBAR_CONN_MAX_SEGS].shared);
+	if (c->sse)
+		tbar_sse_detach(c);
+
+	c->closing = false;
+	c->keep_alive = false;
+	c->websocket = false;
+	c->sse = false;
+	c->last_active_ns = 0;
+	c->last_ping_ns = 0;
+	c->last_drained_ns = 0;
+	c->request_start_ns = 0;
+	c->body_start_ns = 0;
+	c->in_len = 0;
+	c->in[0] = '\0';
+	tbar_http_parser_reset(&c->parser);
+	c->out_len = 0;
+	c->out_off = 0;
+	c->seg_head = 0;
+	c->seg_count = 0;
+	c->seg_off = 0;
+	c->out_pending = 0;
+}
+
+void tbar_conn_free(struct tbar_conn *c)
+{
+	free(c->out);
+	c->out = NULL;
+	c->out_cap = 0;
+	tbar_conn_reset(c);
+	c->in_use = false;
+}
+
+static struct tbar_out_seg *seg_tail(struct tbar_conn *c)
+{
+	if (!c->seg_count)
+		return NULL;
+	return &c->segs[(c->seg_head + c->seg_count - 1) % TBAR_CONN_MAX_SEGS];
+}
+
+static void seg_push(struct tbar_conn *c, const char *ref, size_t len, struct tbar_shared_buf *shared)
+{
+	struct tbar_out_seg *seg = &c->segs[(c->seg_head + c->seg_count) % TBAR_CONN_MAX_SEGS];
+	seg->ref = ref;
+	seg->len = len;
+	seg->shared = shared;
+	c->seg_count++;
+}
+
+bool tbar_conn_write(struct tbar_conn *c, const void *data, size_t len)
+{
+	if (!len)
+		return true;
+
+	/* Drop already-sent bytes before growing */
+	if (c->out_off == c->out_len) {
+		c->out_off = 0;
+		c->out_len = 0;
+	}
+
+	if (c->out_len + len > c->out_cap) {
+		size_t cap = c->out_cap ? c->out_cap : 1024;
+		while (cap < c->out_len + len)
+			cap *= 2;
+		char *p = realloc(c->out, cap);
+		if (!p)
+			return false;
+		c->out = p;
+		c->out_cap = cap;
+	}
+
+	memcpy(c->out + c->out_len, data, len);
+	c->out_len += len;
+	c->out_pending += len;
+
+	/* Owned bytes are contiguous, so consecutive writes share a segment.
+	   tbar_conn_write_ref() always leaves a slot free for this. */
+	struct tbar_out_seg *tail = seg_tail(c);
+	if (tail && !tail->ref)
+		tail->len += len;
+	else
+		seg_push(c, NULL, len, NULL);
+	return true;
+}
+
+bool tbar_conn_write_ref(struct tbar_conn *c, const char *data, size_t len)
+{
+	if (!len)
+		return true;
+	if (c->seg_count >= TBAR_CONN_MAX_SEGS - 1)
+		return tbar_conn_write(c, data, len);
+
+	seg_push(c, data, len, NULL);
+	c->out_pending += len;
+	return true;
+}
+
+bool tbar_conn_write_shared(struct tbar_conn *c, struct tbar_shared_buf *buf)
+{
+	return tbar_conn_write_shared_range(c, buf, 0, buf->len);
+}
+
+bool tbar_conn_write_shared_range(struct tbar_conn *c, struct tbar_shared_buf *buf, size_t offset, size_t len)
+{
+	if (!len)
+		return true;
+	if (c->seg_count >= TBAR_CONN_MAX_SEGS - 1)
+		return tbar_conn_write(c, buf->bytes + offset, len);
+
+	buf->refs++;
+	seg_push(c, buf->bytes + offset, len, buf);
+	c->out_pending += len;
+	return true;
+}
+
+bool tbar_conn_replace_shared(struct tbar_conn *c, struct tbar_shared_buf *buf)
+{
+	struct tbar_out_seg *tail = seg_tail(c);
+	if (!tail || !tail->shared || tail->shared->tag != buf->tag)
+		return false;
+	/* Already partly on the wire */
+	if (c->seg_count == 1 && c->seg_off)
+		return false;
+
+	c->out_pending = c->out_pending - tail->len + buf->len;
+	tbar_shared_buf_release(tail->shared);
+	buf->refs++;
+	tail->shared = buf;
+	tail->ref = buf->bytes;
+	tail->len = buf->len;
+	return true;
+}
+
+int tbar_conn_output_iov(const struct tbar_conn *c, struct tbar_iov *iov, int max)
+{
+	/* Owned segments are laid out back to back from out_off */
+	const char *owned = c->out + c->out_off;
+	int n = 0;
+
+	for (int i = 0; i < c->seg_count && n < max; i++) {
+		const struct tbar_out_seg *seg = &c->segs[(c->seg_head + i) % TBAR_CONN_MAX_SEGS];
+		size_t skip = i == 0 ? c->seg_off : 0;
+		size_t len = seg->len - skip;
+
+		if (seg->ref) {
+			iov[n].base = seg->ref + skip;
+		} else {
+			iov[n].base = owned;
+			owned += len;
+		}
+		iov[n].len = len;
+		n++;
+	}
+	return n;
+}
+
+void tbar_conn_consume_output(struct tbar_conn *c, size_t n)
+{
+	tbar_metrics_add(TBAR_THREAD_SERVER, TBAR_COUNTER_BYTES_OUT, n);
+	c->out_pending -= n;
+
+	while (n && c->seg_count) {
+		struct tbar_out_seg *seg = &c->segs[c->seg_head];
+		size_t left = seg->len - c->seg_off;
+		size_t k = n < left ? n : left;
+
+		if (!seg->ref)
+			c->out_off += k;
+		c->seg_off += k;
+		n -= k;
+
+		if (c->seg_off == seg->len) {
+			tbar_shared_buf_release(seg->shared);
+			c->seg_head = (c->seg_head + 1) % TBAR_CONN_MAX_SEGS;
+			c->seg_count--;
+			c->seg_off = 0;
+		}
+	}
+
+	if (c->out_off >= c->out_len) {
+		c->out_off = 0;
+		c->out_len = 0;
+	}
+}
+
+void http_send(struct tbar_conn *c, int code, const char *status, const char *content_type, const char *body)
+{
+	if (!content_type)
+		content_type = "text/plain; charset=utf-8";
+	if (!body)
+		body = "";
+
+	const char *connection = c->keep_alive ? "Connection: keep-alive\r\n" : "Connection: close\r\n";
+
+	char headers[512];
+	int body_len = (int)strlen(body);
+	int n = snprintf(headers, sizeof(headers),
+			 "HTTP/1.1 %d %s\r\n"
+			 "Content-Type: %s\r\n"
+			 "Content-Length: %d\r\n"
+			 "%s"
+			 "Access-Control-Allow-Origin: *\r\n"
+			 "Access-Control-Allow-Headers: Content-Type\r\n"
+			 "Access-Control-Allow-Methods: GET,POST,OPTIONS\r\n"
+			 "\r\n",
+			 code, status, content_type, body_len, connection);
+	if (n > 0) {
+		tbar_conn_write(c, headers, (size_t)n);
+	}
+	if (body_len > 0) {
+		tbar_conn_write(c, body, (size_t)body_len);
+	}
+}
+
+/* Handles one request at the start of `req`. Returns its length, or 0 if it is
+   still incomplete (or was rejected and the connection is closing). */
+static size_t process_request(struct tbar_conn *c, char *req, size_t avail)
+{
+	uint64_t start_ns = os_gettime_ns();
+	struct tbar_http_parser *p = &c->parser;
+
+	enum tbar_http_parse_result res = tbar_http_parse(p, req, avail, TBAR_CONN_IN_SIZE - 1);
+	if (res == TBAR_HTTP_INCOMPLETE)
+		return 0;
+	if (res == TBAR_HTTP_ERROR) {
+		c->keep_alive = false;
+		http_send(c, p->error_status, p->error_reason, NULL, p->error_reason);
+		c->closing = true;
+		return 0;
+	}
+
+	const struct tbar_http_request *r = &p->req;
+	if (r->content_length > TBAR_CONN_IN_SIZE - 1 - r->header_len) {
+		c->keep_alive = false;
+		http_send(c, 413, "Payload Too Large", NULL, "payload too large");
+		c->closing = true;
+		return 0;
+	}
+
+	/* Wait for the rest of the body; it may arrive in later segments. The
+	   parser stays complete, so the head is not parsed again. */
+	size_t req_len = r->header_len + (size_t)r->content_length;
+	if (avail < req_len) {
+		if (!c->body_start_ns)
+			c->body_start_ns = start_ns;
+		return 0;
+	}
+
+	char saved = req[req_len];
+	req[req_len] = '\0';
+	c->keep_alive = r->keep_alive;
+	tbar_metrics_add(TBAR_THREAD_SERVER, TBAR_COUNTER_HTTP_REQUESTS, 1);
+	tbar_metrics_observe(TBAR_THREAD_SERVER, TBAR_HIST_REQUEST_PARSE, os_gettime_ns() - start_ns);
+	tbar_web_handle_request(c, r, req + r->header_len, (int)r->content_length);
+	req[req_len] = saved;
+
+	tbar_http_parser_reset(p);
+	c->request_start_ns = 0;
+	c->body_start_ns = 0;
+	if (!c->keep_alive)
+		c->closing = true;
+	return req_len;
+}
+
+void tbar_conn_on_input(struct tbar_conn *c)
+{
+	size_t off = 0;
+
+	c->in[c->in_len] = '\0';
+
+	while (tbar_conn_wants_input(c) && off < c->in_len) {
+		size_t used;
+
+		if (c->websocket) {
+			used = tbar_ws_process(c, c->in + off, c->in_len - off);
+		} else if (c->sse) {
+			/* Subscribers have nothing to say */
+			used = c->in_len - off;
+		} else if (c->in[off] == '\r' || c->in[off] == '\n') {
+			/* Tolerate stray CRLFs between pipelined requests */
+			used = 1;
+		} else {
+			used = process_request(c, c->in + off, c->in_len - off);
+		}
+
+		if (!used)
+			break;
+		off += used;
+	}
+
+	if (off > 0) {
+		memmove(c->in, c->in + off, c->in_len - off);
+		c->in_len -= off;
+		c->in[c->in_len] = '\0';
+	}
+
+	/* The read deadlines run from the first byte of whatever is left over.
+	   Input parked behind unsent output is not the client's fault, so the
+	   clock restarts once it drains. */
+	if (c->websocket || c->sse || !c->in_len || !tbar_conn_wants_input(c)) {
+		c->request_start_ns = 0;
+		c->body_start_ns = 0;
+	} else if (!c->request_start_ns) {
+		c->request_start_ns = os_gettime_ns();
+	}
+}
+
+/* Header and body deadlines are measured from when each phase began rather
+   than from the last byte, so a client trickling one byte at a time (slowloris)
+   cannot hold its slot forever. */
+static bool request_timed_out(const struct tbar_conn *c, uint64_t now_ns)
+{
+	if (!c->request_start_ns || !tbar_conn_wants_input(c))
+		return false;
+	if (c->body_start_ns)
+		return now_ns - c->body_start_ns > (uint64_t)g_limits.body_timeout_ms * 1000000;
+	return now_ns - c->request_start_ns > (uint64_t)g_limits.header_timeout_ms * 1000000;
+}
+
+bool tbar_conn_check_idle(struct tbar_conn *c, uint64_t now_ns)
+{
+	uint64_t idle = now_ns - c->last_active_ns;
+
+	if (c->sse)
+		return tbar_sse_check_idle(c, now_ns);
+
+	if (!c->websocket) {
+		if (request_timed_out(c, now_ns)) {
+			tbar_metrics_add(TBAR_THREAD_SERVER, TBAR_COUNTER_HTTP_TIMEOUTS, 1);
+			c->keep_alive = false;
+			http_send(c, 408, "Request Timeout", NULL, "request timeout");
+			c->closing = true;
+			return true;
+		}
+		return idle <= (uint64_t)TBAR_KEEPALIVE_TIMEOUT_MS * 1000000;
+	}
+
+	const uint64_t interval = (uint64_t)TBAR_WS_PING_INTERVAL_MS * 1000000;
+	if (idle > 3 * interval)
+		return false;
+	if (idle > interval && now_ns - c->last_ping_ns > interval) {
+		c->last_ping_ns = now_ns;
+		tbar_ws_send_ping(c);
+	}
+	return true;
+}
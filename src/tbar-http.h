@@ -0,0 +1,199 @@
+/*
+Plugin Name
+Copyright (C) <Year> <Developer> <Email Address>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#pragma once
+
+#include "tbar-http-parser.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Fixed connection table size shared by all server backends; sized for a few
+   hundred read-only /events viewers next to the controllers */
+#define TBAR_MAX_CONNS 512
+/* Per-connection request buffer (headers + body) */
+#define TBAR_CONN_IN_SIZE 8192
+/* Idle keep-alive connections are closed after this long without input */
+#define TBAR_KEEPALIVE_TIMEOUT_MS 15000
+/* A connection stuck mid-request (or silent) this long may be evicted for a new client */
+#define TBAR_EVICT_MIN_AGE_MS 1000
+/* Stop parsing pipelined requests while this much output is still unsent */
+#define TBAR_CONN_OUT_HIGH_WATER (64 * 1024)
+
+/* Pending output segments per connection; see tbar_conn_write_ref() */
+#define TBAR_CONN_MAX_SEGS 16
+
+/* Immutable, reference-counted output queued on many connections at once,
+   such as one serialized event fanned out to every subscriber. Only touched on
+   the server thread, so the count is a plain integer. */
+struct tbar_shared_buf {
+	int refs;
+	int tag; /* producer-defined kind, see tbar_conn_replace_shared() */
+	size_t len;
+	const char *bytes; /* `data`, or memory handed over to tbar_shared_buf_wrap() */
+	void (*free_bytes)(const char *bytes, size_t len);
+	char data[];
+};
+
+/* Returns a buffer holding a copy of `data` with one reference, or NULL */
+struct tbar_shared_buf *tbar_shared_buf_create(const void *data, size_t len, int tag);
+/* Same, without copying: `free_bytes(bytes, len)` runs when the last reference
+   is gone (e.g. to unmap a file). On failure it runs right away. */
+struct tbar_shared_buf *tbar_shared_buf_wrap(const char *bytes, size_t len,
+					     void (*free_bytes)(const char *bytes, size_t len));
+void tbar_shared_buf_release(struct tbar_shared_buf *buf);
+
+/* One pending output segment: either bytes copied into the connection's own
+   buffer (ref == NULL) or a reference to an immutable buffer, either one that
+   outlives the connection (a prebuilt static response) or a shared buffer the
+   segment holds a reference on until it has been sent. */
+struct tbar_out_seg {
+	const char *ref;
+	size_t len;
+	struct tbar_shared_buf *shared;
+};
+
+/* Backend-neutral iovec */
+struct tbar_iov {
+	const void *base;
+	size_t len;
+};
+
+/* Platform-neutral state for one client connection. The server backend owns
+   the socket and does the actual I/O; the HTTP core only touches the buffers. */
+struct tbar_conn {
+	bool in_use;
+	bool closing;    /* close once the output buffer has been flushed */
+	bool keep_alive; /* current request allows the connection to be reused */
+	bool websocket;  /* upgraded; input is parsed as WebSocket frames */
+	bool sse;        /* GET /events subscriber; input is ignored */
+	uint64_t last_active_ns;
+	uint64_t last_ping_ns;
+	uint64_t last_drained_ns; /* output queue last seen empty (sweep resolution) */
+	uint64_t request_start_ns; /* first byte of the pending request, 0 when none */
+	uint64_t body_start_ns;    /* its head completed, 0 until then */
+
+	char in[TBAR_CONN_IN_SIZE];
+	size_t in_len;
+	struct tbar_http_parser parser; /* request at the start of `in` */
+
+	/* Owned output bytes; out_off..out_len is unsent */
+	char *out;
+	size_t out_len;
+	size_t out_off;
+	size_t out_cap;
+
+	/* Send order of owned and referenced output, as a ring */
+	struct tbar_out_seg segs[TBAR_CONN_MAX_SEGS];
+	int seg_head;
+	int seg_count;
+	size_t seg_off;     /* bytes of segs[seg_head] already sent */
+	size_t out_pending; /* total unsent bytes */
+};
+
+/* Read deadlines and the connection cap, set before the server starts */
+struct tbar_http_limits {
+	int header_timeout_ms; /* first byte of a request -> end of its head */
+	int body_timeout_ms;   /* end of the head -> last byte of the body */
+	int max_conns;         /* clients beyond this are turned away with 503 */
+};
+
+void tbar_http_set_limits(const struct tbar_http_limits *limits);
+int tbar_http_max_conns(void);
+
+/* Complete "Connection: close" responses for clients that never get (or lose)
+   a connection slot, sent straight to the socket: 408 or 503. */
+const char *tbar_http_reject_response(int code, size_t *len);
+
+/* Picks the HTTP connection that has made the least progress for longest: its
+   incomplete request started, or it last sent anything, at least
+   TBAR_EVICT_MIN_AGE_MS ago. Lets a full table make room for a new client.
+   Returns -1 if no connection qualifies. */
+int tbar_conn_find_slow(const struct tbar_conn *conns, int count, uint64_t now_ns);
+
+void tbar_conn_reset(struct tbar_conn *c);
+void tbar_conn_free(struct tbar_conn *c);
+
+/* Space left in the input buffer (one byte is kept for a terminating NUL) */
+static inline size_t tbar_conn_in_space(const struct tbar_conn *c)
+{
+	return TBAR_CONN_IN_SIZE - 1 - c->in_len;
+}
+
+static inline bool tbar_conn_has_output(const struct tbar_conn *c)
+{
+	return c->seg_count > 0;
+}
+
+/* False while the client has enough unread responses queued; the backend
+   should stop reading until the output drains (pipelining backpressure). */
+static inline bool tbar_conn_wants_input(const struct tbar_conn *c)
+{
+	return !c->closing && c->out_pending < TBAR_CONN_OUT_HIGH_WATER;
+}
+
+/* Periodic check from the backend sweep. Enforces the read deadlines (queues a
+   408 and marks the connection closing) and the keep-alive timeout, and may
+   queue a WebSocket ping. Returns false when the connection should be closed. */
+bool tbar_conn_check_idle(struct tbar_conn *c, uint64_t now_ns);
+
+/* Called by the backend after appending received bytes to c->in (and again
+   once output has drained). Dispatches every complete request in the buffer
+   in order, so pipelined requests are answered in sequence. */
+void tbar_conn_on_input(struct tbar_conn *c);
+
+/* Fills up to `max` entries with the pending output, in order, for one
+   vectored send. Returns the number of entries used. */
+int tbar_conn_output_iov(const struct tbar_conn *c, struct tbar_iov *iov, int max);
+
+/* Marks `n` bytes of pending output as sent */
+void tbar_conn_consume_output(struct tbar_conn *c, size_t n);
+
+bool tbar_conn_write(struct tbar_conn *c, const void *data, size_t len);
+
+/* Queues `data` without copying. It must stay valid and unchanged until the
+   server has stopped. Falls back to copying if the segment ring is full. */
+bool tbar_conn_write_ref(struct tbar_conn *c, const char *data, size_t len);
+
+/* Queues a shared buffer, taking a reference until it has been sent */
+bool tbar_conn_write_shared(struct tbar_conn *c, struct tbar_shared_buf *buf);
+/* Same, for `len` bytes of it from `offset` */
+bool tbar_conn_write_shared_range(struct tbar_conn *c, struct tbar_shared_buf *buf, size_t offset, size_t len);
+
+/* Latest wins: if the last queued segment is a shared buffer with the same tag
+   that has not started sending, swaps it for `buf` and returns true. */
+bool tbar_conn_replace_shared(struct tbar_conn *c, struct tbar_shared_buf *buf);
+
+void http_send(struct tbar_conn *c, int code, const char *status, const char *content_type, const char *body);
+
+/* Route handler, implemented in tbar-web.c. `body` is NUL-terminated. */
+void tbar_web_handle_request(struct tbar_conn *c, const struct tbar_http_request *req, const char *body,
+			     int body_len);
+
+/* Called on the server thread after tbar_server_wake(); pushes pending state
+   to upgraded connections. Implemented in tbar-web.c. */
+void tbar_web_on_wake(struct tbar_conn *conns, int count);
+
+#ifdef __cplusplus
+}
+#endif
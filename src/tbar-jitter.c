@@ -0,0 +1,176 @@
+/*
+Plugin Name
+Copyright (C) <Year> <Developer> <Email Address>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include "tbar-jitter.h"
+
+#include <util/threading.h>
+
+#include <string.h>
+
+/* A sender silent this long starts a new clock mapping */
+#define SENDER_GAP_NS 1000000000ULL
+
+void tbar_jitter_reset(struct tbar_jitter *jb)
+{
+	memset(jb, 0, sizeof(*jb));
+}
+
+void tbar_jitter_push(struct tbar_jitter *jb, double pos, bool release, double sender_ms, uint64_t now_ns)
+{
+	struct tbar_jitter_sample s = {now_ns, pos, release};
+
+	if (sender_ms >= 0.0) {
+		/* The least delayed packet seen so far defines the mapping, so network
+		   jitter only ever shows up as extra buffering, never as reordering. */
+		double off = (double)now_ns / 1000000.0 - sender_ms;
+		bool restart = !jb->have_offset || sender_ms < jb->last_sender_ms ||
+			       now_ns - jb->last_arrival_ns > SENDER_GAP_NS;
+		if (restart || off < jb->offset_ms) {
+			jb->offset_ms = off;
+			jb->have_offset = true;
+		}
+		jb->last_sender_ms = sender_ms;
+		/* The mapping never places a sample after its arrival; anything outside
+		   [0, now] (or NaN) would not survive the conversion, so keep arrival time */
+		double t_ms = sender_ms + jb->offset_ms;
+		if (t_ms >= 0.0 && t_ms <= (double)now_ns / 1000000.0)
+			s.t_ns = (uint64_t)(t_ms * 1000000.0);
+	}
+	jb->last_arrival_ns = now_ns;
+
+	long head = os_atomic_load_long(&jb->head);
+	long tail = os_atomic_load_long(&jb->tail);
+	if ((unsigned long)head - (unsigned long)tail >= TBAR_JITTER_RING) {
+		os_atomic_inc_long(&jb->overflow);
+		return;
+	}
+
+	jb->ring[(unsigned long)head & (TBAR_JITTER_RING - 1)] = s;
+	/* Publishes the sample to the consumer */
+	os_atomic_set_long(&jb->head, (long)((unsigned long)head + 1));
+}
+
+static void history_drop(struct tbar_jitter *jb, int count)
+{
+	jb->hist_len -= count;
+	memmove(jb->hist, jb->hist + count, (size_t)jb->hist_len * sizeof(jb->hist[0]));
+}
+
+static void history_pull(struct tbar_jitter *jb)
+{
+	long tail = os_atomic_load_long(&jb->tail);
+	long head = os_atomic_load_long(&jb->head);
+
+	while (tail != head) {
+		struct tbar_jitter_sample s = jb->ring[(unsigned long)tail & (TBAR_JITTER_RING - 1)];
+		tail = (long)((unsigned long)tail + 1);
+
+		/* Keep playout times monotonic even if the sender clock stepped back */
+		if (jb->hist_len && s.t_ns < jb->hist[jb->hist_len - 1].t_ns)
+			s.t_ns = jb->hist[jb->hist_len - 1].t_ns;
+
+		if (jb->hist_len == TBAR_JITTER_HISTORY) {
+			/* More samples pending than the history holds: merge into the newest
+			   one so the queued path is thinned instead of losing its start */
+			struct tbar_jitter_sample *last = &jb->hist[jb->hist_len - 1];
+			s.release |= last->release;
+			*last = s;
+			continue;
+		}
+		jb->hist[jb->hist_len++] = s;
+	}
+
+	os_atomic_set_long(&jb->tail, tail);
+}
+
+/* Catmull-Rom on non-uniformly spaced samples (cubic Hermite with
+   finite-difference tangents), evaluated between p1 and p2. */
+static double catmull_rom(const struct tbar_jitter_sample *p0, const struct tbar_jitter_sample *p1,
+			  const struct tbar_jitter_sample *p2, const struct tbar_jitter_sample *p3, double u)
+{
+	double dt = (double)(p2->t_ns - p1->t_ns);
+	double m1 = p2->t_ns > p0->t_ns ? (p2->pos - p0->pos) / (double)(p2->t_ns - p0->t_ns) * dt : 0.0;
+	double m2 = p3->t_ns > p1->t_ns ? (p3->pos - p1->pos) / (double)(p3->t_ns - p1->t_ns) * dt : 0.0;
+
+	double u2 = u * u;
+	double u3 = u2 * u;
+	return (2.0 * u3 - 3.0 * u2 + 1.0) * p1->pos + (u3 - 2.0 * u2 + u) * m1 + (-2.0 * u3 + 3.0 * u2) * p2->pos +
+	       (u3 - u2) * m2;
+}
+
+bool tbar_jitter_read(struct tbar_jitter *jb, uint64_t now_ns, uint64_t delay_ns, enum tbar_interp mode, double *pos,
+		      bool *release)
+{
+	history_pull(jb);
+	if (!jb->hist_len)
+		return false;
+
+	uint64_t render = now_ns > delay_ns ? now_ns - delay_ns : 0;
+
+	/* A release plays out at its own position once reached; that ends the gesture */
+	for (int k = 0; k < jb->hist_len && jb->hist[k].t_ns <= render; k++) {
+		if (!jb->hist[k].release)
+			continue;
+		*pos = jb->hist[k].pos;
+		*release = true;
+		history_drop(jb, k + 1);
+		jb->last_out = *pos;
+		jb->have_out = true;
+		return true;
+	}
+
+	/* Segment [i, i+1] containing the render time */
+	int i = -1;
+	while (i + 1 < jb->hist_len && jb->hist[i + 1].t_ns <= render)
+		i++;
+	if (i < 0)
+		return false; /* still buffering the start of a gesture */
+
+	const struct tbar_jitter_sample *p1 = &jb->hist[i];
+	double v = p1->pos;
+	if (i + 1 < jb->hist_len && mode != TBAR_INTERP_OFF) {
+		const struct tbar_jitter_sample *p2 = &jb->hist[i + 1];
+		double u = (double)(render - p1->t_ns) / (double)(p2->t_ns - p1->t_ns);
+
+		if (mode == TBAR_INTERP_CATMULL_ROM) {
+			const struct tbar_jitter_sample *p0 = i > 0 ? &jb->hist[i - 1] : p1;
+			const struct tbar_jitter_sample *p3 = i + 2 < jb->hist_len ? &jb->hist[i + 2] : p2;
+			v = catmull_rom(p0, p1, p2, p3, u);
+		} else {
+			v = p1->pos + (p2->pos - p1->pos) * u;
+		}
+	}
+	/* Otherwise the buffer ran dry: hold the newest value */
+
+	/* Keep one sample before the segment for the Catmull-Rom tangent */
+	if (i > 1)
+		history_drop(jb, i - 1);
+
+	if (v < 0.0)
+		v = 0.0;
+	if (v > 1.0)
+		v = 1.0;
+	if (jb->have_out && v - jb->last_out < 1e-7 && jb->last_out - v < 1e-7)
+		return false;
+
+	*pos = v;
+	*release = false;
+	jb->last_out = v;
+	jb->have_out = true;
+	return true;
+}
@@ -0,0 +1,81 @@
+/*
+Plugin Name
+Copyright (C) <Year> <Developer> <Email Address>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Jitter buffer between the socket thread (single producer) and the video
+   tick (single consumer). Incoming positions are placed on the local clock,
+   played out `delay` behind real time and interpolated to one value per frame. */
+
+#define TBAR_JITTER_RING 128 /* power of two */
+#define TBAR_JITTER_HISTORY 32
+
+enum tbar_interp {
+	TBAR_INTERP_OFF,
+	TBAR_INTERP_LINEAR,
+	TBAR_INTERP_CATMULL_ROM,
+};
+
+struct tbar_jitter_sample {
+	uint64_t t_ns; /* playout time on the local clock, before the delay */
+	double pos;
+	bool release;
+};
+
+struct tbar_jitter {
+	/* Ring; head is written by the producer, tail by the consumer */
+	struct tbar_jitter_sample ring[TBAR_JITTER_RING];
+	volatile long head;
+	volatile long tail;
+	volatile long overflow; /* samples dropped because the ring was full */
+
+	/* Producer: sender clock -> local clock mapping */
+	bool have_offset;
+	double offset_ms; /* local ms - sender ms, smallest seen (least delayed packet) */
+	double last_sender_ms;
+	uint64_t last_arrival_ns;
+
+	/* Consumer */
+	struct tbar_jitter_sample hist[TBAR_JITTER_HISTORY];
+	int hist_len;
+	double last_out;
+	bool have_out;
+};
+
+void tbar_jitter_reset(struct tbar_jitter *jb);
+
+/* Producer side. `sender_ms` is the controller's timestamp in milliseconds (any
+   epoch) or a negative value when the update carries none; then the arrival
+   time is used. */
+void tbar_jitter_push(struct tbar_jitter *jb, double pos, bool release, double sender_ms, uint64_t now_ns);
+
+/* Consumer side, once per frame. Returns true and fills `pos`/`release` when
+   there is a new value to apply. */
+bool tbar_jitter_read(struct tbar_jitter *jb, uint64_t now_ns, uint64_t delay_ns, enum tbar_interp mode, double *pos,
+		      bool *release);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,613 @@
+/*
+Plugin Name
+Copyright (C) <Year> <Developer> <Email Address>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include "tbar-json.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/* Nesting limit for skipped values; keeps the recursion bounded */
+#define MAX_DEPTH 32
+/* Longer keys cannot be one of ours; they are still validated */
+#define MAX_KEY 16
+
+enum value_kind {
+	KIND_NUMBER,
+	KIND_BOOL,
+	KIND_STRING,
+	KIND_KEYFRAMES,
+};
+
+static const struct {
+	const char *name;
+	size_t len;
+	enum tbar_json_field field;
+	enum value_kind kind;
+} g_keys[] = {
+	{"position", 8, TBAR_JSON_POSITION, KIND_NUMBER},
+	{"release", 7, TBAR_JSON_RELEASE, KIND_BOOL},
+	{"timestamp", 9, TBAR_JSON_TIMESTAMP, KIND_NUMBER},
+	{"seq", 3, TBAR_JSON_SEQ, KIND_NUMBER},
+	{"enabled", 7, TBAR_JSON_ENABLED, KIND_BOOL},
+	{"port", 4, TBAR_JSON_PORT, KIND_NUMBER},
+	{"client_id", 9, TBAR_JSON_CLIENT_ID, KIND_STRING},
+	{"easing", 6, TBAR_JSON_EASING, KIND_STRING},
+	{"duration_ms", 11, TBAR_JSON_DURATION, KIND_NUMBER},
+	{"from", 4, TBAR_JSON_FROM, KIND_NUMBER},
+	{"to", 2, TBAR_JSON_TO, KIND_NUMBER},
+	{"abort", 5, TBAR_JSON_ABORT, KIND_BOOL},
+	{"keyframes", 9, TBAR_JSON_KEYFRAMES, KIND_KEYFRAMES},
+	{"scene", 5, TBAR_JSON_SCENE, KIND_STRING},
+	{"ping", 4, TBAR_JSON_PING, KIND_NUMBER},
+};
+
+#define NUM_KEYS (sizeof(g_keys) / sizeof(g_keys[0]))
+
+struct reader {
+	const char *p;
+	const char *end;
+};
+
+/* Caller's storage for "keyframes"; NULL when not wanted */
+struct keyframes_out {
+	struct tbar_json_keyframe *buf;
+	int max;
+};
+
+/* The scanning loops work on local copies of the cursor: stores through
+   `char` pointers may alias the reader, which otherwise forces a reload of
+   r->p on every byte. */
+static void skip_ws(struct reader *r)
+{
+	const char *p = r->p;
+	while (p < r->end && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r'))
+		p++;
+	r->p = p;
+}
+
+static int hex_value(char ch)
+{
+	if (ch >= '0' && ch <= '9')
+		return ch - '0';
+	if (ch >= 'a' && ch <= 'f')
+		return ch - 'a' + 10;
+	if (ch >= 'A' && ch <= 'F')
+		return ch - 'A' + 10;
+	return -1;
+}
+
+/* Appends decoded text; text that overflows `max` is marked unusable */
+static void key_append(char *key, size_t *n, size_t max, const char *src, size_t len)
+{
+	if (*n + len > max) {
+		*n = max + 1;
+		return;
+	}
+	memcpy(key + *n, src, len);
+	*n += len;
+}
+
+#define BYTES(b) (0x0101010101010101ULL * (uint64_t)(b))
+
+/* Nonzero if any of the eight bytes in `w` is '"', '\\' or below 0x20 */
+static inline uint64_t string_stop(uint64_t w)
+{
+	uint64_t q = w ^ BYTES('"');
+	uint64_t b = w ^ BYTES('\\');
+	uint64_t zero_q = (q - BYTES(1)) & ~q;
+	uint64_t zero_b = (b - BYTES(1)) & ~b;
+	uint64_t ctrl = (w - BYTES(0x20)) & ~w;
+	return (zero_q | zero_b | ctrl) & BYTES(0x80);
+}
+
+/* Scans a string starting after its opening quote. When `key` is given it is
+   pointed at the string's text: in place if there were no escapes, otherwise
+   decoded into `buf` (`max` bytes). A *key_len above `max` means the text did
+   not fit or is not plain ASCII, so it cannot be one of ours. */
+static bool scan_string(struct reader *r, char *buf, size_t max, const char **key, size_t *key_len)
+{
+	const char *start = r->p;
+	bool escaped = false;
+	size_t n = 0; /* decoded length in buf */
+
+	for (;;) {
+		/* Plain run up to the next quote, escape or control character */
+		const char *run = r->p;
+		const char *p = run;
+		const char *end = r->end;
+		while (end - p >= 8) {
+			uint64_t w;
+			memcpy(&w, p, sizeof(w));
+			if (string_stop(w))
+				break;
+			p += 8;
+		}
+		while (p < end) {
+			unsigned char ch = (unsigned char)*p;
+			if (ch == '"' || ch == '\\' || ch < 0x20)
+				break;
+			p++;
+		}
+		r->p = p;
+		if (key && escaped)
+			key_append(buf, &n, max, run, (size_t)(p - run));
+
+		if (r->p >= r->end || (unsigned char)*r->p < 0x20)
+			return false;
+		if (*r->p++ == '"')
+			break;
+
+		/* Escape sequence; from here on the key is decoded into buf */
+		if (key && !escaped)
+			key_append(buf, &n, max, start, (size_t)(p - start));
+		escaped = true;
+		if (r->p >= r->end)
+			return false;
+		char esc = *r->p++;
+		char ch;
+		switch (esc) {
+		case '"':
+		case '\\':
+		case '/':
+			ch = esc;
+			break;
+		case 'b':
+			ch = '\b';
+			break;
+		case 'f':
+			ch = '\f';
+			break;
+		case 'n':
+			ch = '\n';
+			break;
+		case 'r':
+			ch = '\r';
+			break;
+		case 't':
+			ch = '\t';
+			break;
+		case 'u': {
+			if (r->end - r->p < 4)
+				return false;
+			int cp = 0;
+			for (int i = 0; i < 4; i++) {
+				int h = hex_value(r->p[i]);
+				if (h < 0)
+					return false;
+				cp = cp << 4 | h;
+			}
+			r->p += 4;
+			/* Our keys are ASCII; anything else just has to be well-formed */
+			if (cp == 0 || cp >= 0x80) {
+				n = max + 1;
+				continue;
+			}
+			ch = (char)cp;
+			break;
+		}
+		default:
+			return false;
+		}
+		if (key)
+			key_append(buf, &n, max, &ch, 1);
+	}
+
+	if (key) {
+		*key = escaped ? buf : start;
+		*key_len = escaped ? n : (size_t)(r->p - 1 - start);
+	}
+	return true;
+}
+
+static const double g_pow10[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+				 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+/* Validates a JSON number and converts it. Short numbers (every position or
+   timestamp a controller sends) are converted exactly from the digits; others
+   go through strtod on a bounded copy. */
+static bool scan_number(struct reader *r, double *out)
+{
+	const char *start = r->p;
+	const char *p = r->p;
+	bool neg = false;
+	uint64_t mant = 0;
+	int digits = 0;
+	int scale = 0;
+
+	if (p < r->end && *p == '-') {
+		neg = true;
+		p++;
+	}
+	if (p >= r->end || *p < '0' || *p > '9')
+		return false;
+	if (*p == '0') {
+		p++;
+	} else {
+		while (p < r->end && *p >= '0' && *p <= '9') {
+			if (digits < 19)
+				mant = mant * 10 + (uint64_t)(*p - '0');
+			else
+				scale++;
+			digits++;
+			p++;
+		}
+	}
+
+	if (p < r->end && *p == '.') {
+		p++;
+		if (p >= r->end || *p < '0' || *p > '9')
+			return false;
+		while (p < r->end && *p >= '0' && *p <= '9') {
+			if (digits < 19) {
+				mant = mant * 10 + (uint64_t)(*p - '0');
+				scale--;
+			}
+			if (mant)
+				digits++;
+			p++;
+		}
+	}
+
+	int exp = 0;
+	if (p < r->end && (*p == 'e' || *p == 'E')) {
+		p++;
+		bool exp_neg = false;
+		if (p < r->end && (*p == '+' || *p == '-'))
+			exp_neg = *p++ == '-';
+		if (p >= r->end || *p < '0' || *p > '9')
+			return false;
+		while (p < r->end && *p >= '0' && *p <= '9') {
+			if (exp < 10000)
+				exp = exp * 10 + (*p - '0');
+			p++;
+		}
+		if (exp_neg)
+			exp = -exp;
+	}
+	r->p = p;
+
+	int e10 = scale + exp;
+	double v;
+	if (digits <= 15 && e10 >= -22 && e10 <= 22) {
+		v = (double)mant;
+		v = e10 < 0 ? v / g_pow10[-e10] : v * g_pow10[e10];
+	} else {
+		char tmp[64];
+		size_t n = (size_t)(p - start);
+		if (n >= sizeof(tmp))
+			return false;
+		memcpy(tmp, start, n);
+		tmp[n] = '\0';
+		v = strtod(tmp, NULL);
+		neg = false;
+	}
+
+	*out = neg ? -v : v;
+	return true;
+}
+
+static bool scan_literal(struct reader *r, const char *lit, size_t len)
+{
+	if ((size_t)(r->end - r->p) < len || memcmp(r->p, lit, len) != 0)
+		return false;
+	r->p += len;
+	return true;
+}
+
+static bool skip_value(struct reader *r, int depth);
+
+static bool skip_container(struct reader *r, int depth, char close)
+{
+	if (depth >= MAX_DEPTH)
+		return false;
+
+	skip_ws(r);
+	if (r->p < r->end && *r->p == close) {
+		r->p++;
+		return true;
+	}
+
+	for (;;) {
+		skip_ws(r);
+		if (close == '}') {
+			if (r->p >= r->end || *r->p != '"')
+				return false;
+			r->p++;
+			if (!scan_string(r, NULL, 0, NULL, NULL))
+				return false;
+			skip_ws(r);
+			if (r->p >= r->end || *r->p != ':')
+				return false;
+			r->p++;
+			skip_ws(r);
+		}
+		if (!skip_value(r, depth + 1))
+			return false;
+
+		skip_ws(r);
+		if (r->p >= r->end)
+			return false;
+		char ch = *r->p++;
+		if (ch == close)
+			return true;
+		if (ch != ',')
+			return false;
+	}
+}
+
+static bool skip_value(struct reader *r, int depth)
+{
+	if (r->p >= r->end)
+		return false;
+
+	double v;
+	switch (*r->p) {
+	case '"':
+		r->p++;
+		return scan_string(r, NULL, 0, NULL, NULL);
+	case '{':
+		r->p++;
+		return skip_container(r, depth, '}');
+	case '[':
+		r->p++;
+		return skip_container(r, depth, ']');
+	case 't':
+		return scan_literal(r, "true", 4);
+	case 'f':
+		return scan_literal(r, "false", 5);
+	case 'n':
+		return scan_literal(r, "null", 4);
+	default:
+		return scan_number(r, &v);
+	}
+}
+
+/* [[t, p], ...] into `kf`. Returns false only for invalid JSON; an array of
+   another shape sets *ok = false and is skipped. */
+static bool read_keyframes(struct reader *r, const struct keyframes_out *kf, int *count, bool *ok)
+{
+	const char *start = r->p;
+	int n = 0;
+
+	*ok = false;
+	r->p++;
+	skip_ws(r);
+	if (r->p < r->end && *r->p == ']') {
+		r->p++;
+		goto done;
+	}
+	for (;;) {
+		if (n == kf->max || r->p >= r->end || *r->p != '[')
+			goto other;
+		r->p++;
+		for (int i = 0; i < 2; i++) {
+			skip_ws(r);
+			char ch = r->p < r->end ? *r->p : '\0';
+			double v;
+			if ((ch != '-' && (ch < '0' || ch > '9')) || !scan_number(r, &v))
+				goto other;
+			if (i == 0)
+				kf->buf[n].time_ms = v;
+			else
+				kf->buf[n].position = v;
+			skip_ws(r);
+			if (r->p >= r->end || *r->p++ != (i == 0 ? ',' : ']'))
+				goto other;
+		}
+		n++;
+
+		skip_ws(r);
+		if (r->p >= r->end)
+			goto other;
+		char ch = *r->p++;
+		if (ch == ']')
+			break;
+		if (ch != ',')
+			goto other;
+		skip_ws(r);
+	}
+
+done:
+	*count = n;
+	*ok = true;
+	return true;
+
+other:
+	/* Not ours after all; it still has to be valid JSON */
+	r->p = start;
+	return skip_value(r, 1);
+}
+
+/* Reads the value of a known key into `f` if it has the expected type */
+static bool read_field(struct reader *r, size_t k, struct tbar_json_fields *f, const struct keyframes_out *kf)
+{
+	char ch = r->p < r->end ? *r->p : '\0';
+
+	if (g_keys[k].kind == KIND_KEYFRAMES) {
+		if (ch != '[' || !kf)
+			return skip_value(r, 1);
+		bool ok;
+		if (!read_keyframes(r, kf, &f->num_keyframes, &ok))
+			return false;
+		/* A rejected duplicate may have overwritten the caller's array */
+		if (ok)
+			f->present |= g_keys[k].field;
+		else
+			f->present &= ~(unsigned)g_keys[k].field;
+		return true;
+	}
+
+	if (g_keys[k].kind == KIND_STRING) {
+		if (ch != '"')
+			return skip_value(r, 1);
+		r->p++;
+
+		char *dst = f->easing;
+		size_t max = TBAR_JSON_MAX_EASING;
+		if (g_keys[k].field == TBAR_JSON_CLIENT_ID) {
+			dst = f->client_id;
+			max = TBAR_JSON_MAX_CLIENT_ID;
+		} else if (g_keys[k].field == TBAR_JSON_SCENE) {
+			dst = f->scene;
+			max = TBAR_JSON_MAX_SCENE;
+		}
+
+		char buf[TBAR_JSON_MAX_SCENE];
+		const char *text;
+		size_t text_len;
+		if (!scan_string(r, buf, max, &text, &text_len))
+			return false;
+		if (text_len > max)
+			return true;
+		memcpy(dst, text, text_len);
+		dst[text_len] = '\0';
+		f->present |= g_keys[k].field;
+		return true;
+	}
+
+	if (g_keys[k].kind == KIND_BOOL) {
+		bool b;
+		if (ch == 't' && scan_literal(r, "true", 4))
+			b = true;
+		else if (ch == 'f' && scan_literal(r, "false", 5))
+			b = false;
+		else
+			return skip_value(r, 1);
+
+		if (g_keys[k].field == TBAR_JSON_RELEASE)
+			f->release = b;
+		else if (g_keys[k].field == TBAR_JSON_ABORT)
+			f->abort = b;
+		else
+			f->enabled = b;
+		f->present |= g_keys[k].field;
+		return true;
+	}
+
+	if (ch != '-' && (ch < '0' || ch > '9'))
+		return skip_value(r, 1);
+
+	double v;
+	if (!scan_number(r, &v))
+		return false;
+
+	switch (g_keys[k].field) {
+	case TBAR_JSON_POSITION:
+		f->position = v;
+		break;
+	case TBAR_JSON_TIMESTAMP:
+		f->timestamp = v;
+		break;
+	case TBAR_JSON_DURATION:
+		f->duration_ms = v;
+		break;
+	case TBAR_JSON_FROM:
+		f->from = v;
+		break;
+	case TBAR_JSON_TO:
+		f->to = v;
+		break;
+	case TBAR_JSON_PING:
+		f->ping = v;
+		break;
+	case TBAR_JSON_SEQ:
+		if (v < 0.0 || v > 9007199254740992.0 || v != (double)(uint64_t)v)
+			return true;
+		f->seq = (uint64_t)v;
+		break;
+	case TBAR_JSON_PORT:
+		if (v < -2147483648.0 || v > 2147483647.0 || v != (double)(int)v)
+			return true;
+		f->port = (int)v;
+		break;
+	default:
+		return true;
+	}
+	f->present |= g_keys[k].field;
+	return true;
+}
+
+static bool extract(const char *json, size_t len, struct tbar_json_fields *out, const struct keyframes_out *kf)
+{
+	struct reader r = {json, json + len};
+	struct tbar_json_fields f;
+	memset(&f, 0, sizeof(f));
+
+	skip_ws(&r);
+	if (r.p >= r.end || *r.p != '{')
+		return false;
+	r.p++;
+	skip_ws(&r);
+
+	if (r.p < r.end && *r.p == '}') {
+		r.p++;
+	} else {
+		for (;;) {
+			skip_ws(&r);
+			if (r.p >= r.end || *r.p != '"')
+				return false;
+			r.p++;
+
+			char buf[MAX_KEY];
+			const char *key;
+			size_t key_len;
+			if (!scan_string(&r, buf, MAX_KEY, &key, &key_len))
+				return false;
+
+			skip_ws(&r);
+			if (r.p >= r.end || *r.p != ':')
+				return false;
+			r.p++;
+			skip_ws(&r);
+
+			size_t k = 0;
+			while (k < NUM_KEYS && (g_keys[k].len != key_len || memcmp(g_keys[k].name, key, key_len) != 0))
+				k++;
+			if (!(k < NUM_KEYS ? read_field(&r, k, &f, kf) : skip_value(&r, 1)))
+				return false;
+
+			skip_ws(&r);
+			if (r.p >= r.end)
+				return false;
+			char ch = *r.p++;
+			if (ch == '}')
+				break;
+			if (ch != ',')
+				return false;
+		}
+	}
+
+	skip_ws(&r);
+	if (r.p != r.end)
+		return false;
+
+	*out = f;
+	return true;
+}
+
+bool tbar_json_extract(const char *json, size_t len, struct tbar_json_fields *out)
+{
+	return extract(json, len, out, NULL);
+}
+
+bool tbar_json_extract_keyframes(const char *json, size_t len, struct tbar_json_fields *out,
+				 struct tbar_json_keyframe *keyframes, int max)
+{
+	struct keyframes_out kf = {keyframes, max};
+	return extract(json, len, out, &kf);
+}
@@ -0,0 +1,93 @@
+/*
+Plugin Name
+Copyright (C) <Year> <Developer> <Email Address>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Single-pass extractor for the small JSON objects the control endpoints
+   receive. The whole payload is validated in one scan without allocating;
+   only keys of the top-level object are matched, so a key name inside a
+   string value or a nested object is never mistaken for a field. */
+
+enum tbar_json_field {
+	TBAR_JSON_POSITION = 1 << 0,
+	TBAR_JSON_RELEASE = 1 << 1,
+	TBAR_JSON_TIMESTAMP = 1 << 2,
+	TBAR_JSON_SEQ = 1 << 3,
+	TBAR_JSON_ENABLED = 1 << 4,
+	TBAR_JSON_PORT = 1 << 5,
+	TBAR_JSON_CLIENT_ID = 1 << 6,
+	TBAR_JSON_EASING = 1 << 7,
+	TBAR_JSON_DURATION = 1 << 8,
+	TBAR_JSON_FROM = 1 << 9,
+	TBAR_JSON_TO = 1 << 10,
+	TBAR_JSON_ABORT = 1 << 11,
+	TBAR_JSON_KEYFRAMES = 1 << 12, /* only with tbar_json_extract_keyframes() */
+	TBAR_JSON_SCENE = 1 << 13,
+	TBAR_JSON_PING = 1 << 14,
+};
+
+/* Longer strings are treated as absent */
+#define TBAR_JSON_MAX_CLIENT_ID 63
+#define TBAR_JSON_MAX_EASING 15
+#define TBAR_JSON_MAX_SCENE 255
+
+/* One [time_ms, position] pair of a "keyframes" array */
+struct tbar_json_keyframe {
+	double time_ms;
+	double position;
+};
+
+struct tbar_json_fields {
+	unsigned present; /* tbar_json_field bits; a key with the wrong value type is not present */
+	double position;
+	bool release;
+	double timestamp; /* controller clock, milliseconds */
+	uint64_t seq;     /* non-negative integral value */
+	bool enabled;
+	int port; /* integral value, not range checked */
+	char client_id[TBAR_JSON_MAX_CLIENT_ID + 1]; /* decoded, NUL-terminated */
+	char easing[TBAR_JSON_MAX_EASING + 1];
+	double duration_ms;
+	double from;
+	double to;
+	bool abort;
+	int num_keyframes;
+	char scene[TBAR_JSON_MAX_SCENE + 1]; /* source name, decoded */
+	double ping; /* latency probe, echoed back unchanged */
+};
+
+/* Returns false if `json` is not a single valid JSON object. Later duplicate
+   keys override earlier ones. */
+bool tbar_json_extract(const char *json, size_t len, struct tbar_json_fields *out);
+
+/* Same, also reading "keyframes": an array of up to `max` [time_ms, position]
+   number pairs. An array of another shape or length leaves the field absent. */
+bool tbar_json_extract_keyframes(const char *json, size_t len, struct tbar_json_fields *out,
+				 struct tbar_json_keyframe *keyframes, int max);
+
+#ifdef __cplusplus
+}
+#endif
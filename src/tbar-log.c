@@ -0,0 +1,289 @@
+/*
+Plugin Name
+Copyright (C) <Year> <Developer> <Email Address>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include "tbar-log.h"
+
+#include <obs-module.h>
+#include <plugin-support.h>
+#include <util/platform.h>
+#include <util/threading.h>
+
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#define RING_SIZE 128 /* a power of two */
+#define MAX_SITES 64
+#define FLUSH_INTERVAL_MS 200
+
+struct record {
+	volatile long seq; /* index of the message in this slot; -1 while it is written */
+	int level;
+	uint64_t ns;
+	char message[TBAR_LOG_MESSAGE];
+};
+
+static struct {
+	struct record ring[RING_SIZE];
+	volatile long head; /* messages ever logged */
+
+	struct tbar_log_site *volatile sites[MAX_SITES];
+	volatile long num_sites;
+
+	/* Forwarding thread */
+	pthread_mutex_t mutex;
+	pthread_cond_t cond;
+	pthread_t thread;
+	bool running;
+	bool stop;
+	long tail; /* next message to forward; forwarding thread only */
+} g_log = {
+	.mutex = PTHREAD_MUTEX_INITIALIZER,
+	.cond = PTHREAD_COND_INITIALIZER,
+};
+
+static void register_site(struct tbar_log_site *site, const char *format)
+{
+	if (os_atomic_load_long(&site->registered) || !os_atomic_compare_swap_long(&site->registered, 0, 1))
+		return;
+	site->format = format;
+	long i = os_atomic_inc_long(&g_log.num_sites) - 1;
+	if (i < MAX_SITES)
+		g_log.sites[i] = site;
+}
+
+void tbar_log_printf(struct tbar_log_site *site, const char *format, ...)
+{
+	uint64_t now = os_gettime_ns();
+	register_site(site, format);
+
+	long second = (long)(now / 1000000000);
+	if (os_atomic_load_long(&site->window) != second) {
+		os_atomic_store_long(&site->window, second);
+		os_atomic_store_long(&site->in_window, 0);
+	}
+	if (os_atomic_inc_long(&site->in_window) > TBAR_LOG_BURST) {
+		os_atomic_inc_long(&site->suppressed);
+		os_atomic_inc_long(&site->unreported);
+		return;
+	}
+	os_atomic_inc_long(&site->emitted);
+
+	long seq = os_atomic_inc_long(&g_log.head) - 1;
+	struct record *r = &g_log.ring[seq & (RING_SIZE - 1)];
+	os_atomic_store_long(&r->seq, -1);
+	r->level = site->level;
+	r->ns = now;
+	va_list args;
+	va_start(args, format);
+	vsnprintf(r->message, sizeof(r->message), format, args);
+	va_end(args);
+	os_atomic_store_long(&r->seq, seq);
+}
+
+/* Copies message `seq` out of the ring; false if it is being written or was overwritten */
+static bool read_record(long seq, struct record *out)
+{
+	const struct record *r = &g_log.ring[seq & (RING_SIZE - 1)];
+	if (os_atomic_load_long(&r->seq) != seq)
+		return false;
+	out->level = r->level;
+	out->ns = r->ns;
+	memcpy(out->message, r->message, sizeof(out->message));
+	out->message[sizeof(out->message) - 1] = '\0';
+	return os_atomic_load_long(&r->seq) == seq;
+}
+
+/* ------------------------------ */
+/* Forwarding to the OBS log      */
+/* ------------------------------ */
+
+static void forward(bool final)
+{
+	long head = os_atomic_load_long(&g_log.head);
+	if (head - g_log.tail > RING_SIZE) {
+		obs_log(LOG_WARNING, "tbar-web: %ld log messages lost", head - RING_SIZE - g_log.tail);
+		g_log.tail = head - RING_SIZE;
+	}
+	for (; g_log.tail < head; g_log.tail++) {
+		struct record r;
+		if (read_record(g_log.tail, &r)) {
+			obs_log(r.level, "%s", r.message);
+		} else if (os_atomic_load_long(&g_log.ring[g_log.tail & (RING_SIZE - 1)].seq) == -1) {
+			break; /* still being written; next time */
+		}
+	}
+
+	/* A site stays quiet once its budget is spent, so summarize from here, once a second at most */
+	long second = (long)(os_gettime_ns() / 1000000000);
+	long num_sites = os_atomic_load_long(&g_log.num_sites);
+	for (long i = 0; i < num_sites && i < MAX_SITES; i++) {
+		struct tbar_log_site *site = g_log.sites[i];
+		if (!site || (site->summarized == second && !final))
+			continue;
+		site->summarized = second;
+		long n = os_atomic_set_long(&site->unreported, 0);
+		if (n)
+			obs_log(site->level, "tbar-web: suppressed %ld more of \"%s\"", n, site->format);
+	}
+}
+
+static void *log_thread(void *unused)
+{
+	(void)unused;
+	os_set_thread_name("tbar-web: log");
+
+	pthread_mutex_lock(&g_log.mutex);
+	while (!g_log.stop) {
+		struct timespec ts;
+		timespec_get(&ts, TIME_UTC);
+		long ns = ts.tv_nsec + FLUSH_INTERVAL_MS * 1000000L;
+		ts.tv_sec += ns / 1000000000;
+		ts.tv_nsec = ns % 1000000000;
+		pthread_cond_timedwait(&g_log.cond, &g_log.mutex, &ts);
+
+		pthread_mutex_unlock(&g_log.mutex);
+		forward(false);
+		pthread_mutex_lock(&g_log.mutex);
+	}
+	pthread_mutex_unlock(&g_log.mutex);
+	return NULL;
+}
+
+void tbar_log_start(void)
+{
+	if (g_log.running)
+		return;
+	g_log.stop = false;
+	if (pthread_create(&g_log.thread, NULL, log_thread, NULL) != 0) {
+		obs_log(LOG_ERROR, "tbar-web: failed to start the log thread (pthread_create)");
+		return;
+	}
+	g_log.running = true;
+}
+
+void tbar_log_stop(void)
+{
+	if (!g_log.running)
+		return;
+	pthread_mutex_lock(&g_log.mutex);
+	g_log.stop = true;
+	pthread_cond_signal(&g_log.cond);
+	pthread_mutex_unlock(&g_log.mutex);
+	pthread_join(g_log.thread, NULL);
+	g_log.running = false;
+	forward(true);
+}
+
+long tbar_log_suppressed_total(void)
+{
+	long total = 0;
+	long num_sites = os_atomic_load_long(&g_log.num_sites);
+	for (long i = 0; i < num_sites && i < MAX_SITES; i++) {
+		struct tbar_log_site *site = g_log.sites[i];
+		if (site)
+			total += os_atomic_load_long(&site->suppressed);
+	}
+	return total;
+}
+
+/* ------------------------------ */
+/* GET /log                       */
+/* ------------------------------ */
+
+static const char *level_name(int level)
+{
+	if (level <= LOG_ERROR)
+		return "error";
+	if (level <= LOG_WARNING)
+		return "warning";
+	if (level <= LOG_INFO)
+		return "info";
+	return "debug";
+}
+
+static bool append(char *buf, size_t size, size_t *len, const char *format, ...)
+{
+	va_list args;
+	va_start(args, format);
+	int n = vsnprintf(buf + *len, size - *len, format, args);
+	va_end(args);
+	if (n < 0 || (size_t)n >= size - *len)
+		return false;
+	*len += (size_t)n;
+	return true;
+}
+
+static bool append_string(char *buf, size_t size, size_t *len, const char *s)
+{
+	if (!append(buf, size, len, "\""))
+		return false;
+	for (; s && *s; s++) {
+		unsigned char ch = (unsigned char)*s;
+		bool ok;
+		if (ch < 0x20)
+			ok = append(buf, size, len, "\\u%04x", ch);
+		else if (ch == '"' || ch == '\\')
+			ok = append(buf, size, len, "\\%c", ch);
+		else
+			ok = append(buf, size, len, "%c", ch);
+		if (!ok)
+			return false;
+	}
+	return append(buf, size, len, "\"");
+}
+
+int tbar_log_format_json(char *buf, size_t size)
+{
+	uint64_t now = os_gettime_ns();
+	size_t len = 0;
+	bool ok = append(buf, size, &len, "{\"records\":[");
+
+	/* Oldest first */
+	long head = os_atomic_load_long(&g_log.head);
+	long first = head > RING_SIZE ? head - RING_SIZE : 0;
+	bool comma = false;
+	for (long seq = first; ok && seq < head; seq++) {
+		struct record r;
+		if (!read_record(seq, &r))
+			continue;
+		double age_ms = now > r.ns ? (double)(now - r.ns) / 1e6 : 0.0;
+		ok = append(buf, size, &len, "%s{\"seq\":%ld,\"age_ms\":%.1f,\"level\":\"%s\",\"message\":",
+			    comma ? "," : "", seq, age_ms, level_name(r.level)) &&
+		     append_string(buf, size, &len, r.message) && append(buf, size, &len, "}");
+		comma = true;
+	}
+
+	ok = ok && append(buf, size, &len, "],\"sites\":[");
+	long num_sites = os_atomic_load_long(&g_log.num_sites);
+	comma = false;
+	for (long i = 0; ok && i < num_sites && i < MAX_SITES; i++) {
+		struct tbar_log_site *site = g_log.sites[i];
+		if (!site)
+			continue;
+		ok = append(buf, size, &len, "%s{\"format\":", comma ? "," : "") &&
+		     append_string(buf, size, &len, site->format) &&
+		     append(buf, size, &len, ",\"emitted\":%ld,\"suppressed\":%ld}",
+			    os_atomic_load_long(&site->emitted), os_atomic_load_long(&site->suppressed));
+		comma = true;
+	}
+	ok = ok && append(buf, size, &len, "]}");
+	return ok ? (int)len : -1;
+}
@@ -0,0 +1,75 @@
+/*
+Plugin Name
+Copyright (C) <Year> <Developer> <Email Address>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Logging for paths that may run on every position update.
+
+   Each TBAR_LOG call site has its own budget: the first TBAR_LOG_BURST
+   messages in a second are kept, the rest only counted. Kept messages are
+   formatted into a fixed ring in memory (one atomic increment to claim a
+   slot, no lock, no I/O); a background thread passes them on to the OBS log
+   and reports how many were suppressed. GET /log shows the ring and the
+   per-site counters. */
+
+#define TBAR_LOG_BURST 5
+#define TBAR_LOG_MESSAGE 120
+
+struct tbar_log_site {
+	int level;
+	const char *format; /* set on first use */
+	volatile long registered;
+	volatile long window; /* second the budget below belongs to */
+	volatile long in_window;
+	volatile long emitted;
+	volatile long suppressed;
+	volatile long unreported; /* suppressed since the last summary */
+	long summarized; /* second of the last summary; forwarding thread only */
+};
+
+#define TBAR_LOG(log_level, ...)                                                     \
+	do {                                                                         \
+		static struct tbar_log_site tbar_log_site_ = {.level = (log_level)}; \
+		tbar_log_printf(&tbar_log_site_, __VA_ARGS__);                       \
+	} while (0)
+
+#ifdef __GNUC__
+__attribute__((format(printf, 2, 3)))
+#endif
+void tbar_log_printf(struct tbar_log_site *site, const char *format, ...);
+
+/* Starts and stops the thread that forwards to the OBS log. Messages logged
+   while it is stopped wait in the ring; stopping forwards what is there. */
+void tbar_log_start(void);
+void tbar_log_stop(void);
+
+/* {"records":[...],"sites":[...]} for GET /log; -1 if it did not fit */
+int tbar_log_format_json(char *buf, size_t size);
+
+long tbar_log_suppressed_total(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,183 @@
+/*
+Plugin Name
+Copyright (C) <Year> <Developer> <Email Address>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include "tbar-metrics.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+
+/* Upper bucket bounds; one more bucket catches everything above (+Inf) */
+static const uint64_t g_bounds_ns[] = {
+	5000,    10000,    25000,    50000,    100000,    250000,    500000,    1000000,
+	2500000, 5000000,  10000000, 25000000, 50000000,  100000000, 250000000,
+};
+#define NUM_BOUNDS (sizeof(g_bounds_ns) / sizeof(g_bounds_ns[0]))
+
+struct histogram {
+	volatile uint64_t buckets[NUM_BOUNDS + 1]; /* not cumulative; summed on output */
+	volatile uint64_t sum_ns;
+};
+
+/* Each shard has exactly one writer; the padding keeps neighbouring shards
+   off each other's cache lines. */
+struct shard {
+	struct histogram hist[TBAR_HIST_COUNT];
+	volatile uint64_t counters[TBAR_COUNTER_COUNT];
+	char pad[64];
+};
+
+static struct shard g_shards[TBAR_THREAD_COUNT];
+
+static const struct {
+	const char *name;
+	const char *help;
+} g_hist_info[TBAR_HIST_COUNT] = {
+	[TBAR_HIST_REQUEST_PARSE] = {"tbar_request_parse_seconds",
+				     "Time from a complete HTTP request in the buffer to route dispatch"},
+	[TBAR_HIST_APPLY_LATENCY] = {"tbar_apply_latency_seconds",
+				     "Time from receiving a position to applying it (includes the jitter delay)"},
+	[TBAR_HIST_UI_TASK] = {"tbar_ui_task_seconds", "Execution time of the position task on the OBS UI thread"},
+};
+
+void tbar_metrics_observe(enum tbar_metrics_thread thread, enum tbar_histogram hist, uint64_t ns)
+{
+	struct histogram *h = &g_shards[thread].hist[hist];
+
+	size_t b = 0;
+	while (b < NUM_BOUNDS && ns > g_bounds_ns[b])
+		b++;
+
+	h->buckets[b]++;
+	h->sum_ns += ns;
+}
+
+void tbar_metrics_add(enum tbar_metrics_thread thread, enum tbar_counter counter, uint64_t n)
+{
+	g_shards[thread].counters[counter] += n;
+}
+
+static bool append(char *buf, size_t size, size_t *len, const char *fmt, ...)
+{
+	if (*len >= size)
+		return false;
+
+	va_list args;
+	va_start(args, fmt);
+	int n = vsnprintf(buf + *len, size - *len, fmt, args);
+	va_end(args);
+
+	if (n < 0 || (size_t)n >= size - *len)
+		return false;
+	*len += (size_t)n;
+	return true;
+}
+
+static uint64_t sum_counter(enum tbar_counter counter)
+{
+	uint64_t v = 0;
+	for (int t = 0; t < TBAR_THREAD_COUNT; t++)
+		v += g_shards[t].counters[counter];
+	return v;
+}
+
+bool tbar_metrics_format_value(char *buf, size_t size, size_t *len, const char *name, const char *type,
+			       const char *help, uint64_t value)
+{
+	return append(buf, size, len, "# HELP %s %s\n# TYPE %s %s\n%s %llu\n", name, help, name, type, name,
+		      (unsigned long long)value);
+}
+
+static bool format_histogram(char *buf, size_t size, size_t *len, enum tbar_histogram hist)
+{
+	const char *name = g_hist_info[hist].name;
+	if (!append(buf, size, len, "# HELP %s %s\n# TYPE %s histogram\n", name, g_hist_info[hist].help, name))
+		return false;
+
+	uint64_t buckets[NUM_BOUNDS + 1] = {0};
+	uint64_t sum_ns = 0;
+	for (int t = 0; t < TBAR_THREAD_COUNT; t++) {
+		const struct histogram *h = &g_shards[t].hist[hist];
+		for (size_t b = 0; b <= NUM_BOUNDS; b++)
+			buckets[b] += h->buckets[b];
+		sum_ns += h->sum_ns;
+	}
+
+	uint64_t cumulative = 0;
+	for (size_t b = 0; b < NUM_BOUNDS; b++) {
+		cumulative += buckets[b];
+		if (!append(buf, size, len, "%s_bucket{le=\"%g\"} %llu\n", name, (double)g_bounds_ns[b] / 1e9,
+			    (unsigned long long)cumulative))
+			return false;
+	}
+	/* The count is the +Inf bucket, so the two always agree within one scrape */
+	uint64_t count = cumulative + buckets[NUM_BOUNDS];
+
+	return append(buf, size, len, "%s_bucket{le=\"+Inf\"} %llu\n%s_sum %.9f\n%s_count %llu\n", name,
+		      (unsigned long long)count, name, (double)sum_ns / 1e9, name, (unsigned long long)count);
+}
+
+bool tbar_metrics_format(char *buf, size_t size, size_t *len)
+{
+	for (int h = 0; h < TBAR_HIST_COUNT; h++) {
+		if (!format_histogram(buf, size, len, (enum tbar_histogram)h))
+			return false;
+	}
+
+	if (!tbar_metrics_format_value(buf, size, len, "tbar_http_requests_total", "counter",
+				       "HTTP requests handled", sum_counter(TBAR_COUNTER_HTTP_REQUESTS)) ||
+	    !tbar_metrics_format_value(buf, size, len, "tbar_http_timeouts_total", "counter",
+				       "Requests answered with 408 after missing a read deadline",
+				       sum_counter(TBAR_COUNTER_HTTP_TIMEOUTS)) ||
+	    !tbar_metrics_format_value(buf, size, len, "tbar_http_rejected_connections_total", "counter",
+				       "Connections turned away with 503 at the connection cap",
+				       sum_counter(TBAR_COUNTER_HTTP_REJECTED)) ||
+	    !tbar_metrics_format_value(buf, size, len, "tbar_sse_events_total", "counter",
+				       "Events published to /events subscribers", sum_counter(TBAR_COUNTER_SSE_EVENTS)) ||
+	    !tbar_metrics_format_value(buf, size, len, "tbar_sse_coalesced_total", "counter",
+				       "Queued /events frames replaced by a newer one for a slow subscriber",
+				       sum_counter(TBAR_COUNTER_SSE_COALESCED)) ||
+	    !tbar_metrics_format_value(buf, size, len, "tbar_sse_dropped_total", "counter",
+				       "/events frames skipped for a subscriber over its backlog",
+				       sum_counter(TBAR_COUNTER_SSE_DROPPED)) ||
+	    !tbar_metrics_format_value(buf, size, len, "tbar_received_bytes_total", "counter",
+				       "Bytes read from TCP and UDP sockets", sum_counter(TBAR_COUNTER_BYTES_IN)) ||
+	    !tbar_metrics_format_value(buf, size, len, "tbar_sent_bytes_total", "counter", "Bytes written to sockets",
+				       sum_counter(TBAR_COUNTER_BYTES_OUT)))
+		return false;
+
+	return append(buf, size, len,
+		      "# HELP tbar_manual_transitions_total Manual transition events\n"
+		      "# TYPE tbar_manual_transitions_total counter\n"
+		      "tbar_manual_transitions_total{event=\"start\"} %llu\n"
+		      "tbar_manual_transitions_total{event=\"finish\"} %llu\n"
+		      "tbar_manual_transitions_total{event=\"cancel\"} %llu\n"
+		      "tbar_manual_transitions_total{event=\"fixed_trigger\"} %llu\n",
+		      (unsigned long long)sum_counter(TBAR_COUNTER_MANUAL_START),
+		      (unsigned long long)sum_counter(TBAR_COUNTER_MANUAL_FINISH),
+		      (unsigned long long)sum_counter(TBAR_COUNTER_MANUAL_CANCEL),
+		      (unsigned long long)sum_counter(TBAR_COUNTER_FIXED_TRIGGER)) &&
+	       append(buf, size, len,
+		      "# HELP tbar_updates_dropped_total Position updates dropped by arbitration\n"
+		      "# TYPE tbar_updates_dropped_total counter\n"
+		      "tbar_updates_dropped_total{reason=\"stale_seq\"} %llu\n"
+		      "tbar_updates_dropped_total{reason=\"not_owner\"} %llu\n"
+		      "tbar_updates_dropped_total{reason=\"queued\"} %llu\n",
+		      (unsigned long long)sum_counter(TBAR_COUNTER_ARBITER_STALE),
+		      (unsigned long long)sum_counter(TBAR_COUNTER_ARBITER_NOT_OWNER),
+		      (unsigned long long)sum_counter(TBAR_COUNTER_ARBITER_QUEUED));
+}
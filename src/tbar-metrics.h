@@ -0,0 +1,82 @@
+/*
+Plugin Name
+Copyright (C) <Year> <Developer> <Email Address>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Counters and fixed-bucket latency histograms for GET /metrics.
+
+   Every thread that records writes only to its own shard, so recording is a
+   few plain stores on memory no other thread writes: no locks, no contended
+   cache lines. The collector sums the shards; a scrape racing a writer may
+   see a bucket and the sum one observation apart, which is harmless. */
+
+enum tbar_metrics_thread {
+	TBAR_THREAD_SERVER, /* socket thread: HTTP, WebSocket, UDP */
+	TBAR_THREAD_UI,     /* OBS UI task queue */
+	TBAR_THREAD_VIDEO,  /* OBS video tick */
+	TBAR_THREAD_COUNT,
+};
+
+enum tbar_histogram {
+	TBAR_HIST_REQUEST_PARSE,  /* request bytes complete -> dispatched to the route */
+	TBAR_HIST_APPLY_LATENCY,  /* position received -> applied to the transition */
+	TBAR_HIST_UI_TASK,        /* set_pos_task execution time */
+	TBAR_HIST_COUNT,
+};
+
+enum tbar_counter {
+	TBAR_COUNTER_HTTP_REQUESTS,
+	TBAR_COUNTER_HTTP_TIMEOUTS, /* 408: header or body deadline missed, or evicted */
+	TBAR_COUNTER_HTTP_REJECTED, /* 503: connection cap reached */
+	TBAR_COUNTER_SSE_EVENTS,    /* frames published to /events */
+	TBAR_COUNTER_SSE_COALESCED, /* replaced a queued frame for a slow subscriber */
+	TBAR_COUNTER_SSE_DROPPED,   /* skipped for a subscriber over its backlog */
+	TBAR_COUNTER_ARBITER_STALE,     /* update with an out-of-order seq */
+	TBAR_COUNTER_ARBITER_NOT_OWNER, /* update from a client without the lease */
+	TBAR_COUNTER_ARBITER_QUEUED,    /* same, client waiting for the lease */
+	TBAR_COUNTER_BYTES_IN,
+	TBAR_COUNTER_BYTES_OUT,
+	TBAR_COUNTER_MANUAL_START,
+	TBAR_COUNTER_MANUAL_FINISH,
+	TBAR_COUNTER_MANUAL_CANCEL,
+	TBAR_COUNTER_FIXED_TRIGGER,
+	TBAR_COUNTER_COUNT,
+};
+
+void tbar_metrics_observe(enum tbar_metrics_thread thread, enum tbar_histogram hist, uint64_t ns);
+void tbar_metrics_add(enum tbar_metrics_thread thread, enum tbar_counter counter, uint64_t n);
+
+/* Appends the Prometheus text exposition of everything above to buf[*len..size).
+   Returns false if it did not fit. */
+bool tbar_metrics_format(char *buf, size_t size, size_t *len);
+
+/* Appends one extra counter or gauge line (with HELP/TYPE) in the same format */
+bool tbar_metrics_format_value(char *buf, size_t size, size_t *len, const char *name, const char *type,
+			       const char *help, uint64_t value);
+
+#ifdef __cplusplus
+}
+#endif
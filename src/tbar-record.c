@@ -0,0 +1,189 @@
+/*
+Plugin Name
+Copyright (C) <Year> <Developer> <Email Address>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include "tbar-record.h"
+
+#include <obs-module.h>
+#include <plugin-support.h>
+#include <util/platform.h>
+#include <util/threading.h>
+
+#include <limits.h>
+#include <string.h>
+#include <time.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+/* Smallest ring, so a tiny limit still records something */
+#define MIN_RECORDS 1024
+
+/* Set up and torn down only while no thread records */
+static struct {
+	struct tbar_record_header *header; /* the mapping; NULL when not recording */
+	struct tbar_record *records;
+	unsigned long mask; /* capacity - 1 */
+	size_t map_size;
+	volatile long next; /* slots reserved so far; wraps in step with the mask */
+#ifdef _WIN32
+	HANDLE file;
+	HANDLE mapping;
+#endif
+} g_rec;
+
+static void *map_file(const char *path, size_t size)
+{
+#ifdef _WIN32
+	g_rec.file = CreateFileA(path, GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, NULL, CREATE_ALWAYS,
+				 FILE_ATTRIBUTE_NORMAL, NULL);
+	if (g_rec.file == INVALID_HANDLE_VALUE)
+		return NULL;
+	g_rec.mapping = CreateFileMappingA(g_rec.file, NULL, PAGE_READWRITE, (DWORD)((uint64_t)size >> 32),
+					   (DWORD)size, NULL);
+	void *map = g_rec.mapping ? MapViewOfFile(g_rec.mapping, FILE_MAP_WRITE, 0, 0, size) : NULL;
+	if (!map) {
+		if (g_rec.mapping)
+			CloseHandle(g_rec.mapping);
+		CloseHandle(g_rec.file);
+	}
+	return map;
+#else
+	int fd = open(path, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+	if (fd < 0)
+		return NULL;
+	void *map = NULL;
+	if (ftruncate(fd, (off_t)size) == 0) {
+		map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+		if (map == MAP_FAILED)
+			map = NULL;
+	}
+	/* The mapping keeps the file open */
+	close(fd);
+	return map;
+#endif
+}
+
+static void unmap_file(void *map, size_t size)
+{
+#ifdef _WIN32
+	(void)size;
+	FlushViewOfFile(map, 0);
+	UnmapViewOfFile(map);
+	CloseHandle(g_rec.mapping);
+	CloseHandle(g_rec.file);
+#else
+	munmap(map, size);
+#endif
+}
+
+bool tbar_record_open(const char *path, size_t max_bytes)
+{
+	tbar_record_close();
+
+	/* Largest power of two that fits */
+	size_t capacity = MIN_RECORDS;
+	while (capacity <= (size_t)LONG_MAX / 2 &&
+	       sizeof(struct tbar_record_header) + capacity * 2 * sizeof(struct tbar_record) <= max_bytes)
+		capacity *= 2;
+
+	size_t size = sizeof(struct tbar_record_header) + capacity * sizeof(struct tbar_record);
+	struct tbar_record_header *header = map_file(path, size);
+	if (!header) {
+		obs_log(LOG_WARNING, "tbar-web: cannot create recording %s", path);
+		return false;
+	}
+
+	/* A new file reads as zeros, so every slot starts out empty */
+	memcpy(header->magic, TBAR_RECORD_MAGIC, sizeof(header->magic));
+	header->version = TBAR_RECORD_VERSION;
+	header->record_size = sizeof(struct tbar_record);
+	header->capacity = capacity;
+	header->start_ns = os_gettime_ns();
+	header->start_unix_s = (int64_t)time(NULL);
+
+	g_rec.header = header;
+	g_rec.records = (struct tbar_record *)(header + 1);
+	g_rec.mask = (unsigned long)capacity - 1;
+	g_rec.map_size = size;
+	g_rec.next = 0;
+
+	obs_log(LOG_INFO, "tbar-web: recording to %s (%zu records)", path, capacity);
+	return true;
+}
+
+void tbar_record_close(void)
+{
+	if (!g_rec.header)
+		return;
+
+	unmap_file(g_rec.header, g_rec.map_size);
+	g_rec.header = NULL;
+	g_rec.records = NULL;
+}
+
+static void put(const struct tbar_record *rec)
+{
+	unsigned long slot = (unsigned long)os_atomic_inc_long(&g_rec.next) - 1;
+	g_rec.records[slot & g_rec.mask] = *rec;
+}
+
+static uint8_t record_flags(int channel, bool release)
+{
+	return (uint8_t)(channel << TBAR_RECORD_CHANNEL_SHIFT | (release ? TBAR_RECORD_RELEASE : 0));
+}
+
+void tbar_record_ingest(int channel, enum tbar_record_source source, uint64_t recv_ns, double pos, bool release,
+			double sender_ms)
+{
+	if (!g_rec.header)
+		return;
+
+	struct tbar_record rec = {
+		.recv_ns = recv_ns,
+		.position = (float)pos,
+		.kind = TBAR_RECORD_INGEST,
+		.source = (uint8_t)source,
+		.flags = record_flags(channel, release),
+		.sender_ms = sender_ms,
+	};
+	put(&rec);
+}
+
+void tbar_record_apply(int channel, enum tbar_record_source source, int thread, uint64_t recv_ns, uint64_t apply_ns,
+		       double pos, bool release)
+{
+	if (!g_rec.header)
+		return;
+
+	struct tbar_record rec = {
+		.recv_ns = recv_ns,
+		.apply_ns = apply_ns,
+		.position = (float)pos,
+		.kind = TBAR_RECORD_APPLY,
+		.source = (uint8_t)source,
+		.flags = record_flags(channel, release),
+		.thread = (uint8_t)thread,
+		.sender_ms = -1.0,
+	};
+	put(&rec);
+}
@@ -0,0 +1,93 @@
+/*
+Plugin Name
+Copyright (C) <Year> <Developer> <Email Address>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Optional session recorder: every ingested position and every application
+   to the transition is appended as one fixed-size record to a memory-mapped
+   file of bounded size. The file is a ring; once full, the oldest records are
+   overwritten. Writers on any thread reserve a slot with one atomic increment
+   and store into the mapping, so recording never blocks or makes a syscall.
+
+   Readers take every non-empty slot and order them by event time (receive
+   time for ingest records, apply time for apply records). */
+
+#define TBAR_RECORD_MAGIC "TBARREC1"
+#define TBAR_RECORD_VERSION 1
+
+enum tbar_record_kind {
+	TBAR_RECORD_EMPTY,
+	TBAR_RECORD_INGEST, /* accepted by a transport */
+	TBAR_RECORD_APPLY,  /* handed to the transition */
+};
+
+enum tbar_record_source {
+	TBAR_SOURCE_NONE,
+	TBAR_SOURCE_HTTP,
+	TBAR_SOURCE_WS,
+	TBAR_SOURCE_UDP,
+	TBAR_SOURCE_TRAJECTORY,
+};
+
+#define TBAR_RECORD_RELEASE 0x01
+/* Output channel in the high nibble of `flags` */
+#define TBAR_RECORD_CHANNEL_SHIFT 4
+
+struct tbar_record_header {
+	char magic[8];
+	uint32_t version;
+	uint32_t record_size;
+	uint64_t capacity;      /* records after the header, a power of two */
+	uint64_t start_ns;      /* os_gettime_ns() when recording started */
+	int64_t start_unix_s;   /* wall clock at about the same moment */
+	char reserved[24];
+};
+
+struct tbar_record {
+	uint64_t recv_ns;  /* receive time; for an apply, that of the newest update included */
+	uint64_t apply_ns; /* 0 for ingest records */
+	float position;
+	uint8_t kind;      /* tbar_record_kind */
+	uint8_t source;    /* tbar_record_source */
+	uint8_t flags;     /* TBAR_RECORD_RELEASE, channel << TBAR_RECORD_CHANNEL_SHIFT */
+	uint8_t thread;    /* tbar_metrics_thread that applied it */
+	double sender_ms;  /* controller timestamp, negative if none */
+};
+
+/* Creates (or truncates) `path` with room for at least `max_bytes` of records
+   and starts recording. Call with recording stopped. */
+bool tbar_record_open(const char *path, size_t max_bytes);
+/* Stops recording and unmaps the file. Call when no thread can record. */
+void tbar_record_close(void);
+
+void tbar_record_ingest(int channel, enum tbar_record_source source, uint64_t recv_ns, double pos, bool release,
+			double sender_ms);
+void tbar_record_apply(int channel, enum tbar_record_source source, int thread, uint64_t recv_ns, uint64_t apply_ns,
+		       double pos, bool release);
+
+#ifdef __cplusplus
+}
+#endif
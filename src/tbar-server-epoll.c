@@ -0,0 +1,525 @@
+/*
+Plugin Name
+Copyright (C) <Year> <Developer> <Email Address>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#define _GNU_SOURCE /* accept4 */
+
+#include "tbar-server.h"
+#include "tbar-http.h"
+#include "tbar-metrics.h"
+#include "tbar-udp.h"
+
+#include <obs-module.h>
+#include <plugin-support.h>
+#include <util/platform.h>
+#include <util/threading.h>
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+/* ---------------------------------------- */
+/* HTTP server backend (Linux, epoll)       */
+/* ---------------------------------------- */
+
+/* epoll user data for the non-connection fds; connections use their table index */
+#define EV_LISTEN UINT32_MAX
+#define EV_WAKE (UINT32_MAX - 1)
+#define EV_UDP (UINT32_MAX - 2)
+
+#define MAX_EVENTS 64
+/* How often read deadlines and idle keep-alive connections are checked */
+#define SWEEP_INTERVAL_MS 250
+
+static struct {
+	volatile bool stop;
+	pthread_t thread;
+	int listen_fd;
+	int epoll_fd;
+	int wake_fd; /* eventfd used by tbar_server_wake()/stop() to interrupt epoll_wait */
+	int udp_fd;  /* OSC / compact datagrams, -1 when disabled */
+	int port;
+	int udp_port;
+} g_loop = {
+	.listen_fd = -1,
+	.epoll_fd = -1,
+	.wake_fd = -1,
+	.udp_fd = -1,
+};
+
+static struct tbar_conn g_conns[TBAR_MAX_CONNS];
+static int g_conn_fds[TBAR_MAX_CONNS];
+static uint32_t g_conn_events[TBAR_MAX_CONNS]; /* currently registered epoll mask */
+/* One past the highest slot in use; per-wake and sweep loops stop there */
+static uint32_t g_conn_top;
+
+static bool epoll_add(int fd, uint32_t events, uint32_t id)
+{
+	struct epoll_event ev;
+	memset(&ev, 0, sizeof(ev));
+	ev.events = events;
+	ev.data.u32 = id;
+	return epoll_ctl(g_loop.epoll_fd, EPOLL_CTL_ADD, fd, &ev) == 0;
+}
+
+/* Re-arms the connection for reading and/or writing; skips the syscall when
+   nothing changed, which is the common case for keep-alive request/response. */
+static void conn_update_events(uint32_t id)
+{
+	const struct tbar_conn *c = &g_conns[id];
+	uint32_t events = 0;
+	/* EPOLLRDHUP is level-triggered: while we are not reading (closing, or
+	   output over the high-water mark) a half-closed peer would wake every
+	   wait, so then only writability matters */
+	if (tbar_conn_wants_input(c))
+		events |= EPOLLIN | EPOLLRDHUP;
+	if (tbar_conn_has_output(c))
+		events |= EPOLLOUT;
+
+	if (events == g_conn_events[id])
+		return;
+
+	struct epoll_event ev;
+	memset(&ev, 0, sizeof(ev));
+	ev.events = events;
+	ev.data.u32 = id;
+	epoll_ctl(g_loop.epoll_fd, EPOLL_CTL_MOD, g_conn_fds[id], &ev);
+	g_conn_events[id] = events;
+}
+
+static void conn_close(uint32_t id)
+{
+	int fd = g_conn_fds[id];
+	if (fd >= 0) {
+		epoll_ctl(g_loop.epoll_fd, EPOLL_CTL_DEL, fd, NULL);
+		close(fd);
+	}
+	g_conn_fds[id] = -1;
+	tbar_conn_free(&g_conns[id]);
+	while (g_conn_top && !g_conns[g_conn_top - 1].in_use)
+		g_conn_top--;
+}
+
+/* Best-effort canned response to a socket that has no (or no longer has a)
+   connection slot; never blocks the loop. */
+static void reject_fd(int fd, int code)
+{
+	size_t len;
+	const char *resp = tbar_http_reject_response(code, &len);
+	ssize_t n = send(fd, resp, len, MSG_NOSIGNAL | MSG_DONTWAIT);
+	(void)n;
+	close(fd);
+}
+
+/* At the connection cap, evicts the client that has made the least progress
+   (408) so stalled or trickling connections cannot lock healthy controllers
+   out. Returns false if every slot is busy with an active client. */
+static bool make_room(uint64_t now)
+{
+	int active = 0;
+	for (uint32_t id = 0; id < g_conn_top; id++)
+		active += g_conns[id].in_use;
+	if (active < tbar_http_max_conns())
+		return true;
+
+	int victim = tbar_conn_find_slow(g_conns, (int)g_conn_top, now);
+	if (victim < 0) {
+		tbar_metrics_add(TBAR_THREAD_SERVER, TBAR_COUNTER_HTTP_REJECTED, 1);
+		return false;
+	}
+
+	tbar_metrics_add(TBAR_THREAD_SERVER, TBAR_COUNTER_HTTP_TIMEOUTS, 1);
+	int fd = g_conn_fds[victim];
+	g_conn_fds[victim] = -1;
+	conn_close((uint32_t)victim);
+	epoll_ctl(g_loop.epoll_fd, EPOLL_CTL_DEL, fd, NULL);
+	reject_fd(fd, 408);
+	return true;
+}
+
+static void accept_clients(void)
+{
+	for (;;) {
+		int fd = accept4(g_loop.listen_fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+		if (fd < 0) {
+			if (errno == EINTR)
+				continue;
+			/* EAGAIN: backlog drained */
+			return;
+		}
+
+		if (!make_room(os_gettime_ns())) {
+			reject_fd(fd, 503);
+			continue;
+		}
+
+		uint32_t id = 0;
+		while (id < TBAR_MAX_CONNS && g_conns[id].in_use)
+			id++;
+
+		int one = 1;
+		setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+		if (!epoll_add(fd, EPOLLIN | EPOLLRDHUP, id)) {
+			close(fd);
+			continue;
+		}
+
+		tbar_conn_reset(&g_conns[id]);
+		g_conns[id].in_use = true;
+		g_conns[id].last_active_ns = os_gettime_ns();
+		g_conn_fds[id] = fd;
+		g_conn_events[id] = EPOLLIN | EPOLLRDHUP;
+		if (id >= g_conn_top)
+			g_conn_top = id + 1;
+	}
+}
+
+/* Returns false if the connection was closed */
+static bool conn_flush(uint32_t id)
+{
+	struct tbar_conn *c = &g_conns[id];
+
+	for (;;) {
+		while (tbar_conn_has_output(c)) {
+			/* Everything pending (headers, prebuilt bodies, pipelined responses)
+			   goes out in one vectored send */
+			struct tbar_iov out[TBAR_CONN_MAX_SEGS];
+			struct iovec iov[TBAR_CONN_MAX_SEGS];
+			int count = tbar_conn_output_iov(c, out, TBAR_CONN_MAX_SEGS);
+			for (int i = 0; i < count; i++) {
+				iov[i].iov_base = (void *)out[i].base;
+				iov[i].iov_len = out[i].len;
+			}
+			struct msghdr msg;
+			memset(&msg, 0, sizeof(msg));
+			msg.msg_iov = iov;
+			msg.msg_iovlen = (size_t)count;
+
+			ssize_t n = sendmsg(g_conn_fds[id], &msg, MSG_NOSIGNAL);
+			if (n < 0) {
+				if (errno == EINTR)
+					continue;
+				if (errno == EAGAIN || errno == EWOULDBLOCK) {
+					/* Socket buffer full; resume when writable */
+					conn_update_events(id);
+					return true;
+				}
+				conn_close(id);
+				return false;
+			}
+			tbar_conn_consume_output(c, (size_t)n);
+		}
+
+		/* Pipelined requests parked behind the high-water mark */
+		size_t pending = c->in_len;
+		if (!pending || c->closing)
+			break;
+		tbar_conn_on_input(c);
+		if (c->in_len == pending && !tbar_conn_has_output(c))
+			break;
+	}
+
+	if (c->closing) {
+		conn_close(id);
+		return false;
+	}
+
+	conn_update_events(id);
+	return true;
+}
+
+static void conn_readable(uint32_t id)
+{
+	struct tbar_conn *c = &g_conns[id];
+
+	while (tbar_conn_wants_input(c)) {
+		size_t space = tbar_conn_in_space(c);
+		if (space == 0)
+			break;
+
+		ssize_t n = recv(g_conn_fds[id], c->in + c->in_len, space, 0);
+		if (n < 0) {
+			if (errno == EINTR)
+				continue;
+			if (errno == EAGAIN || errno == EWOULDBLOCK)
+				break;
+			conn_close(id);
+			return;
+		}
+		if (n == 0) {
+			/* Peer closed; drop unless we still owe a response */
+			if (!tbar_conn_has_output(c)) {
+				conn_close(id);
+				return;
+			}
+			c->closing = true;
+			break;
+		}
+
+		c->in_len += (size_t)n;
+		c->last_active_ns = os_gettime_ns();
+		tbar_metrics_add(TBAR_THREAD_SERVER, TBAR_COUNTER_BYTES_IN, (uint64_t)n);
+		tbar_conn_on_input(c);
+	}
+
+	conn_flush(id);
+}
+
+static void sweep_idle(uint64_t now)
+{
+	for (uint32_t id = 0; id < g_conn_top; id++) {
+		if (!g_conns[id].in_use)
+			continue;
+		if (!tbar_conn_check_idle(&g_conns[id], now))
+			conn_close(id);
+		else if (tbar_conn_has_output(&g_conns[id]))
+			conn_flush(id);
+	}
+}
+
+static void udp_readable(void)
+{
+	uint8_t buf[TBAR_UDP_MAX_PACKET];
+
+	for (;;) {
+		struct sockaddr_in from;
+		socklen_t from_len = sizeof(from);
+		ssize_t n = recvfrom(g_loop.udp_fd, buf, sizeof(buf), 0, (struct sockaddr *)&from, &from_len);
+		if (n < 0) {
+			if (errno == EINTR)
+				continue;
+			/* EAGAIN: queue drained */
+			return;
+		}
+
+		tbar_metrics_add(TBAR_THREAD_SERVER, TBAR_COUNTER_BYTES_IN, (uint64_t)n);
+		uint64_t source = (uint64_t)ntohl(from.sin_addr.s_addr) << 16 | ntohs(from.sin_port);
+		tbar_udp_handle_packet(buf, (size_t)n, source, os_gettime_ns());
+	}
+}
+
+static void handle_wake(void)
+{
+	uint64_t v;
+	ssize_t r = read(g_loop.wake_fd, &v, sizeof(v));
+	(void)r;
+
+	tbar_web_on_wake(g_conns, (int)g_conn_top);
+
+	for (uint32_t id = 0; id < g_conn_top; id++) {
+		if (g_conns[id].in_use && tbar_conn_has_output(&g_conns[id]))
+			conn_flush(id);
+	}
+}
+
+static void *server_thread(void *unused)
+{
+	(void)unused;
+	os_set_thread_name("tbar-web: http");
+
+	obs_log(LOG_INFO, "tbar-web: listening on http://127.0.0.1:%d", g_loop.port);
+	if (g_loop.udp_fd >= 0)
+		obs_log(LOG_INFO, "tbar-web: OSC/UDP listening on 127.0.0.1:%d", g_loop.udp_port);
+
+	struct epoll_event events[MAX_EVENTS];
+	uint64_t last_sweep = os_gettime_ns();
+
+	while (!g_loop.stop) {
+		int n = epoll_wait(g_loop.epoll_fd, events, MAX_EVENTS, SWEEP_INTERVAL_MS);
+		if (n < 0) {
+			if (errno == EINTR)
+				continue;
+			obs_log(LOG_ERROR, "tbar-web: epoll_wait() failed (%d)", errno);
+			break;
+		}
+
+		for (int i = 0; i < n; i++) {
+			uint32_t id = events[i].data.u32;
+			uint32_t ev = events[i].events;
+
+			if (id == EV_WAKE) {
+				handle_wake();
+				continue;
+			}
+
+			if (id == EV_LISTEN) {
+				accept_clients();
+				continue;
+			}
+
+			if (id == EV_UDP) {
+				udp_readable();
+				continue;
+			}
+
+			if (id >= TBAR_MAX_CONNS || !g_conns[id].in_use)
+				continue;
+
+			if (ev & (EPOLLERR | EPOLLHUP)) {
+				conn_close(id);
+				continue;
+			}
+			/* Half-closed while we are not reading: nothing more can be answered in order */
+			if ((ev & EPOLLRDHUP) && !tbar_conn_wants_input(&g_conns[id]))
+				g_conns[id].closing = true;
+			if (ev & (EPOLLIN | EPOLLRDHUP)) {
+				conn_readable(id);
+				continue;
+			}
+			if (ev & EPOLLOUT)
+				conn_flush(id);
+		}
+
+		uint64_t now = os_gettime_ns();
+		if (now - last_sweep >= (uint64_t)SWEEP_INTERVAL_MS * 1000000) {
+			last_sweep = now;
+			sweep_idle(now);
+		}
+	}
+
+	for (uint32_t id = 0; id < g_conn_top; id++) {
+		if (g_conns[id].in_use)
+			conn_close(id);
+	}
+
+	obs_log(LOG_INFO, "tbar-web: stopped");
+	return NULL;
+}
+
+static void close_fds(void)
+{
+	if (g_loop.listen_fd >= 0)
+		close(g_loop.listen_fd);
+	if (g_loop.wake_fd >= 0)
+		close(g_loop.wake_fd);
+	if (g_loop.udp_fd >= 0)
+		close(g_loop.udp_fd);
+	if (g_loop.epoll_fd >= 0)
+		close(g_loop.epoll_fd);
+	g_loop.listen_fd = -1;
+	g_loop.udp_fd = -1;
+	g_loop.wake_fd = -1;
+	g_loop.epoll_fd = -1;
+}
+
+static bool open_udp(int port)
+{
+	g_loop.udp_fd = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, IPPROTO_UDP);
+	if (g_loop.udp_fd < 0) {
+		obs_log(LOG_ERROR, "tbar-web: UDP socket() failed");
+		return false;
+	}
+
+	struct sockaddr_in addr;
+	memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	addr.sin_port = htons((uint16_t)port);
+	inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+
+	if (bind(g_loop.udp_fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+		obs_log(LOG_ERROR, "tbar-web: UDP bind(127.0.0.1:%d) failed", port);
+		return false;
+	}
+
+	return epoll_add(g_loop.udp_fd, EPOLLIN, EV_UDP);
+}
+
+bool tbar_server_start(int port, int udp_port)
+{
+	g_loop.port = port;
+	g_loop.udp_port = udp_port;
+	g_loop.stop = false;
+
+	for (int i = 0; i < TBAR_MAX_CONNS; i++)
+		g_conn_fds[i] = -1;
+
+	g_loop.listen_fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, IPPROTO_TCP);
+	if (g_loop.listen_fd < 0) {
+		obs_log(LOG_ERROR, "tbar-web: socket() failed");
+		return false;
+	}
+
+	int opt = 1;
+	setsockopt(g_loop.listen_fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+
+	struct sockaddr_in addr;
+	memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	addr.sin_port = htons((uint16_t)port);
+	inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+
+	if (bind(g_loop.listen_fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+		obs_log(LOG_ERROR, "tbar-web: bind(127.0.0.1:%d) failed", port);
+		close_fds();
+		return false;
+	}
+
+	if (listen(g_loop.listen_fd, SOMAXCONN) != 0) {
+		obs_log(LOG_ERROR, "tbar-web: listen() failed");
+		close_fds();
+		return false;
+	}
+
+	g_loop.epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+	g_loop.wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if (g_loop.epoll_fd < 0 || g_loop.wake_fd < 0 || !epoll_add(g_loop.listen_fd, EPOLLIN, EV_LISTEN) ||
+	    !epoll_add(g_loop.wake_fd, EPOLLIN, EV_WAKE)) {
+		obs_log(LOG_ERROR, "tbar-web: epoll setup failed");
+		close_fds();
+		return false;
+	}
+
+	if (udp_port > 0 && !open_udp(udp_port)) {
+		close_fds();
+		return false;
+	}
+
+	if (pthread_create(&g_loop.thread, NULL, server_thread, NULL) != 0) {
+		obs_log(LOG_ERROR, "tbar-web: failed to start thread (pthread_create)");
+		close_fds();
+		return false;
+	}
+
+	return true;
+}
+
+void tbar_server_wake(void)
+{
+	uint64_t one = 1;
+	ssize_t r = write(g_loop.wake_fd, &one, sizeof(one));
+	(void)r;
+}
+
+void tbar_server_stop(void)
+{
+	g_loop.stop = true;
+
+	/* Force epoll_wait() to wake up */
+	tbar_server_wake();
+
+	pthread_join(g_loop.thread, NULL);
+	close_fds();
+}
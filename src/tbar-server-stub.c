@@ -0,0 +1,36 @@
+/*
+Plugin Name
+Copyright (C) <Year> <Developer> <Email Address>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include "tbar-server.h"
+
+#include <obs-module.h>
+#include <plugin-support.h>
+
+/* Platforms without a server backend yet (macOS) */
+
+bool tbar_server_start(int port, int udp_port)
+{
+	(void)port;
+	(void)udp_port;
+	obs_log(LOG_WARNING, "tbar-web: HTTP server not implemented on this platform yet");
+	return false;
+}
+
+void tbar_server_stop(void) {}
+
+void tbar_server_wake(void) {}
@@ -0,0 +1,485 @@
+/*
+Plugin Name
+Copyright (C) <Year> <Developer> <Email Address>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include "tbar-server.h"
+#include "tbar-http.h"
+#include "tbar-metrics.h"
+#include "tbar-udp.h"
+
+#include <obs-module.h>
+#include <plugin-support.h>
+#include <util/platform.h>
+
+/* select() over the whole connection table plus the listen, wake and UDP sockets */
+#define FD_SETSIZE (TBAR_MAX_CONNS + 3)
+#define WIN32_LEAN_AND_MEAN
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#include <windows.h>
+#include <process.h>
+#pragma comment(lib, "Ws2_32.lib")
+
+#include <stdint.h>
+#include <string.h>
+
+/* ------------------------------ */
+/* HTTP server backend (Windows)  */
+/* ------------------------------ */
+
+/* How often read deadlines and idle keep-alive connections are checked */
+#define SWEEP_INTERVAL_MS 250
+
+static struct {
+	volatile bool stop;
+	HANDLE thread;
+	SOCKET listen_sock;
+	SOCKET wake_sock; /* loopback UDP socket; a datagram interrupts select() */
+	struct sockaddr_in wake_addr;
+	SOCKET udp_sock; /* OSC / compact datagrams, INVALID_SOCKET when disabled */
+	int port;
+	int udp_port;
+} g_loop = {0};
+
+static struct tbar_conn g_conns[TBAR_MAX_CONNS];
+static SOCKET g_conn_socks[TBAR_MAX_CONNS];
+/* One past the highest slot in use; per-wake, select and sweep loops stop there */
+static int g_conn_top;
+
+static void set_nonblocking(SOCKET s)
+{
+	u_long mode = 1;
+	ioctlsocket(s, FIONBIO, &mode);
+}
+
+static void conn_close(int id)
+{
+	if (g_conn_socks[id] != INVALID_SOCKET)
+		closesocket(g_conn_socks[id]);
+	g_conn_socks[id] = INVALID_SOCKET;
+	tbar_conn_free(&g_conns[id]);
+	while (g_conn_top && !g_conns[g_conn_top - 1].in_use)
+		g_conn_top--;
+}
+
+/* Best-effort canned response to a socket that has no (or no longer has a)
+   connection slot; the socket is non-blocking, so this never stalls the loop. */
+static void reject_sock(SOCKET s, int code)
+{
+	size_t len;
+	const char *resp = tbar_http_reject_response(code, &len);
+	send(s, resp, (int)len, 0);
+	closesocket(s);
+}
+
+/* At the connection cap, evicts the client that has made the least progress
+   (408) so stalled or trickling connections cannot lock healthy controllers
+   out. Returns false if every slot is busy with an active client. */
+static bool make_room(uint64_t now)
+{
+	int active = 0;
+	for (int id = 0; id < g_conn_top; id++)
+		active += g_conns[id].in_use;
+	if (active < tbar_http_max_conns())
+		return true;
+
+	int victim = tbar_conn_find_slow(g_conns, g_conn_top, now);
+	if (victim < 0) {
+		tbar_metrics_add(TBAR_THREAD_SERVER, TBAR_COUNTER_HTTP_REJECTED, 1);
+		return false;
+	}
+
+	tbar_metrics_add(TBAR_THREAD_SERVER, TBAR_COUNTER_HTTP_TIMEOUTS, 1);
+	SOCKET s = g_conn_socks[victim];
+	g_conn_socks[victim] = INVALID_SOCKET;
+	conn_close(victim);
+	reject_sock(s, 408);
+	return true;
+}
+
+static void accept_clients(void)
+{
+	for (;;) {
+		SOCKET s = accept(g_loop.listen_sock, NULL, NULL);
+		if (s == INVALID_SOCKET)
+			return;
+
+		set_nonblocking(s);
+		if (!make_room(os_gettime_ns())) {
+			reject_sock(s, 503);
+			continue;
+		}
+
+		int id = 0;
+		while (id < TBAR_MAX_CONNS && g_conns[id].in_use)
+			id++;
+
+		BOOL one = TRUE;
+		setsockopt(s, IPPROTO_TCP, TCP_NODELAY, (const char *)&one, sizeof(one));
+
+		tbar_conn_reset(&g_conns[id]);
+		g_conns[id].in_use = true;
+		g_conns[id].last_active_ns = os_gettime_ns();
+		g_conn_socks[id] = s;
+		if (id >= g_conn_top)
+			g_conn_top = id + 1;
+	}
+}
+
+/* Returns false if the connection was closed */
+static bool conn_flush(int id)
+{
+	struct tbar_conn *c = &g_conns[id];
+
+	for (;;) {
+		while (tbar_conn_has_output(c)) {
+			/* Everything pending goes out in one vectored send */
+			struct tbar_iov out[TBAR_CONN_MAX_SEGS];
+			WSABUF bufs[TBAR_CONN_MAX_SEGS];
+			int count = tbar_conn_output_iov(c, out, TBAR_CONN_MAX_SEGS);
+			for (int i = 0; i < count; i++) {
+				bufs[i].buf = (char *)out[i].base;
+				bufs[i].len = (u_long)out[i].len;
+			}
+
+			DWORD sent = 0;
+			if (WSASend(g_conn_socks[id], bufs, (DWORD)count, &sent, 0, NULL, NULL) == SOCKET_ERROR) {
+				if (WSAGetLastError() == WSAEWOULDBLOCK)
+					return true; /* resume when writable */
+				conn_close(id);
+				return false;
+			}
+			tbar_conn_consume_output(c, (size_t)sent);
+		}
+
+		/* Pipelined requests parked behind the high-water mark */
+		size_t pending = c->in_len;
+		if (!pending || c->closing)
+			break;
+		tbar_conn_on_input(c);
+		if (c->in_len == pending && !tbar_conn_has_output(c))
+			break;
+	}
+
+	if (c->closing) {
+		conn_close(id);
+		return false;
+	}
+	return true;
+}
+
+static void conn_readable(int id)
+{
+	struct tbar_conn *c = &g_conns[id];
+
+	while (tbar_conn_wants_input(c)) {
+		size_t space = tbar_conn_in_space(c);
+		if (space == 0)
+			break;
+
+		int n = recv(g_conn_socks[id], c->in + c->in_len, (int)space, 0);
+		if (n == SOCKET_ERROR) {
+			if (WSAGetLastError() == WSAEWOULDBLOCK)
+				break;
+			conn_close(id);
+			return;
+		}
+		if (n == 0) {
+			/* Peer closed; drop unless we still owe a response */
+			if (!tbar_conn_has_output(c)) {
+				conn_close(id);
+				return;
+			}
+			c->closing = true;
+			break;
+		}
+
+		c->in_len += (size_t)n;
+		c->last_active_ns = os_gettime_ns();
+		tbar_metrics_add(TBAR_THREAD_SERVER, TBAR_COUNTER_BYTES_IN, (uint64_t)n);
+		tbar_conn_on_input(c);
+	}
+
+	conn_flush(id);
+}
+
+static void sweep_idle(uint64_t now)
+{
+	for (int id = 0; id < g_conn_top; id++) {
+		if (!g_conns[id].in_use)
+			continue;
+		if (!tbar_conn_check_idle(&g_conns[id], now))
+			conn_close(id);
+		else if (tbar_conn_has_output(&g_conns[id]))
+			conn_flush(id);
+	}
+}
+
+static void udp_readable(void)
+{
+	char buf[TBAR_UDP_MAX_PACKET];
+
+	for (;;) {
+		struct sockaddr_in from;
+		int from_len = (int)sizeof(from);
+		int n = recvfrom(g_loop.udp_sock, buf, (int)sizeof(buf), 0, (struct sockaddr *)&from, &from_len);
+		if (n == SOCKET_ERROR) {
+			/* WSAECONNRESET is reported for ICMP port-unreachable; skip it and keep draining */
+			if (WSAGetLastError() == WSAECONNRESET)
+				continue;
+			return;
+		}
+
+		tbar_metrics_add(TBAR_THREAD_SERVER, TBAR_COUNTER_BYTES_IN, (uint64_t)n);
+		uint64_t source = (uint64_t)ntohl(from.sin_addr.s_addr) << 16 | ntohs(from.sin_port);
+		tbar_udp_handle_packet((const uint8_t *)buf, (size_t)n, source, os_gettime_ns());
+	}
+}
+
+static void handle_wake(void)
+{
+	char drain[16];
+	while (recv(g_loop.wake_sock, drain, (int)sizeof(drain), 0) > 0)
+		;
+
+	tbar_web_on_wake(g_conns, g_conn_top);
+
+	for (int id = 0; id < g_conn_top; id++) {
+		if (g_conns[id].in_use && tbar_conn_has_output(&g_conns[id]))
+			conn_flush(id);
+	}
+}
+
+static unsigned __stdcall server_thread(void *unused)
+{
+	(void)unused;
+
+	obs_log(LOG_INFO, "tbar-web: listening on http://127.0.0.1:%d", g_loop.port);
+	if (g_loop.udp_sock != INVALID_SOCKET)
+		obs_log(LOG_INFO, "tbar-web: OSC/UDP listening on 127.0.0.1:%d", g_loop.udp_port);
+
+	uint64_t last_sweep = os_gettime_ns();
+
+	while (!g_loop.stop) {
+		fd_set rd, wr;
+		FD_ZERO(&rd);
+		FD_ZERO(&wr);
+		FD_SET(g_loop.listen_sock, &rd);
+		FD_SET(g_loop.wake_sock, &rd);
+		if (g_loop.udp_sock != INVALID_SOCKET)
+			FD_SET(g_loop.udp_sock, &rd);
+		for (int id = 0; id < g_conn_top; id++) {
+			if (!g_conns[id].in_use)
+				continue;
+			if (tbar_conn_wants_input(&g_conns[id]))
+				FD_SET(g_conn_socks[id], &rd);
+			if (tbar_conn_has_output(&g_conns[id]))
+				FD_SET(g_conn_socks[id], &wr);
+		}
+
+		struct timeval tv = {SWEEP_INTERVAL_MS / 1000, (SWEEP_INTERVAL_MS % 1000) * 1000};
+		int n = select(0, &rd, &wr, NULL, &tv);
+		if (n == SOCKET_ERROR) {
+			obs_log(LOG_ERROR, "tbar-web: select() failed (%d)", WSAGetLastError());
+			break;
+		}
+
+		if (FD_ISSET(g_loop.wake_sock, &rd))
+			handle_wake();
+
+		if (g_loop.udp_sock != INVALID_SOCKET && FD_ISSET(g_loop.udp_sock, &rd))
+			udp_readable();
+
+		for (int id = 0; n > 0 && id < g_conn_top; id++) {
+			if (!g_conns[id].in_use)
+				continue;
+			SOCKET s = g_conn_socks[id];
+			if (FD_ISSET(s, &rd))
+				conn_readable(id);
+			else if (FD_ISSET(s, &wr))
+				conn_flush(id);
+		}
+
+		if (FD_ISSET(g_loop.listen_sock, &rd))
+			accept_clients();
+
+		uint64_t now = os_gettime_ns();
+		if (now - last_sweep >= (uint64_t)SWEEP_INTERVAL_MS * 1000000) {
+			last_sweep = now;
+			sweep_idle(now);
+		}
+	}
+
+	for (int id = 0; id < g_conn_top; id++) {
+		if (g_conns[id].in_use)
+			conn_close(id);
+	}
+
+	obs_log(LOG_INFO, "tbar-web: stopped");
+	return 0;
+}
+
+static void close_sockets(void)
+{
+	if (g_loop.listen_sock != INVALID_SOCKET)
+		closesocket(g_loop.listen_sock);
+	if (g_loop.wake_sock != INVALID_SOCKET)
+		closesocket(g_loop.wake_sock);
+	if (g_loop.udp_sock != INVALID_SOCKET)
+		closesocket(g_loop.udp_sock);
+	g_loop.listen_sock = INVALID_SOCKET;
+	g_loop.wake_sock = INVALID_SOCKET;
+	g_loop.udp_sock = INVALID_SOCKET;
+}
+
+static bool open_wake_socket(void)
+{
+	g_loop.wake_sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+	if (g_loop.wake_sock == INVALID_SOCKET)
+		return false;
+
+	memset(&g_loop.wake_addr, 0, sizeof(g_loop.wake_addr));
+	g_loop.wake_addr.sin_family = AF_INET;
+	inet_pton(AF_INET, "127.0.0.1", &g_loop.wake_addr.sin_addr);
+	if (bind(g_loop.wake_sock, (struct sockaddr *)&g_loop.wake_addr, (int)sizeof(g_loop.wake_addr)) != 0)
+		return false;
+
+	int len = (int)sizeof(g_loop.wake_addr);
+	if (getsockname(g_loop.wake_sock, (struct sockaddr *)&g_loop.wake_addr, &len) != 0)
+		return false;
+
+	set_nonblocking(g_loop.wake_sock);
+	return true;
+}
+
+static bool open_udp_socket(int port)
+{
+	g_loop.udp_sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+	if (g_loop.udp_sock == INVALID_SOCKET) {
+		obs_log(LOG_ERROR, "tbar-web: UDP socket() failed");
+		return false;
+	}
+
+	struct sockaddr_in addr;
+	memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	addr.sin_port = htons((u_short)port);
+	inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+
+	if (bind(g_loop.udp_sock, (struct sockaddr *)&addr, (int)sizeof(addr)) != 0) {
+		obs_log(LOG_ERROR, "tbar-web: UDP bind(127.0.0.1:%d) failed", port);
+		return false;
+	}
+
+	set_nonblocking(g_loop.udp_sock);
+	return true;
+}
+
+bool tbar_server_start(int port, int udp_port)
+{
+	g_loop.port = port;
+	g_loop.udp_port = udp_port;
+	g_loop.stop = false;
+	g_loop.listen_sock = INVALID_SOCKET;
+	g_loop.wake_sock = INVALID_SOCKET;
+	g_loop.udp_sock = INVALID_SOCKET;
+
+	for (int i = 0; i < TBAR_MAX_CONNS; i++)
+		g_conn_socks[i] = INVALID_SOCKET;
+
+	WSADATA wsa;
+	if (WSAStartup(MAKEWORD(2, 2), &wsa) != 0) {
+		obs_log(LOG_ERROR, "tbar-web: WSAStartup failed");
+		return false;
+	}
+
+	g_loop.listen_sock = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+	if (g_loop.listen_sock == INVALID_SOCKET) {
+		obs_log(LOG_ERROR, "tbar-web: socket() failed");
+		WSACleanup();
+		return false;
+	}
+
+	BOOL opt = TRUE;
+	setsockopt(g_loop.listen_sock, SOL_SOCKET, SO_REUSEADDR, (const char *)&opt, sizeof(opt));
+
+	struct sockaddr_in addr;
+	memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	addr.sin_port = htons((u_short)port);
+	inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+
+	if (bind(g_loop.listen_sock, (struct sockaddr *)&addr, (int)sizeof(addr)) != 0) {
+		obs_log(LOG_ERROR, "tbar-web: bind(127.0.0.1:%d) failed", port);
+		close_sockets();
+		WSACleanup();
+		return false;
+	}
+
+	if (listen(g_loop.listen_sock, SOMAXCONN) != 0) {
+		obs_log(LOG_ERROR, "tbar-web: listen() failed");
+		close_sockets();
+		WSACleanup();
+		return false;
+	}
+	set_nonblocking(g_loop.listen_sock);
+
+	if (!open_wake_socket()) {
+		obs_log(LOG_ERROR, "tbar-web: wake socket setup failed");
+		close_sockets();
+		WSACleanup();
+		return false;
+	}
+
+	if (udp_port > 0 && !open_udp_socket(udp_port)) {
+		close_sockets();
+		WSACleanup();
+		return false;
+	}
+
+	uintptr_t th = _beginthreadex(NULL, 0, server_thread, NULL, 0, NULL);
+	if (th == 0) {
+		obs_log(LOG_ERROR, "tbar-web: failed to start thread (_beginthreadex)");
+		close_sockets();
+		WSACleanup();
+		return false;
+	}
+
+	g_loop.thread = (HANDLE)th;
+	return true;
+}
+
+void tbar_server_wake(void)
+{
+	char b = 0;
+	sendto(g_loop.wake_sock, &b, 1, 0, (struct sockaddr *)&g_loop.wake_addr, (int)sizeof(g_loop.wake_addr));
+}
+
+void tbar_server_stop(void)
+{
+	g_loop.stop = true;
+
+	/* Force select() to wake up */
+	tbar_server_wake();
+
+	WaitForSingleObject(g_loop.thread, INFINITE);
+	CloseHandle(g_loop.thread);
+	g_loop.thread = NULL;
+
+	close_sockets();
+	WSACleanup();
+}
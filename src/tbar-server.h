@@ -0,0 +1,39 @@
+/*
+Plugin Name
+Copyright (C) <Year> <Developer> <Email Address>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#pragma once
+
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Platform server backends (tbar-server-win32.c, tbar-server-epoll.c, tbar-server-stub.c).
+   Each one runs its own socket thread, accepts on 127.0.0.1:<port> and feeds
+   connections through the HTTP core in tbar-http.c. A non-zero `udp_port` also
+   binds a datagram socket on 127.0.0.1 whose packets go to tbar-udp.c. */
+bool tbar_server_start(int port, int udp_port);
+void tbar_server_stop(void);
+
+/* Thread-safe; makes the socket thread call tbar_web_on_wake() */
+void tbar_server_wake(void);
+
+#ifdef __cplusplus
+}
+#endif
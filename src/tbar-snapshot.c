@@ -0,0 +1,152 @@
+/*
+Plugin Name
+Copyright (C) <Year> <Developer> <Email Address>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include "tbar-snapshot.h"
+
+#include <util/threading.h>
+
+#include <string.h>
+
+#define WORDS(type) ((sizeof(type) + sizeof(long) - 1) / sizeof(long))
+
+/* Each section as a run of words that can each be moved atomically */
+union ui_words {
+	struct tbar_snapshot_ui state;
+	long words[WORDS(struct tbar_snapshot_ui)];
+};
+
+union tick_words {
+	struct tbar_snapshot_tick state;
+	long words[WORDS(struct tbar_snapshot_tick)];
+};
+
+/* One published section: odd `seq` while a publish is in progress; `version`
+   counts the publishes and travels with the words */
+struct section {
+	volatile long seq;
+	volatile long version;
+	volatile long *published;
+	size_t count;
+};
+
+static struct {
+	pthread_mutex_t mutex;
+	union ui_words ui;                /* UI writers' copy, under the mutex */
+	struct tbar_snapshot_ui ui_last;  /* last published, under the mutex */
+	union tick_words tick;            /* tick writer's copy */
+	struct tbar_snapshot_tick tick_last;
+
+	volatile long ui_published[WORDS(struct tbar_snapshot_ui)];
+	volatile long tick_published[WORDS(struct tbar_snapshot_tick)];
+	struct section ui_section;
+	struct section tick_section;
+} g_snap = {
+	.mutex = PTHREAD_MUTEX_INITIALIZER,
+	.ui_section = {.published = g_snap.ui_published, .count = WORDS(struct tbar_snapshot_ui)},
+	.tick_section = {.published = g_snap.tick_published, .count = WORDS(struct tbar_snapshot_tick)},
+};
+
+static void publish(struct section *sec, const long *words)
+{
+	os_atomic_inc_long(&sec->seq);
+	os_atomic_inc_long(&sec->version);
+	for (size_t i = 0; i < sec->count; i++)
+		os_atomic_store_long(&sec->published[i], words[i]);
+	os_atomic_inc_long(&sec->seq);
+}
+
+/* Copies one section; returns its version */
+static long copy_section(struct section *sec, long *words)
+{
+	for (;;) {
+		long seq = os_atomic_load_long(&sec->seq);
+		if (seq & 1)
+			continue;
+		long version = os_atomic_load_long(&sec->version);
+		for (size_t i = 0; i < sec->count; i++)
+			words[i] = os_atomic_load_long(&sec->published[i]);
+		if (os_atomic_load_long(&sec->seq) == seq)
+			return version;
+	}
+}
+
+struct tbar_snapshot_ui *tbar_snapshot_begin(void)
+{
+	pthread_mutex_lock(&g_snap.mutex);
+	return &g_snap.ui.state;
+}
+
+bool tbar_snapshot_end(void)
+{
+	/* Writers only assign fields, so the padding stays zero and compares equal */
+	bool changed = memcmp(&g_snap.ui.state, &g_snap.ui_last, sizeof(g_snap.ui_last)) != 0;
+	if (changed) {
+		g_snap.ui_last = g_snap.ui.state;
+		publish(&g_snap.ui_section, g_snap.ui.words);
+	}
+	pthread_mutex_unlock(&g_snap.mutex);
+	return changed;
+}
+
+struct tbar_snapshot_tick *tbar_snapshot_tick_begin(void)
+{
+	return &g_snap.tick.state;
+}
+
+bool tbar_snapshot_tick_end(void)
+{
+	bool changed = memcmp(&g_snap.tick.state, &g_snap.tick_last, sizeof(g_snap.tick_last)) != 0;
+	if (changed) {
+		g_snap.tick_last = g_snap.tick.state;
+		publish(&g_snap.tick_section, g_snap.tick.words);
+	}
+	return changed;
+}
+
+void tbar_snapshot_read(struct tbar_snapshot *out)
+{
+	union ui_words ui;
+	union tick_words tick;
+	/* Each section's version only moves forward, so their sum is a change
+	   counter: it grows whenever either section changed since an earlier read.
+	   It does not identify the pair, and the two copies are taken one after
+	   the other, so they need not have been current at the same moment. */
+	long ui_version = copy_section(&g_snap.ui_section, ui.words);
+	long tick_version = copy_section(&g_snap.tick_section, tick.words);
+
+	memset(out, 0, sizeof(*out));
+	out->version = (uint64_t)(unsigned long)ui_version + (uint64_t)(unsigned long)tick_version;
+	out->studio_mode = ui.state.studio_mode;
+	out->transition_fixed = ui.state.transition_fixed;
+	memcpy(out->transition, ui.state.transition, sizeof(out->transition));
+	memcpy(out->program, ui.state.program, sizeof(out->program));
+	memcpy(out->preview, ui.state.preview, sizeof(out->preview));
+	out->applied = ui.state.applied + tick.state.applied;
+	out->applied_on_tick = tick.state.applied;
+	out->config = ui.state.config;
+	for (int i = 0; i < TBAR_MAX_CHANNELS; i++) {
+		struct tbar_snapshot_channel *c = &out->channels[i];
+		c->position = tick.state.channels[i].position_ns > ui.state.channels[i].position_ns
+				      ? tick.state.channels[i].position
+				      : ui.state.channels[i].position;
+		c->manual_active = ui.state.channels[i].manual_active;
+		c->live_position = tick.state.channels[i].live_position;
+		c->live_valid = tick.state.channels[i].live_valid;
+		c->live_active = tick.state.channels[i].live_active;
+	}
+}
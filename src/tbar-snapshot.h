@@ -0,0 +1,135 @@
+/*
+Plugin Name
+Copyright (C) <Year> <Developer> <Email Address>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#pragma once
+
+#include "tbar-web.h"
+#include "tbar-arbiter.h"
+#include "tbar-jitter.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Everything the read endpoints report, published as one versioned snapshot.
+
+   The state is written in two sections, each behind its own sequence counter
+   (a seqlock) and stored and loaded one atomic word at a time, so readers on
+   any thread take no lock and never make a writer wait:
+
+   - the UI section (scenes, transition, manual flags, UI-thread applies and
+     the config in effect),
+     changed between tbar_snapshot_begin() and tbar_snapshot_end(); those
+     writers are serialized by a mutex;
+   - the tick section (positions applied on the video tick, live readback),
+     changed between tbar_snapshot_tick_begin() and tbar_snapshot_tick_end()
+     by the video tick alone, so rendering never waits on the UI thread.
+
+   A reader that overlaps a publish just copies that section again. Each
+   section is consistent in itself, but the two are copied one after the
+   other: a merged snapshot may pair UI and tick state that never coexisted. */
+
+#define TBAR_SNAPSHOT_NAME 128
+
+struct tbar_snapshot_channel {
+	double position;      /* fader position after the last update applied */
+	double live_position; /* progress of the channel's transition, sampled once per frame */
+	bool live_valid;      /* live_* have been sampled */
+	bool live_active;     /* a transition is running, whoever drives it */
+	bool manual_active;   /* this plugin is driving a manual transition */
+};
+
+/* The settings GET /config and GET /status report, as last applied */
+struct tbar_snapshot_config {
+	bool enabled;
+	int port;
+	bool udp_enabled;
+	int udp_port;
+	bool tick_apply;
+	enum tbar_interp interpolation;
+	int jitter_delay_ms;
+	int header_timeout_ms;
+	int body_timeout_ms;
+	int max_connections;
+	enum tbar_lease_mode lease_mode;
+	int lease_ms;
+};
+
+struct tbar_snapshot {
+	uint64_t version; /* change counter: grows with every publish that changes anything below */
+	bool studio_mode;
+	bool transition_fixed; /* the main transition cannot be driven manually (e.g. Cut) */
+	char transition[TBAR_SNAPSHOT_NAME];
+	char program[TBAR_SNAPSHOT_NAME];
+	char preview[TBAR_SNAPSHOT_NAME]; /* empty outside Studio Mode */
+	uint64_t applied;                 /* positions applied to a transition */
+	uint64_t applied_on_tick;         /* of those, on the video tick */
+	struct tbar_snapshot_channel channels[TBAR_MAX_CHANNELS];
+	struct tbar_snapshot_config config;
+};
+
+/* The UI writers' section. A channel's position is taken from whichever
+   section applied one last, going by `position_ns`. */
+struct tbar_snapshot_ui {
+	bool studio_mode;
+	bool transition_fixed;
+	char transition[TBAR_SNAPSHOT_NAME];
+	char program[TBAR_SNAPSHOT_NAME];
+	char preview[TBAR_SNAPSHOT_NAME];
+	uint64_t applied; /* on the UI thread */
+	struct {
+		double position;
+		uint64_t position_ns; /* os_gettime_ns() when it was applied */
+		bool manual_active;
+	} channels[TBAR_MAX_CHANNELS];
+	struct tbar_snapshot_config config;
+};
+
+/* The video tick's section */
+struct tbar_snapshot_tick {
+	uint64_t applied;
+	struct {
+		double position;
+		uint64_t position_ns;
+		double live_position;
+		bool live_valid;
+		bool live_active;
+	} channels[TBAR_MAX_CHANNELS];
+};
+
+/* UI writers: returns the writers' copy of the UI section, locked until
+   tbar_snapshot_end() */
+struct tbar_snapshot_ui *tbar_snapshot_begin(void);
+/* Publishes the copy if it differs from the last one published; returns
+   whether it did (the version then went up) */
+bool tbar_snapshot_end(void);
+
+/* The video tick, or another thread once the tick is unregistered: the tick
+   section, which has a single writer and takes no lock */
+struct tbar_snapshot_tick *tbar_snapshot_tick_begin(void);
+bool tbar_snapshot_tick_end(void);
+
+/* Any thread: copies the latest published state */
+void tbar_snapshot_read(struct tbar_snapshot *out);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,124 @@
+/*
+Plugin Name
+Copyright (C) <Year> <Developer> <Email Address>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include "tbar-sse.h"
+#include "tbar-metrics.h"
+
+#include <stdio.h>
+#include <string.h>
+
+/* Largest event frame, framing included */
+#define SSE_MAX_FRAME 1024
+
+/* Server thread only */
+static int g_subscribers;
+
+static const char g_sse_headers[] = "HTTP/1.1 200 OK\r\n"
+				    "Content-Type: text/event-stream\r\n"
+				    "Cache-Control: no-cache\r\n"
+				    "Connection: keep-alive\r\n"
+				    "Access-Control-Allow-Origin: *\r\n"
+				    "\r\n"
+				    "retry: 1000\n\n";
+
+static const char g_sse_ping[] = ": ping\n\n";
+
+void tbar_sse_accept(struct tbar_conn *c)
+{
+	tbar_conn_write_ref(c, g_sse_headers, sizeof(g_sse_headers) - 1);
+	c->keep_alive = true;
+	c->sse = true;
+	c->last_ping_ns = c->last_active_ns;
+	c->last_drained_ns = c->last_active_ns;
+	g_subscribers++;
+}
+
+void tbar_sse_detach(struct tbar_conn *c)
+{
+	(void)c;
+	g_subscribers--;
+}
+
+int tbar_sse_subscribers(void)
+{
+	return g_subscribers;
+}
+
+static int format_frame(char *buf, size_t size, const char *event, const char *data, size_t len)
+{
+	int n = snprintf(buf, size, "event: %s\ndata: %.*s\n\n", event, (int)len, data);
+	return n > 0 && (size_t)n < size ? n : -1;
+}
+
+bool tbar_sse_send(struct tbar_conn *c, const char *event, const char *data, size_t len)
+{
+	char frame[SSE_MAX_FRAME];
+	int n = format_frame(frame, sizeof(frame), event, data, len);
+	return n > 0 && tbar_conn_write(c, frame, (size_t)n);
+}
+
+void tbar_sse_publish(struct tbar_conn *conns, int count, enum tbar_sse_kind kind, const char *event,
+		      const char *data, size_t len, bool coalesce)
+{
+	if (!g_subscribers)
+		return;
+
+	char frame[SSE_MAX_FRAME];
+	int n = format_frame(frame, sizeof(frame), event, data, len);
+	if (n < 0)
+		return;
+	struct tbar_shared_buf *buf = tbar_shared_buf_create(frame, (size_t)n, kind);
+	if (!buf)
+		return;
+
+	for (int i = 0; i < count; i++) {
+		struct tbar_conn *c = &conns[i];
+		if (!c->in_use || !c->sse || c->closing)
+			continue;
+
+		if (coalesce && tbar_conn_replace_shared(c, buf)) {
+			tbar_metrics_add(TBAR_THREAD_SERVER, TBAR_COUNTER_SSE_COALESCED, 1);
+			continue;
+		}
+		if (c->out_pending >= TBAR_SSE_MAX_BACKLOG) {
+			tbar_metrics_add(TBAR_THREAD_SERVER, TBAR_COUNTER_SSE_DROPPED, 1);
+			continue;
+		}
+		tbar_conn_write_shared(c, buf);
+	}
+
+	tbar_metrics_add(TBAR_THREAD_SERVER, TBAR_COUNTER_SSE_EVENTS, 1);
+	tbar_shared_buf_release(buf);
+}
+
+bool tbar_sse_check_idle(struct tbar_conn *c, uint64_t now_ns)
+{
+	const uint64_t interval = (uint64_t)TBAR_SSE_KEEPALIVE_MS * 1000000;
+
+	if (!tbar_conn_has_output(c))
+		c->last_drained_ns = now_ns;
+	else if (now_ns - c->last_drained_ns > 3 * interval)
+		return false;
+
+	if (now_ns - c->last_ping_ns > interval) {
+		c->last_ping_ns = now_ns;
+		if (c->out_pending < TBAR_SSE_MAX_BACKLOG)
+			tbar_conn_write_ref(c, g_sse_ping, sizeof(g_sse_ping) - 1);
+	}
+	return true;
+}
@@ -0,0 +1,67 @@
+/*
+Plugin Name
+Copyright (C) <Year> <Developer> <Email Address>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#pragma once
+
+#include "tbar-http.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Server-Sent Events for GET /events.
+
+   Every event is serialized once into a shared buffer and queued by reference
+   on each subscriber. A subscriber whose socket falls behind keeps at most
+   TBAR_SSE_MAX_BACKLOG unsent bytes: a newer frame of a coalescing event
+   replaces one still waiting in its queue, and anything beyond the limit is
+   dropped for that subscriber only. */
+
+/* A comment line is sent this often so proxies keep the stream open */
+#define TBAR_SSE_KEEPALIVE_MS 15000
+#define TBAR_SSE_MAX_BACKLOG 4096
+
+/* Shared buffer tags; frames with the same tag replace each other when
+   coalescing */
+enum tbar_sse_kind {
+	TBAR_SSE_STATE = 1,
+	TBAR_SSE_TRANSITION,
+};
+
+/* Sends the stream headers and turns the connection into a subscriber */
+void tbar_sse_accept(struct tbar_conn *c);
+
+/* Called from tbar_conn_reset() when a subscriber goes away */
+void tbar_sse_detach(struct tbar_conn *c);
+
+int tbar_sse_subscribers(void);
+
+/* Queues "event: <event>\ndata: <data>\n\n" on one connection (copied) */
+bool tbar_sse_send(struct tbar_conn *c, const char *event, const char *data, size_t len);
+
+/* Queues the same frame on every subscriber in conns[0..count) */
+void tbar_sse_publish(struct tbar_conn *conns, int count, enum tbar_sse_kind kind, const char *event,
+		      const char *data, size_t len, bool coalesce);
+
+/* Sweep hook: keep-alive comments, and closes (returns false) a subscriber
+   whose queue has not drained for three keep-alive intervals. */
+bool tbar_sse_check_idle(struct tbar_conn *c, uint64_t now_ns);
+
+#ifdef __cplusplus
+}
+#endif
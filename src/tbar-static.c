@@ -0,0 +1,275 @@
+/*
+Plugin Name
+Copyright (C) <Year> <Developer> <Email Address>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include "tbar-static.h"
+#include "tbar-gzip.h"
+
+#include <obs-module.h>
+#include <plugin-support.h>
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_ASSETS 8
+
+enum encoding {
+	ENC_IDENTITY,
+	ENC_GZIP,
+	ENC_COUNT,
+};
+
+enum connection {
+	CONN_KEEP_ALIVE,
+	CONN_CLOSE,
+	CONN_COUNT,
+};
+
+struct response {
+	char *data;
+	size_t len;
+	size_t header_len; /* what HEAD sends */
+};
+
+struct asset {
+	const char *path;
+	const char *content_type;
+	const char *data;
+	size_t len;
+
+	bool ready;
+	bool has_gzip;
+	char etag[ENC_COUNT][32];
+	struct response ok[ENC_COUNT][CONN_COUNT];
+	struct response not_modified[ENC_COUNT][CONN_COUNT];
+};
+
+static struct asset g_assets[MAX_ASSETS];
+static int g_asset_count;
+
+bool tbar_static_add(const char *path, const char *content_type, const char *data, size_t len)
+{
+	if (g_asset_count == MAX_ASSETS)
+		return false;
+
+	struct asset *a = &g_assets[g_asset_count++];
+	memset(a, 0, sizeof(*a));
+	a->path = path;
+	a->content_type = content_type;
+	a->data = data;
+	a->len = len;
+	return true;
+}
+
+static uint64_t fnv1a(const char *p, size_t len)
+{
+	uint64_t h = 0xcbf29ce484222325ULL;
+	for (size_t i = 0; i < len; i++) {
+		h ^= (uint8_t)p[i];
+		h *= 0x100000001b3ULL;
+	}
+	return h;
+}
+
+static bool build_response(struct response *r, const struct asset *a, enum encoding enc, enum connection conn,
+			   bool not_modified, const char *body, size_t body_len)
+{
+	char header[512];
+	int n;
+
+	if (not_modified) {
+		n = snprintf(header, sizeof(header),
+			     "HTTP/1.1 304 Not Modified\r\n"
+			     "ETag: %s\r\n"
+			     "Vary: Accept-Encoding\r\n"
+			     "Cache-Control: no-cache\r\n"
+			     "Connection: %s\r\n"
+			     "\r\n",
+			     a->etag[enc], conn == CONN_CLOSE ? "close" : "keep-alive");
+		body_len = 0;
+	} else {
+		n = snprintf(header, sizeof(header),
+			     "HTTP/1.1 200 OK\r\n"
+			     "Content-Type: %s\r\n"
+			     "Content-Length: %zu\r\n"
+			     "%s"
+			     "Vary: Accept-Encoding\r\n"
+			     "ETag: %s\r\n"
+			     "Cache-Control: no-cache\r\n"
+			     "Connection: %s\r\n"
+			     "Access-Control-Allow-Origin: *\r\n"
+			     "\r\n",
+			     a->content_type, body_len, enc == ENC_GZIP ? "Content-Encoding: gzip\r\n" : "", a->etag[enc],
+			     conn == CONN_CLOSE ? "close" : "keep-alive");
+	}
+	if (n <= 0 || (size_t)n >= sizeof(header))
+		return false;
+
+	r->data = malloc((size_t)n + body_len);
+	if (!r->data)
+		return false;
+	memcpy(r->data, header, (size_t)n);
+	if (body_len)
+		memcpy(r->data + n, body, body_len);
+	r->header_len = (size_t)n;
+	r->len = (size_t)n + body_len;
+	return true;
+}
+
+static void build_asset(struct asset *a)
+{
+	uint64_t hash = fnv1a(a->data, a->len);
+	snprintf(a->etag[ENC_IDENTITY], sizeof(a->etag[0]), "\"%016llx\"", (unsigned long long)hash);
+	snprintf(a->etag[ENC_GZIP], sizeof(a->etag[0]), "\"%016llx-gz\"", (unsigned long long)hash);
+
+	/* Only worth a variant if it is actually smaller */
+	size_t gz_cap = a->len;
+	uint8_t *gz = malloc(gz_cap ? gz_cap : 1);
+	size_t gz_len = gz ? tbar_gzip_compress((const uint8_t *)a->data, a->len, gz, gz_cap) : 0;
+
+	bool ok = true;
+	bool gz_ok = gz_len > 0;
+	for (int conn = 0; conn < CONN_COUNT; conn++) {
+		ok &= build_response(&a->ok[ENC_IDENTITY][conn], a, ENC_IDENTITY, conn, false, a->data, a->len);
+		ok &= build_response(&a->not_modified[ENC_IDENTITY][conn], a, ENC_IDENTITY, conn, true, NULL, 0);
+		if (gz_len) {
+			gz_ok &= build_response(&a->ok[ENC_GZIP][conn], a, ENC_GZIP, conn, false, (const char *)gz,
+						gz_len);
+			gz_ok &= build_response(&a->not_modified[ENC_GZIP][conn], a, ENC_GZIP, conn, true, NULL, 0);
+		}
+	}
+	free(gz);
+
+	a->ready = ok;
+	a->has_gzip = gz_ok;
+	if (!ok)
+		obs_log(LOG_ERROR, "tbar-web: out of memory building %s", a->path);
+
+	obs_log(LOG_DEBUG, "tbar-web: static %s: %zu bytes, gzip %zu", a->path, a->len, gz_len);
+}
+
+void tbar_static_init(void)
+{
+	for (int i = 0; i < g_asset_count; i++)
+		build_asset(&g_assets[i]);
+}
+
+void tbar_static_free(void)
+{
+	for (int i = 0; i < g_asset_count; i++) {
+		struct asset *a = &g_assets[i];
+		for (int enc = 0; enc < ENC_COUNT; enc++) {
+			for (int conn = 0; conn < CONN_COUNT; conn++) {
+				free(a->ok[enc][conn].data);
+				free(a->not_modified[enc][conn].data);
+			}
+		}
+	}
+	g_asset_count = 0;
+}
+
+/* Accept-Encoding lists gzip (or *) without q=0 */
+static bool accepts_gzip(struct tbar_http_str value)
+{
+	const char *p = value.ptr;
+	const char *end = value.ptr + value.len;
+
+	while (p < end) {
+		while (p < end && (*p == ' ' || *p == '\t' || *p == ','))
+			p++;
+		const char *name = p;
+		while (p < end && *p != ',' && *p != ';' && *p != ' ' && *p != '\t')
+			p++;
+		struct tbar_http_str coding = {name, (size_t)(p - name)};
+
+		/* Parameters; only q matters */
+		bool refused = false;
+		while (p < end && *p != ',') {
+			if ((*p == 'q' || *p == 'Q') && p + 1 < end && p[1] == '=') {
+				p += 2;
+				refused = p < end && *p == '0';
+				while (p < end && (*p == '0' || *p == '.'))
+					p++;
+				if (p < end && *p >= '1' && *p <= '9')
+					refused = false;
+				continue;
+			}
+			p++;
+		}
+
+		if (!refused && (tbar_http_str_case_eq(coding, "gzip") || tbar_http_str_case_eq(coding, "x-gzip") ||
+				 tbar_http_str_eq(coding, "*")))
+			return true;
+	}
+	return false;
+}
+
+/* If-None-Match contains `etag` (weak comparison) or "*" */
+static bool etag_matches(struct tbar_http_str value, const char *etag)
+{
+	size_t etag_len = strlen(etag);
+	const char *p = value.ptr;
+	const char *end = value.ptr + value.len;
+
+	while (p < end) {
+		while (p < end && (*p == ' ' || *p == '\t' || *p == ','))
+			p++;
+		if (p < end && *p == '*')
+			return true;
+		if (end - p >= 2 && p[0] == 'W' && p[1] == '/')
+			p += 2;
+		if ((size_t)(end - p) >= etag_len && memcmp(p, etag, etag_len) == 0)
+			return true;
+		while (p < end && *p != ',')
+			p++;
+	}
+	return false;
+}
+
+bool tbar_static_serve(struct tbar_conn *c, const struct tbar_http_request *req)
+{
+	if (req->method != TBAR_HTTP_GET && req->method != TBAR_HTTP_HEAD)
+		return false;
+
+	struct tbar_http_str path = tbar_http_span_str(req, req->path);
+	if (tbar_http_str_eq(path, "/")) {
+		path.ptr = "/index.html";
+		path.len = strlen(path.ptr);
+	}
+
+	const struct asset *a = NULL;
+	for (int i = 0; i < g_asset_count && !a; i++) {
+		if (tbar_http_str_eq(path, g_assets[i].path))
+			a = &g_assets[i];
+	}
+	if (!a || !a->ready)
+		return false;
+
+	enum encoding enc = ENC_IDENTITY;
+	if (a->has_gzip && accepts_gzip(tbar_http_header(req, "Accept-Encoding")))
+		enc = ENC_GZIP;
+	enum connection conn = c->keep_alive ? CONN_KEEP_ALIVE : CONN_CLOSE;
+
+	struct tbar_http_str inm = tbar_http_header(req, "If-None-Match");
+	const struct response *r = inm.ptr && etag_matches(inm, a->etag[enc]) ? &a->not_modified[enc][conn]
+									      : &a->ok[enc][conn];
+
+	tbar_conn_write_ref(c, r->data, req->method == TBAR_HTTP_HEAD ? r->header_len : r->len);
+	return true;
+}
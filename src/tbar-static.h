@@ -0,0 +1,49 @@
+/*
+Plugin Name
+Copyright (C) <Year> <Developer> <Email Address>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#pragma once
+
+#include "tbar-http.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Built-in static assets. Every response (identity and gzip, keep-alive and
+   close) is built in full once by tbar_static_init() and queued by reference,
+   so serving one is a lookup and a pointer push. Strong ETags let reloading
+   clients revalidate with a header-only 304. */
+
+/* `data` must stay valid until tbar_static_free() */
+bool tbar_static_add(const char *path, const char *content_type, const char *data, size_t len);
+
+/* Builds the prebuilt responses; call before the server starts */
+void tbar_static_init(void);
+
+/* Drops all assets; call after the server has stopped */
+void tbar_static_free(void);
+
+/* Answers GET/HEAD for a known asset path. Returns false if it is not one. */
+bool tbar_static_serve(struct tbar_conn *c, const struct tbar_http_request *req);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,111 @@
+/*
+Plugin Name
+Copyright (C) <Year> <Developer> <Email Address>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include "tbar-trajectory.h"
+
+#include <math.h>
+#include <string.h>
+
+bool tbar_easing_from_name(const char *name, enum tbar_easing *out)
+{
+	static const struct {
+		const char *name;
+		enum tbar_easing easing;
+	} names[] = {
+		{"linear", TBAR_EASE_LINEAR},
+		{"ease-in", TBAR_EASE_IN},
+		{"ease-out", TBAR_EASE_OUT},
+		{"ease-in-out", TBAR_EASE_IN_OUT},
+	};
+
+	for (size_t i = 0; i < sizeof(names) / sizeof(names[0]); i++) {
+		if (strcmp(name, names[i].name) == 0) {
+			*out = names[i].easing;
+			return true;
+		}
+	}
+	return false;
+}
+
+bool tbar_trajectory_validate(struct tbar_trajectory *traj)
+{
+	if (traj->count < 1 || traj->count > TBAR_TRAJECTORY_MAX_POINTS)
+		return false;
+
+	double prev = 0.0;
+	for (int i = 0; i < traj->count; i++) {
+		struct tbar_trajectory_point *p = &traj->points[i];
+		/* Also catches NaN */
+		if (!(p->t_ms >= prev && p->t_ms <= TBAR_TRAJECTORY_MAX_MS) || !isfinite(p->pos))
+			return false;
+		prev = p->t_ms;
+
+		if (p->pos < 0.0)
+			p->pos = 0.0;
+		if (p->pos > 1.0)
+			p->pos = 1.0;
+	}
+	return true;
+}
+
+double tbar_trajectory_duration_ms(const struct tbar_trajectory *traj)
+{
+	return traj->count ? traj->points[traj->count - 1].t_ms : 0.0;
+}
+
+static double ease(enum tbar_easing easing, double u)
+{
+	switch (easing) {
+	case TBAR_EASE_IN:
+		return u * u * u;
+	case TBAR_EASE_OUT: {
+		double v = 1.0 - u;
+		return 1.0 - v * v * v;
+	}
+	case TBAR_EASE_IN_OUT: {
+		if (u < 0.5)
+			return 4.0 * u * u * u;
+		double v = -2.0 * u + 2.0;
+		return 1.0 - v * v * v / 2.0;
+	}
+	default:
+		return u;
+	}
+}
+
+double tbar_trajectory_sample(const struct tbar_trajectory *traj, double t_ms)
+{
+	const struct tbar_trajectory_point *p = traj->points;
+	int n = traj->count;
+
+	if (n == 0)
+		return 0.0;
+	if (t_ms <= p[0].t_ms)
+		return p[0].pos;
+	if (t_ms >= p[n - 1].t_ms)
+		return p[n - 1].pos;
+
+	/* Keyframes are few; a linear scan is cheaper than bookkeeping */
+	int i = 1;
+	while (p[i].t_ms <= t_ms)
+		i++;
+
+	double span = p[i].t_ms - p[i - 1].t_ms;
+	double u = span > 0.0 ? (t_ms - p[i - 1].t_ms) / span : 1.0;
+	return p[i - 1].pos + (p[i].pos - p[i - 1].pos) * ease(traj->easing, u);
+}
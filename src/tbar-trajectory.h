@@ -0,0 +1,70 @@
+/*
+Plugin Name
+Copyright (C) <Year> <Developer> <Email Address>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#pragma once
+
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* A fader move uploaded in one request and played back on the video tick:
+   keyframes on a millisecond timeline, with an easing curve between each
+   consecutive pair. Sampling is a pure function of the time since the first
+   frame, so playback is frame-accurate regardless of network timing. */
+
+#define TBAR_TRAJECTORY_MAX_POINTS 64
+/* Longest move accepted */
+#define TBAR_TRAJECTORY_MAX_MS 600000.0
+
+enum tbar_easing {
+	TBAR_EASE_LINEAR,
+	TBAR_EASE_IN,     /* cubic */
+	TBAR_EASE_OUT,    /* cubic */
+	TBAR_EASE_IN_OUT, /* cubic */
+};
+
+struct tbar_trajectory_point {
+	double t_ms;
+	double pos; /* 0..1 */
+};
+
+struct tbar_trajectory {
+	int count; /* 0 = nothing to play */
+	struct tbar_trajectory_point points[TBAR_TRAJECTORY_MAX_POINTS];
+	enum tbar_easing easing;
+	bool release; /* commit with a release once the last keyframe is reached */
+};
+
+/* "linear", "ease-in", "ease-out" or "ease-in-out" */
+bool tbar_easing_from_name(const char *name, enum tbar_easing *out);
+
+/* Checks the keyframes: at least one, times finite, non-negative, not
+   decreasing and within TBAR_TRAJECTORY_MAX_MS. Positions are clamped to 0..1. */
+bool tbar_trajectory_validate(struct tbar_trajectory *traj);
+
+double tbar_trajectory_duration_ms(const struct tbar_trajectory *traj);
+
+/* Position at `t_ms` after the start; holds the first keyframe before it and
+   the last one after it */
+double tbar_trajectory_sample(const struct tbar_trajectory *traj, double t_ms);
+
+#ifdef __cplusplus
+}
+#endif
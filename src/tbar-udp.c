@@ -0,0 +1,331 @@
+/*
+Plugin Name
+Copyright (C) <Year> <Developer> <Email Address>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include "tbar-udp.h"
+#include "tbar-arbiter.h"
+#include "tbar-web.h"
+
+#include <util/threading.h>
+
+#include <stdio.h>
+#include <string.h>
+
+/* Senders tracked for sequence numbers; the least recently accepted is recycled */
+#define MAX_SENDERS 16
+/* A sender silent this long may restart its sequence from anywhere */
+#define SENDER_RESET_MS 2000
+/* Nested OSC bundles deeper than this are rejected */
+#define MAX_BUNDLE_DEPTH 4
+#define MAX_OSC_ARGS 4
+
+/* OBS frontend T-bar range is integer 0..1023 */
+#define TBAR_MAX 1023
+
+struct tbar_udp_stats tbar_udp_stats;
+
+static struct {
+	bool used;
+	uint64_t source;
+	uint32_t last_seq;
+	uint64_t last_seen_ns;
+} g_senders[MAX_SENDERS];
+
+void tbar_udp_reset(void)
+{
+	memset(g_senders, 0, sizeof(g_senders));
+}
+
+/* Accepts `seq` only if it is newer than the last one seen from `source`
+   (serial number arithmetic, so the counter may wrap). */
+static bool sequence_accept(uint64_t source, uint32_t seq, uint64_t now_ns)
+{
+	int slot = -1;
+	int oldest = 0;
+
+	for (int i = 0; i < MAX_SENDERS; i++) {
+		if (g_senders[i].used && g_senders[i].source == source) {
+			slot = i;
+			break;
+		}
+		if (!g_senders[i].used ||
+		    (g_senders[oldest].used && g_senders[i].last_seen_ns < g_senders[oldest].last_seen_ns))
+			oldest = i;
+	}
+
+	if (slot >= 0 && now_ns - g_senders[slot].last_seen_ns <= (uint64_t)SENDER_RESET_MS * 1000000 &&
+	    (int32_t)(seq - g_senders[slot].last_seq) <= 0)
+		return false;
+
+	if (slot < 0) {
+		slot = oldest;
+		g_senders[slot].used = true;
+		g_senders[slot].source = source;
+	}
+	g_senders[slot].last_seq = seq;
+	g_senders[slot].last_seen_ns = now_ns;
+	return true;
+}
+
+static uint32_t rd_u32(const uint8_t *p)
+{
+	return (uint32_t)p[0] << 24 | (uint32_t)p[1] << 16 | (uint32_t)p[2] << 8 | (uint32_t)p[3];
+}
+
+static float rd_f32(const uint8_t *p)
+{
+	uint32_t bits = rd_u32(p);
+	float f;
+	memcpy(&f, &bits, sizeof(f));
+	return f;
+}
+
+static double rd_f64(const uint8_t *p)
+{
+	uint64_t bits = (uint64_t)rd_u32(p) << 32 | rd_u32(p + 4);
+	double d;
+	memcpy(&d, &bits, sizeof(d));
+	return d;
+}
+
+static void submit(uint64_t source, double pos, bool release, double sender_ms, uint64_t now_ns)
+{
+	/* NaN fails both comparisons */
+	if (!(pos >= 0.0 && pos <= 1.0)) {
+		os_atomic_inc_long(&tbar_udp_stats.invalid);
+		return;
+	}
+
+	/* Sequence numbers were checked above; the sender address is the client id.
+	   Datagrams drive the main output channel. */
+	char id[24];
+	snprintf(id, sizeof(id), "udp:%016llx", (unsigned long long)source);
+	if (tbar_arbiter_check(0, id, false, 0, release, now_ns).verdict != TBAR_ARBITER_ACCEPT)
+		return;
+
+	tbar_web_submit_timed_position(0, TBAR_SOURCE_UDP, pos, release, sender_ms);
+	os_atomic_inc_long(&tbar_udp_stats.applied);
+}
+
+/* ------------------------------ */
+/* Compact binary packet          */
+/* ------------------------------ */
+
+static void handle_compact(const uint8_t *p, size_t len, uint64_t source, uint64_t now_ns)
+{
+	bool v1 = len == TBAR_UDP_COMPACT_SIZE && p[4] == TBAR_UDP_COMPACT_VERSION;
+	bool v2 = len == TBAR_UDP_COMPACT_V2_SIZE && p[4] == TBAR_UDP_COMPACT_V2_VERSION;
+	if (!v1 && !v2) {
+		os_atomic_inc_long(&tbar_udp_stats.invalid);
+		return;
+	}
+
+	if (!sequence_accept(source, rd_u32(p + 8), now_ns)) {
+		os_atomic_inc_long(&tbar_udp_stats.dropped_stale);
+		return;
+	}
+
+	submit(source, rd_f32(p + 12), (p[5] & 1) != 0, v2 ? rd_f64(p + 16) : -1.0, now_ns);
+}
+
+/* ------------------------------ */
+/* OSC                            */
+/* ------------------------------ */
+
+struct osc_arg {
+	char type;
+	double num;
+	bool truth;
+};
+
+/* OSC strings are NUL-terminated and padded to a multiple of 4 bytes.
+   Returns the padded size, or 0 if the string is not terminated in range. */
+static size_t osc_string(const uint8_t *p, size_t len, const char **out)
+{
+	size_t n = 0;
+	while (n < len && p[n])
+		n++;
+	if (n == len)
+		return 0;
+
+	size_t padded = (n + 4) & ~(size_t)3;
+	if (padded > len)
+		return 0;
+	*out = (const char *)p;
+	return padded;
+}
+
+static int osc_parse_args(const char *types, const uint8_t *p, size_t len, struct osc_arg *args)
+{
+	int count = 0;
+
+	for (const char *t = types + 1; *t; t++) {
+		struct osc_arg a = {*t, 0.0, false};
+		size_t need = 0;
+
+		switch (*t) {
+		case 'f':
+			need = 4;
+			if (len >= need)
+				a.num = rd_f32(p);
+			break;
+		case 'i':
+			need = 4;
+			if (len >= need)
+				a.num = (double)(int32_t)rd_u32(p);
+			break;
+		case 'd':
+			need = 8;
+			if (len >= need)
+				a.num = rd_f64(p);
+			break;
+		case 'T':
+			a.truth = true;
+			break;
+		case 'F':
+			break;
+		default:
+			/* Unsupported argument type; stop here */
+			return -1;
+		}
+
+		if (len < need)
+			return -1;
+		p += need;
+		len -= need;
+
+		if (count < MAX_OSC_ARGS)
+			args[count++] = a;
+	}
+
+	return count;
+}
+
+static bool osc_is_number(const struct osc_arg *a)
+{
+	return a->type == 'f' || a->type == 'i' || a->type == 'd';
+}
+
+static double osc_position(const struct osc_arg *a)
+{
+	/* Integers use the frontend T-bar range, like the JSON API */
+	if (a->type == 'i')
+		return a->num / (double)TBAR_MAX;
+	return a->num;
+}
+
+static void handle_osc_message(const uint8_t *p, size_t len, uint64_t source, uint64_t now_ns)
+{
+	const char *addr = NULL;
+	const char *types = NULL;
+
+	size_t n = osc_string(p, len, &addr);
+	if (!n) {
+		os_atomic_inc_long(&tbar_udp_stats.invalid);
+		return;
+	}
+	p += n;
+	len -= n;
+
+	n = osc_string(p, len, &types);
+	if (!n || types[0] != ',') {
+		os_atomic_inc_long(&tbar_udp_stats.invalid);
+		return;
+	}
+	p += n;
+	len -= n;
+
+	struct osc_arg args[MAX_OSC_ARGS];
+	int argc = osc_parse_args(types, p, len, args);
+	if (argc < 0) {
+		os_atomic_inc_long(&tbar_udp_stats.invalid);
+		return;
+	}
+
+	if (strcmp(addr, "/tbar/position") == 0) {
+		/* /tbar/position <f|i|d position> [i sequence] */
+		if (argc < 1 || !osc_is_number(&args[0])) {
+			os_atomic_inc_long(&tbar_udp_stats.invalid);
+			return;
+		}
+		if (argc >= 2 && args[1].type == 'i' &&
+		    !sequence_accept(source, (uint32_t)(int32_t)args[1].num, now_ns)) {
+			os_atomic_inc_long(&tbar_udp_stats.dropped_stale);
+			return;
+		}
+		submit(source, osc_position(&args[0]), false, -1.0, now_ns);
+		return;
+	}
+
+	if (strcmp(addr, "/tbar/release") == 0) {
+		/* No argument, T or non-zero = release at the current position.
+		   F or 0 is ignored so momentary buttons (1 on press, 0 on lift) work. */
+		if (argc >= 1) {
+			if (args[0].type == 'F' || (osc_is_number(&args[0]) && args[0].num == 0.0))
+				return;
+		}
+		submit(source, tbar_web_last_position(0), true, -1.0, now_ns);
+		return;
+	}
+
+	os_atomic_inc_long(&tbar_udp_stats.invalid);
+}
+
+static void handle_osc(const uint8_t *p, size_t len, uint64_t source, uint64_t now_ns, int depth)
+{
+	if (len >= 16 && memcmp(p, "#bundle", 8) == 0) {
+		if (depth >= MAX_BUNDLE_DEPTH) {
+			os_atomic_inc_long(&tbar_udp_stats.invalid);
+			return;
+		}
+
+		/* Skip "#bundle\0" and the 8-byte time tag; elements run immediately */
+		p += 16;
+		len -= 16;
+		while (len >= 4) {
+			uint32_t size = rd_u32(p);
+			p += 4;
+			len -= 4;
+			if (size > len || (size & 3)) {
+				os_atomic_inc_long(&tbar_udp_stats.invalid);
+				return;
+			}
+			handle_osc(p, size, source, now_ns, depth + 1);
+			p += size;
+			len -= size;
+		}
+		return;
+	}
+
+	handle_osc_message(p, len, source, now_ns);
+}
+
+void tbar_udp_handle_packet(const uint8_t *data, size_t len, uint64_t source, uint64_t now_ns)
+{
+	os_atomic_inc_long(&tbar_udp_stats.received);
+
+	if (len >= 4 && memcmp(data, "TBAR", 4) == 0) {
+		handle_compact(data, len, source, now_ns);
+		return;
+	}
+	if (len >= 4 && (data[0] == '/' || data[0] == '#') && (len & 3) == 0) {
+		handle_osc(data, len, source, now_ns, 0);
+		return;
+	}
+
+	os_atomic_inc_long(&tbar_udp_stats.invalid);
+}
@@ -0,0 +1,64 @@
+/*
+Plugin Name
+Copyright (C) <Year> <Developer> <Email Address>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Largest datagram the backends read; OSC bundles from panels stay well below */
+#define TBAR_UDP_MAX_PACKET 1536
+
+/* Compact binary packet, all fields big-endian:
+     0  4  magic "TBAR"
+     4  1  version (1 or 2)
+     5  1  flags (bit 0 = release)
+     6  2  reserved
+     8  4  sequence number
+    12  4  position, float32 0..1
+   version 2 only:
+    16  8  sender timestamp, float64 milliseconds (any epoch) */
+#define TBAR_UDP_COMPACT_SIZE 16
+#define TBAR_UDP_COMPACT_VERSION 1
+#define TBAR_UDP_COMPACT_V2_SIZE 24
+#define TBAR_UDP_COMPACT_V2_VERSION 2
+
+struct tbar_udp_stats {
+	volatile long received;
+	volatile long applied;
+	volatile long dropped_stale; /* duplicate or out-of-order sequence number */
+	volatile long invalid;
+};
+
+extern struct tbar_udp_stats tbar_udp_stats;
+
+/* Handles one datagram on the server thread. `source` identifies the sender
+   (address + port) for per-sender sequence tracking. */
+void tbar_udp_handle_packet(const uint8_t *data, size_t len, uint64_t source, uint64_t now_ns);
+
+/* Forgets all per-sender sequence state (server restart) */
+void tbar_udp_reset(void);
+
+#ifdef __cplusplus
+}
+#endif
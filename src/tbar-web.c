@@ -17,87 +17,308 @@ with this program. If not, see <https://www.gnu.org/licenses/>
 */
 
 #include "tbar-web.h"
+#include "tbar-arbiter.h"
+#include "tbar-config.h"
+#include "tbar-fader.h"
+#include "tbar-http.h"
+#include "tbar-jitter.h"
+#include "tbar-json.h"
+#include "tbar-log.h"
+#include "tbar-metrics.h"
+#include "tbar-record.h"
+#include "tbar-server.h"
+#include "tbar-snapshot.h"
+#include "tbar-sse.h"
+#include "tbar-static.h"
+#include "tbar-trajectory.h"
+#include "tbar-udp.h"
+#include "tbar-webroot.h"
+#include "tbar-ws.h"
 
 #include <obs-module.h>
 #include <plugin-support.h>
 #include <obs-data.h>
+#include <util/platform.h>
+#include <util/threading.h>
 
 #ifdef ENABLE_FRONTEND_API
 #include <obs-frontend-api.h>
 #endif
 
-#ifdef _WIN32
-#define WIN32_LEAN_AND_MEAN
-#include <winsock2.h>
-#include <ws2tcpip.h>
-#include <windows.h>
-#include <process.h>
-#pragma comment(lib, "Ws2_32.lib")
-#endif
-
-#include <ctype.h>
+#include <assert.h>
+#include <math.h>
+#include <stdalign.h>
+#include <stddef.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <string.h>
 
 /* OBS frontend T-bar range is integer 0..1023 */
 #define TBAR_MAX 1023
-#define TBAR_CLAMP 10
 
-#if defined(_WIN32) && defined(ENABLE_FRONTEND_API)
-/* Millisecond tick counter used for debounce (portable). */
-static uint64_t g_last_release_tick = 0;
-static bool g_manual_active = false;
-static uint64_t g_last_start_tick = 0;
-static obs_source_t *g_manual_program = NULL;
-static obs_source_t *g_manual_preview = NULL;
+/* ------------------------------ */
+/* Channels                       */
+/* ------------------------------ */
+
+/* Latest-wins slots between the transports, the video tick and the UI thread.
+   The pending update is packed into one long so it can be swapped atomically
+   without a lock (long is 32 bits on Windows):
+     bit 0     release (sticky until consumed)
+     bits 1-30 position in fixed point, 0..MAILBOX_ONE
+   MAILBOX_EMPTY means nothing is pending. */
+#define MAILBOX_EMPTY (-1L)
+#define MAILBOX_ONE (1L << 29)
+
+struct pos_mailbox {
+	volatile long slot;
+	volatile bool task_queued; /* at most one set_pos_task is outstanding */
+	int channel;               /* owner, for set_pos_task */
+};
+
+#define CACHE_LINE 64
+
+/* One T-bar per OBS output channel. Channel 0 is the main output and follows
+   Studio Mode. Any other channel drives the transition set on it towards the
+   scene named in the update; when a move finishes, the scene it left becomes
+   the next target, as Studio Mode swaps program and preview.
+
+   A plain position update touches only the first cache line, from the
+   transport to the video tick; the rest is used when a move starts or ends. */
+struct channel {
+	/* Socket thread and video tick */
+	alignas(CACHE_LINE) struct pos_mailbox input; /* transports -> video tick (or straight to the UI thread) */
+	volatile long live_busy;          /* spinlock around `live`, held for one call */
+	obs_source_t *live;               /* running manual transition; holds a reference */
+	volatile uint64_t last_submit_ns; /* receive time of the newest update, for latency */
+	double requested;                 /* socket thread only: last position received */
+
+	/* UI thread, unless noted; readers use the published snapshot */
+	alignas(CACHE_LINE) struct pos_mailbox ui_input; /* video tick -> UI thread, for starting and releasing */
+	struct tbar_fader fader;
+	obs_source_t *program;
+	obs_source_t *preview;
+
+	/* Where the next move goes on channels other than 0; written by the socket thread */
+	pthread_mutex_t scene_mutex;
+	char next_scene[TBAR_JSON_MAX_SCENE + 1];
+
+	/* Live readback, sampled on the video thread */
+	long live_last;           /* last sample published, packed like the mailbox */
+	volatile bool active;     /* between transition_start and transition_stop */
+	obs_source_t *readback;   /* video thread (or with the tick stopped); holds a reference */
+
+	/* Transports -> video tick when interpolation is on */
+	struct tbar_jitter jitter;
+};
+
+static_assert(offsetof(struct channel, ui_input) == CACHE_LINE, "per-update channel state must fit one cache line");
+
+static struct channel g_channels[TBAR_MAX_CHANNELS];
+/* Bit per channel that has been addressed; the video tick looks at no others */
+static volatile long g_channels_used = 1;
+
+static void channels_init(void)
+{
+	static bool done;
+	if (done)
+		return;
+	done = true;
+
+	for (int i = 0; i < TBAR_MAX_CHANNELS; i++) {
+		struct channel *ch = &g_channels[i];
+		ch->input.slot = MAILBOX_EMPTY;
+		ch->input.channel = i;
+		ch->ui_input.slot = MAILBOX_EMPTY;
+		ch->ui_input.channel = i;
+		ch->live_last = MAILBOX_EMPTY;
+		pthread_mutex_init(&ch->scene_mutex, NULL);
+	}
+}
+
+static void channel_mark_used(int channel)
+{
+	for (;;) {
+		long used = os_atomic_load_long(&g_channels_used);
+		long bit = 1L << channel;
+		if ((used & bit) || os_atomic_compare_swap_long(&g_channels_used, used, used | bit))
+			return;
+	}
+}
+
+#ifdef ENABLE_FRONTEND_API
+/* The holder only keeps the lock for one libobs call, so a short spin usually
+   wins; past that, yield the CPU instead of burning it (the UI thread can be
+   waiting on a tick that was itself preempted). */
+static void live_lock(struct channel *ch)
+{
+	int spins = 0;
+	while (!os_atomic_compare_swap_long(&ch->live_busy, 0, 1)) {
+		if (++spins >= 64) {
+			os_sleep_ms(0);
+			spins = 0;
+		}
+	}
+}
+
+static void live_unlock(struct channel *ch)
+{
+	os_atomic_set_long(&ch->live_busy, 0);
+}
 
+/* The running manual transition, shared with the video tick so plain position
+   updates can be applied there without a round trip through the UI thread.
+   Written by the UI thread; the tick only holds the lock for one call. */
+static void live_set_transition(struct channel *ch, obs_source_t *transition)
+{
+	obs_source_t *ref = transition ? obs_source_get_ref(transition) : NULL;
+
+	live_lock(ch);
+	obs_source_t *old = ch->live;
+	ch->live = ref;
+	live_unlock(ch);
+
+	obs_source_release(old);
+}
+
+/* Millisecond tick counter used for debounce (portable). */
 static uint64_t get_tick64_ms(void)
 {
-	return (uint64_t)GetTickCount64();
+	return os_gettime_ns() / 1000000;
 }
 
-static void manual_clear_state(void)
+static void manual_clear_state(struct channel *ch)
 {
-	if (g_manual_program) {
-		obs_source_release(g_manual_program);
-		g_manual_program = NULL;
+	if (ch->program) {
+		obs_source_release(ch->program);
+		ch->program = NULL;
 	}
-	if (g_manual_preview) {
-		obs_source_release(g_manual_preview);
-		g_manual_preview = NULL;
+	if (ch->preview) {
+		obs_source_release(ch->preview);
+		ch->preview = NULL;
 	}
-	g_manual_active = false;
+	live_set_transition(ch, NULL);
 }
-#endif /* defined(_WIN32) && defined(ENABLE_FRONTEND_API) */
+#endif /* ENABLE_FRONTEND_API */
 
 /* ------------------------------ */
-/* Minimal HTTP server (Windows)  */
+/* Web server state + routes      */
 /* ------------------------------ */
 
-#ifdef _WIN32
-
 static struct {
 	bool running;
-	volatile bool stop;
-	HANDLE thread;
-	SOCKET listen_sock;
 	int port;
-	double last_position; /* last position we applied via POST */
+	int udp_port; /* 0 when the UDP listener is off */
+	bool tick_apply; /* positions are consumed by tick_apply() on the video thread */
+	enum tbar_interp interp; /* jitter buffer in use when not OFF (tick_apply only) */
+	uint64_t jitter_delay_ns;
+	struct tbar_http_limits limits; /* read deadlines and connection cap in effect */
+	enum tbar_lease_mode lease_mode;
+	uint64_t lease_ns;
+	char record_path[512]; /* recording in progress, empty when off */
+	int record_max_mb;
+	char web_root[512]; /* asset directory being served, empty when off */
+	int web_cache_mb;
+	volatile bool state_dirty; /* applied state changed; push to WebSocket clients on next wake */
 } g_srv = {0};
 
 static struct {
 	bool enabled;
 	int port;
+	bool udp_enabled; /* OSC / compact datagram listener */
+	int udp_port;
+	bool tick_apply;
+	enum tbar_interp interpolation;
+	int jitter_delay_ms;
+	int header_timeout_ms;
+	int body_timeout_ms;
+	int max_connections;
+	enum tbar_lease_mode lease_mode; /* multi-controller arbitration */
+	int lease_ms;
+	char record_path[512]; /* session recording, empty = off */
+	int record_max_mb;
+	char web_root[512]; /* custom control surfaces, empty = built-in page only */
+	int web_cache_mb;
 } g_cfg = {
 	.enabled = true,
 	.port = 4455,
+	.udp_enabled = false,
+	.udp_port = 9000,
+	.tick_apply = true,
+	.interpolation = TBAR_INTERP_OFF,
+	.jitter_delay_ms = 50,
+	.header_timeout_ms = 5000,
+	.body_timeout_ms = 5000,
+	.max_connections = TBAR_MAX_CONNS,
+	.lease_mode = TBAR_LEASE_OFF,
+	.lease_ms = 2000,
+	.record_max_mb = 16,
+	.web_cache_mb = 32,
 };
 
+/* Set on the UI thread once the module is shutting down: config tasks still
+   queued from the watcher or from POST /config must not restart the server */
+static bool g_cfg_closing = false;
+
+static const char *interp_name(enum tbar_interp mode)
+{
+	switch (mode) {
+	case TBAR_INTERP_LINEAR:
+		return "linear";
+	case TBAR_INTERP_CATMULL_ROM:
+		return "catmull-rom";
+	default:
+		return "off";
+	}
+}
+
+static enum tbar_interp interp_from_name(const char *name)
+{
+	if (name && strcmp(name, "linear") == 0)
+		return TBAR_INTERP_LINEAR;
+	if (name && strcmp(name, "catmull-rom") == 0)
+		return TBAR_INTERP_CATMULL_ROM;
+	return TBAR_INTERP_OFF;
+}
+
+static const char *lease_mode_name(enum tbar_lease_mode mode)
+{
+	switch (mode) {
+	case TBAR_LEASE_REJECT:
+		return "reject";
+	case TBAR_LEASE_QUEUE:
+		return "queue";
+	default:
+		return "off";
+	}
+}
+
+static enum tbar_lease_mode lease_mode_from_name(const char *name)
+{
+	if (name && strcmp(name, "reject") == 0)
+		return TBAR_LEASE_REJECT;
+	if (name && strcmp(name, "queue") == 0)
+		return TBAR_LEASE_QUEUE;
+	return TBAR_LEASE_OFF;
+}
+
 static void cfg_set_defaults(obs_data_t *data)
 {
 	obs_data_set_default_bool(data, "enabled", true);
 	obs_data_set_default_int(data, "port", 4455);
+	obs_data_set_default_bool(data, "udp_enabled", false);
+	obs_data_set_default_int(data, "udp_port", 9000);
+	obs_data_set_default_bool(data, "tick_apply", true);
+	obs_data_set_default_string(data, "interpolation", "off");
+	obs_data_set_default_int(data, "jitter_delay_ms", 50);
+	obs_data_set_default_int(data, "header_timeout_ms", 5000);
+	obs_data_set_default_int(data, "body_timeout_ms", 5000);
+	obs_data_set_default_int(data, "max_connections", TBAR_MAX_CONNS);
+	obs_data_set_default_string(data, "lease_mode", "off");
+	obs_data_set_default_int(data, "lease_ms", 2000);
+	obs_data_set_default_string(data, "record_path", "");
+	obs_data_set_default_int(data, "record_max_mb", 16);
+	obs_data_set_default_string(data, "web_root", "");
+	obs_data_set_default_int(data, "web_cache_mb", 32);
 }
 
 static const char *cfg_path(void)
@@ -105,13 +326,8 @@ static const char *cfg_path(void)
 	return obs_module_config_path("obs-tbar-web.json");
 }
 
-static void cfg_load(void)
+static void cfg_read(obs_data_t *data)
 {
-	const char *path = cfg_path();
-	obs_data_t *data = obs_data_create_from_json_file_safe(path, "bak");
-	if (!data)
-		data = obs_data_create();
-
 	cfg_set_defaults(data);
 
 	g_cfg.enabled = obs_data_get_bool(data, "enabled");
@@ -119,129 +335,285 @@ static void cfg_load(void)
 	if (g_cfg.port <= 0 || g_cfg.port > 65535)
 		g_cfg.port = 4455;
 
+	g_cfg.udp_enabled = obs_data_get_bool(data, "udp_enabled");
+	g_cfg.udp_port = (int)obs_data_get_int(data, "udp_port");
+	if (g_cfg.udp_port <= 0 || g_cfg.udp_port > 65535)
+		g_cfg.udp_port = 9000;
+
+	g_cfg.tick_apply = obs_data_get_bool(data, "tick_apply");
+	g_cfg.interpolation = interp_from_name(obs_data_get_string(data, "interpolation"));
+	g_cfg.jitter_delay_ms = (int)obs_data_get_int(data, "jitter_delay_ms");
+	if (g_cfg.jitter_delay_ms < 0 || g_cfg.jitter_delay_ms > 500)
+		g_cfg.jitter_delay_ms = 50;
+
+	g_cfg.header_timeout_ms = (int)obs_data_get_int(data, "header_timeout_ms");
+	if (g_cfg.header_timeout_ms < 100 || g_cfg.header_timeout_ms > 60000)
+		g_cfg.header_timeout_ms = 5000;
+	g_cfg.body_timeout_ms = (int)obs_data_get_int(data, "body_timeout_ms");
+	if (g_cfg.body_timeout_ms < 100 || g_cfg.body_timeout_ms > 60000)
+		g_cfg.body_timeout_ms = 5000;
+	g_cfg.max_connections = (int)obs_data_get_int(data, "max_connections");
+	if (g_cfg.max_connections < 1 || g_cfg.max_connections > TBAR_MAX_CONNS)
+		g_cfg.max_connections = TBAR_MAX_CONNS;
+
+	g_cfg.lease_mode = lease_mode_from_name(obs_data_get_string(data, "lease_mode"));
+	g_cfg.lease_ms = (int)obs_data_get_int(data, "lease_ms");
+	if (g_cfg.lease_ms < 100 || g_cfg.lease_ms > 60000)
+		g_cfg.lease_ms = 2000;
+
+	const char *record_path = obs_data_get_string(data, "record_path");
+	snprintf(g_cfg.record_path, sizeof(g_cfg.record_path), "%s", record_path ? record_path : "");
+	g_cfg.record_max_mb = (int)obs_data_get_int(data, "record_max_mb");
+	if (g_cfg.record_max_mb < 1 || g_cfg.record_max_mb > 4096)
+		g_cfg.record_max_mb = 16;
+
+	const char *web_root = obs_data_get_string(data, "web_root");
+	snprintf(g_cfg.web_root, sizeof(g_cfg.web_root), "%s", web_root ? web_root : "");
+	g_cfg.web_cache_mb = (int)obs_data_get_int(data, "web_cache_mb");
+	if (g_cfg.web_cache_mb < 1 || g_cfg.web_cache_mb > 1024)
+		g_cfg.web_cache_mb = 32;
+}
+
+static void cfg_load(void)
+{
+	obs_data_t *data = obs_data_create_from_json_file_safe(cfg_path(), "bak");
+	if (!data)
+		data = obs_data_create();
+	cfg_read(data);
 	obs_data_release(data);
 }
 
+/* Hands a copy to the config writer; the file is written in the background */
 static void cfg_save(void)
 {
-	const char *path = cfg_path();
 	obs_data_t *data = obs_data_create();
 	cfg_set_defaults(data);
 	obs_data_set_bool(data, "enabled", g_cfg.enabled);
 	obs_data_set_int(data, "port", g_cfg.port);
-	obs_data_save_json_pretty_safe(data, path, "tmp", "bak");
-	obs_data_release(data);
+	obs_data_set_bool(data, "udp_enabled", g_cfg.udp_enabled);
+	obs_data_set_int(data, "udp_port", g_cfg.udp_port);
+	obs_data_set_bool(data, "tick_apply", g_cfg.tick_apply);
+	obs_data_set_string(data, "interpolation", interp_name(g_cfg.interpolation));
+	obs_data_set_int(data, "jitter_delay_ms", g_cfg.jitter_delay_ms);
+	obs_data_set_int(data, "header_timeout_ms", g_cfg.header_timeout_ms);
+	obs_data_set_int(data, "body_timeout_ms", g_cfg.body_timeout_ms);
+	obs_data_set_int(data, "max_connections", g_cfg.max_connections);
+	obs_data_set_string(data, "lease_mode", lease_mode_name(g_cfg.lease_mode));
+	obs_data_set_int(data, "lease_ms", g_cfg.lease_ms);
+	obs_data_set_string(data, "record_path", g_cfg.record_path);
+	obs_data_set_int(data, "record_max_mb", g_cfg.record_max_mb);
+	obs_data_set_string(data, "web_root", g_cfg.web_root);
+	obs_data_set_int(data, "web_cache_mb", g_cfg.web_cache_mb);
+	tbar_config_save(data);
+}
+
+/* The socket thread reports the config from the snapshot, never from g_cfg */
+static void cfg_publish(void)
+{
+	struct tbar_snapshot_config *s = &tbar_snapshot_begin()->config;
+	s->enabled = g_cfg.enabled;
+	s->port = g_cfg.port;
+	s->udp_enabled = g_cfg.udp_enabled;
+	s->udp_port = g_cfg.udp_port;
+	s->tick_apply = g_cfg.tick_apply;
+	s->interpolation = g_cfg.interpolation;
+	s->jitter_delay_ms = g_cfg.jitter_delay_ms;
+	s->header_timeout_ms = g_cfg.header_timeout_ms;
+	s->body_timeout_ms = g_cfg.body_timeout_ms;
+	s->max_connections = g_cfg.max_connections;
+	s->lease_mode = g_cfg.lease_mode;
+	s->lease_ms = g_cfg.lease_ms;
+	tbar_snapshot_end();
 }
 
 static void cfg_apply(void)
 {
+	cfg_publish();
 	if (!g_cfg.enabled) {
 		tbar_web_stop();
 		obs_log(LOG_INFO, "tbar-web: disabled via config");
 		return;
 	}
 
-	/* Restart if port changed */
-	if (g_srv.running && g_srv.port != g_cfg.port) {
+	/* Restart if a port, the apply mode, a connection limit, arbitration or recording changed */
+	int udp_port = g_cfg.udp_enabled ? g_cfg.udp_port : 0;
+	if (g_srv.running &&
+	    (g_srv.port != g_cfg.port || g_srv.udp_port != udp_port || g_srv.tick_apply != g_cfg.tick_apply ||
+	     g_srv.interp != g_cfg.interpolation ||
+	     g_srv.jitter_delay_ns != (uint64_t)g_cfg.jitter_delay_ms * 1000000 ||
+	     g_srv.limits.header_timeout_ms != g_cfg.header_timeout_ms ||
+	     g_srv.limits.body_timeout_ms != g_cfg.body_timeout_ms ||
+	     g_srv.limits.max_conns != g_cfg.max_connections || g_srv.lease_mode != g_cfg.lease_mode ||
+	     g_srv.lease_ns != (uint64_t)g_cfg.lease_ms * 1000000 ||
+	     strcmp(g_srv.record_path, g_cfg.record_path) != 0 || g_srv.record_max_mb != g_cfg.record_max_mb ||
+	     strcmp(g_srv.web_root, g_cfg.web_root) != 0 || g_srv.web_cache_mb != g_cfg.web_cache_mb)) {
 		tbar_web_stop();
 	}
 	tbar_web_start(g_cfg.port);
 }
 
-static void cfg_apply_task(void *unused)
+/* POST /config, carried over from the socket thread: g_cfg is only ever
+   written on the UI thread, in order with hot reloads of the file */
+static void cfg_update_task(void *param)
 {
-	(void)unused;
+	obs_data_t *update = param;
+	if (g_cfg_closing) {
+		obs_data_release(update);
+		return;
+	}
+	if (obs_data_has_user_value(update, "enabled"))
+		g_cfg.enabled = obs_data_get_bool(update, "enabled");
+	if (obs_data_has_user_value(update, "port"))
+		g_cfg.port = (int)obs_data_get_int(update, "port");
+	obs_data_release(update);
+	cfg_save();
 	cfg_apply();
 }
 
-static void http_send(SOCKET s, int code, const char *status, const char *content_type, const char *body)
+static void cfg_reload_task(void *param)
 {
-	if (!content_type)
-		content_type = "text/plain; charset=utf-8";
-	if (!body)
-		body = "";
-
-	char headers[512];
-	int body_len = (int)strlen(body);
-	int n = snprintf(headers, sizeof(headers),
-			 "HTTP/1.1 %d %s\r\n"
-			 "Content-Type: %s\r\n"
-			 "Content-Length: %d\r\n"
-			 "Connection: close\r\n"
-			 "Access-Control-Allow-Origin: *\r\n"
-			 "Access-Control-Allow-Headers: Content-Type\r\n"
-			 "Access-Control-Allow-Methods: GET,POST,OPTIONS\r\n"
-			 "\r\n",
-			 code, status, content_type, body_len);
-	if (n > 0) {
-		send(s, headers, n, 0);
-	}
-	if (body_len > 0) {
-		send(s, body, body_len, 0);
+	obs_data_t *data = param;
+	if (g_cfg_closing) {
+		obs_data_release(data);
+		return;
 	}
+	cfg_read(data);
+	obs_data_release(data);
+	cfg_apply();
 }
 
-static int str_case_starts_with(const char *s, const char *prefix)
+/* The config file was edited by hand; called on the watcher thread */
+static void cfg_changed(obs_data_t *data)
 {
-	while (*prefix && *s) {
-		if (tolower((unsigned char)*s) != tolower((unsigned char)*prefix))
-			return 0;
-		s++;
-		prefix++;
-	}
-	return *prefix == '\0';
+	obs_queue_task(OBS_TASK_UI, cfg_reload_task, data, false);
 }
 
-static const char *find_header_value(const char *headers, const char *key)
+/* ------------------------------ */
+/* Events for /events subscribers */
+/* ------------------------------ */
+
+/* Transition events raised on the UI thread, drained in order by the socket
+   thread. If viewers fall this far behind the oldest are overwritten; the
+   state frame that follows still tells them where things stand. */
+#define EVENT_QUEUE_SIZE 16
+
+struct event {
+	const char *name;
+	int channel;
+};
+
+static struct {
+	pthread_mutex_t mutex;
+	struct event events[EVENT_QUEUE_SIZE];
+	int head;
+	int count;
+	volatile bool pending;
+} g_events = {
+	.mutex = PTHREAD_MUTEX_INITIALIZER,
+};
+
+static int take_events(struct event *events, int max)
 {
-	/* Very small header parser: find "Key:" at line start */
-	const char *p = headers;
-	size_t key_len = strlen(key);
+	if (!os_atomic_set_bool(&g_events.pending, false))
+		return 0;
 
-	while (*p) {
-		const char *line = p;
-		const char *eol = strstr(line, "\r\n");
-		if (!eol)
-			break;
+	pthread_mutex_lock(&g_events.mutex);
+	int n = 0;
+	while (g_events.count && n < max) {
+		events[n++] = g_events.events[g_events.head];
+		g_events.head = (g_events.head + 1) % EVENT_QUEUE_SIZE;
+		g_events.count--;
+	}
+	pthread_mutex_unlock(&g_events.mutex);
+	return n;
+}
 
-		if ((size_t)(eol - line) > key_len + 1) {
-			if (str_case_starts_with(line, key) && line[key_len] == ':') {
-				const char *v = line + key_len + 1;
-				while (*v == ' ' || *v == '\t')
-					v++;
-				return v;
-			}
-		}
+/* Copies `src` as the body of a JSON string; control characters are dropped */
+static void json_escape(char *dst, size_t size, const char *src)
+{
+	size_t o = 0;
+	for (; src && *src && o + 2 < size; src++) {
+		unsigned char ch = (unsigned char)*src;
+		if (ch < 0x20)
+			continue;
+		if (ch == '"' || ch == '\\')
+			dst[o++] = '\\';
+		dst[o++] = (char)ch;
+	}
+	dst[o] = '\0';
+}
+
+#ifdef ENABLE_FRONTEND_API
+static void notify_applied(void);
 
-		p = eol + 2;
+static void push_event(int channel, const char *name)
+{
+	pthread_mutex_lock(&g_events.mutex);
+	if (g_events.count == EVENT_QUEUE_SIZE) {
+		g_events.head = (g_events.head + 1) % EVENT_QUEUE_SIZE;
+		g_events.count--;
 	}
-	return NULL;
+	g_events.events[(g_events.head + g_events.count) % EVENT_QUEUE_SIZE] = (struct event){name, channel};
+	g_events.count++;
+	pthread_mutex_unlock(&g_events.mutex);
+
+	os_atomic_set_bool(&g_events.pending, true);
+	notify_applied();
 }
 
-static bool parse_json_position(const char *body, double *out_pos)
+static void source_name(obs_source_t *source, char *dst, size_t size)
 {
-	/* Minimal and forgiving: search for "position" and parse following number */
-	if (!body || !out_pos)
-		return false;
+	/* Pads with zeros, so an unchanged name leaves the snapshot unchanged */
+	strncpy(dst, source ? obs_source_get_name(source) : "", size - 1);
+	obs_source_release(source);
+}
 
-	const char *p = strstr(body, "position");
-	if (!p)
-		return false;
+/* UI thread: frontend events and tbar_web_start() */
+static void refresh_tally(void)
+{
+	bool studio_mode = obs_frontend_preview_program_mode_active();
+	obs_source_t *transition = obs_frontend_get_current_transition();
+	bool fixed = transition && obs_transition_fixed(transition);
+
+	/* Frontend calls stay outside the snapshot lock */
+	char names[3][TBAR_SNAPSHOT_NAME] = {{0}};
+	source_name(transition, names[0], sizeof(names[0]));
+	source_name(obs_frontend_get_current_scene(), names[1], sizeof(names[1]));
+	source_name(studio_mode ? obs_frontend_get_current_preview_scene() : NULL, names[2], sizeof(names[2]));
+
+	struct tbar_snapshot_ui *s = tbar_snapshot_begin();
+	s->studio_mode = studio_mode;
+	s->transition_fixed = fixed;
+	memcpy(s->transition, names[0], sizeof(s->transition));
+	memcpy(s->program, names[1], sizeof(s->program));
+	memcpy(s->preview, names[2], sizeof(s->preview));
+	if (tbar_snapshot_end())
+		notify_applied();
+}
 
-	/* find ':' */
-	p = strchr(p, ':');
-	if (!p)
-		return false;
-	p++;
-	while (*p && isspace((unsigned char)*p))
-		p++;
+static void on_frontend_event(enum obs_frontend_event event, void *unused)
+{
+	(void)unused;
 
-	char *end = NULL;
-	double v = strtod(p, &end);
-	if (end == p)
-		return false;
-	/* Accept either normalized [0..1] or integer [0..1023].
-	   Keep backward compat with older [0..10000] scaling if someone used it. */
+	switch (event) {
+	case OBS_FRONTEND_EVENT_SCENE_CHANGED:
+	case OBS_FRONTEND_EVENT_PREVIEW_SCENE_CHANGED:
+	case OBS_FRONTEND_EVENT_STUDIO_MODE_ENABLED:
+	case OBS_FRONTEND_EVENT_STUDIO_MODE_DISABLED:
+	case OBS_FRONTEND_EVENT_TRANSITION_CHANGED:
+	case OBS_FRONTEND_EVENT_FINISHED_LOADING:
+		refresh_tally();
+		break;
+	default:
+		break;
+	}
+}
+#endif /* ENABLE_FRONTEND_API */
+
+/* Accepts either normalized [0..1] or integer [0..1023]. Keeps backward
+   compat with older [0..10000] scaling if someone used it. */
+static double normalize_position(double v)
+{
 	if (v > 1.0 && v <= (double)TBAR_MAX)
 		v = v / (double)TBAR_MAX;
 	else if (v > 1.0 && v <= 10000.0)
@@ -250,632 +622,1605 @@ static bool parse_json_position(const char *body, double *out_pos)
 		v = 0.0;
 	if (v > 1.0)
 		v = 1.0;
-	*out_pos = v;
-	return true;
+	return v;
 }
 
-static bool parse_json_release(const char *body, bool *out_release)
+/* {"position":..., "release":..., "timestamp":..., "seq":..., "client_id":...}
+   from POST /tbar or a WebSocket text frame. Only `position` is required; the
+   rest stays in `f` for arbitration. */
+static bool position_from_fields(const struct tbar_json_fields *f, double *pos, bool *release, double *sender_ms)
 {
-	if (!body || !out_release)
+	if (!(f->present & TBAR_JSON_POSITION))
 		return false;
 
-	const char *p = strstr(body, "release");
-	if (!p)
-		return false;
+	*pos = normalize_position(f->position);
+	*release = (f->present & TBAR_JSON_RELEASE) && f->release;
+	/* Optional controller timestamp in milliseconds, used by the jitter buffer */
+	*sender_ms = (f->present & TBAR_JSON_TIMESTAMP) && f->timestamp >= 0.0 ? f->timestamp : -1.0;
+	return true;
+}
 
-	p = strchr(p, ':');
-	if (!p)
-		return false;
-	p++;
-	while (*p && isspace((unsigned char)*p))
-		p++;
+static bool parse_position_json(const char *json, size_t len, struct tbar_json_fields *f, double *pos, bool *release,
+				double *sender_ms)
+{
+	return tbar_json_extract(json, len, f) && position_from_fields(f, pos, release, sender_ms);
+}
 
-	if (str_case_starts_with(p, "true")) {
-		*out_release = true;
-		return true;
+/* Runs arbitration for an update; when it is not accepted, fills `resp` with
+   the reply for the controller and returns the HTTP status for it. */
+static int arbitrate(int channel, const struct tbar_json_fields *f, bool release, char *resp, size_t size)
+{
+	struct tbar_arbiter_result res =
+		tbar_arbiter_check(channel, f && (f->present & TBAR_JSON_CLIENT_ID) ? f->client_id : NULL,
+				   f && (f->present & TBAR_JSON_SEQ), f ? f->seq : 0, release, os_gettime_ns());
+	if (res.verdict == TBAR_ARBITER_ACCEPT)
+		return 200;
+	if (res.verdict == TBAR_ARBITER_STALE) {
+		snprintf(resp, size, "{\"error\":\"stale_seq\"}");
+		return 409;
 	}
-	if (str_case_starts_with(p, "false")) {
-		*out_release = false;
-		return true;
+
+	char owner[2 * TBAR_ARBITER_MAX_CLIENT_ID + 1];
+	json_escape(owner, sizeof(owner), res.owner);
+	if (res.verdict == TBAR_ARBITER_QUEUED) {
+		snprintf(resp, size, "{\"queued\":true,\"queue_position\":%d,\"owner\":\"%s\"}", res.queue_pos, owner);
+		return 202;
 	}
+	snprintf(resp, size, "{\"error\":\"not_owner\",\"owner\":\"%s\"}", owner);
+	return 409;
+}
 
-	return false;
+#ifdef ENABLE_FRONTEND_API
+/* The scenes a move on `ch` goes between, with references held */
+static void channel_get_scenes(struct channel *ch, obs_source_t *transition)
+{
+	if (ch->input.channel == 0) {
+		ch->program = obs_frontend_get_current_scene();
+		ch->preview = obs_frontend_get_current_preview_scene();
+		return;
+	}
+
+	ch->program = obs_transition_get_active_source(transition);
+	pthread_mutex_lock(&ch->scene_mutex);
+	ch->preview = ch->next_scene[0] ? obs_get_source_by_name(ch->next_scene) : NULL;
+	pthread_mutex_unlock(&ch->scene_mutex);
 }
 
-struct set_pos_task_data {
-	double pos;
-	bool release;
-};
+/* After a move on a channel other than 0, the next one goes back */
+static void channel_swap_scenes(struct channel *ch)
+{
+	pthread_mutex_lock(&ch->scene_mutex);
+	snprintf(ch->next_scene, sizeof(ch->next_scene), "%s", obs_source_get_name(ch->program));
+	pthread_mutex_unlock(&ch->scene_mutex);
+}
 
-static void set_pos_task(void *param)
+/* Fixed transition released at max on a channel other than 0 */
+static void channel_cut(struct channel *ch, obs_source_t *transition)
 {
-	struct set_pos_task_data *d = param;
-#ifdef ENABLE_FRONTEND_API
-	/* Clamp */
-	double t = d->pos;
-	if (t < 0.0)
-		t = 0.0;
-	if (t > 1.0)
-		t = 1.0;
-#ifdef _WIN32
-	g_srv.last_position = t;
+	manual_clear_state(ch);
+	channel_get_scenes(ch, transition);
+	if (ch->program && ch->preview && ch->program != ch->preview &&
+	    obs_transition_start(transition, OBS_TRANSITION_MODE_AUTO, 0, ch->preview))
+		channel_swap_scenes(ch);
+}
 #endif
 
-	/* Only meaningful in Studio Mode */
-	if (!obs_frontend_preview_program_mode_active()) {
-		obs_log(LOG_INFO, "tbar-web: ignored (not in Studio Mode)");
-		free(d);
-		return;
-	}
-
-	obs_source_t *transition = obs_get_output_source(0);
-	if (!transition) {
-		obs_log(LOG_WARNING, "tbar-web: no transition output source");
-		free(d);
-		return;
-	}
-
-	/* Some transitions (e.g. Cut) are fixed/instant and can't be driven manually. */
-	const bool fixed = obs_transition_fixed(transition);
-
-	/* Start a manual transition the first time we move away from 0. */
-	if (!g_manual_active && t > 0.0f) {
-		uint64_t now = get_tick64_ms();
-		if (now - g_last_start_tick > 250) {
-			g_last_start_tick = now;
-
-			manual_clear_state();
-			g_manual_program = obs_frontend_get_current_scene();
-			g_manual_preview = obs_frontend_get_current_preview_scene();
-
-			if (!g_manual_program || !g_manual_preview) {
-				obs_log(LOG_WARNING, "tbar-web: missing program/preview scene");
-				manual_clear_state();
-			} else if (g_manual_program == g_manual_preview) {
-				obs_log(LOG_INFO, "tbar-web: program == preview (nothing to transition)");
-				manual_clear_state();
-			} else if (fixed) {
-				/* For fixed transitions, we don't start manual. We'll trigger on release at max. */
-				obs_log(LOG_INFO, "tbar-web: current transition is fixed; manual tbar disabled (will trigger on release)");
-				manual_clear_state();
-			} else {
-				/* duration_ms is required; manual mode uses manual_time for progress */
-				uint32_t dur = (uint32_t)obs_frontend_get_transition_duration();
-				if (dur < 50)
-					dur = 300;
-
-				bool ok = obs_transition_start(transition, OBS_TRANSITION_MODE_MANUAL, dur, g_manual_preview);
-				if (ok) {
-					g_manual_active = true;
-					obs_log(LOG_INFO, "tbar-web: manual transition started");
-				} else {
-					obs_log(LOG_WARNING, "tbar-web: failed to start manual transition");
-					manual_clear_state();
-				}
-			}
+#ifdef ENABLE_FRONTEND_API
+/* tbar_fader backend for one channel's OBS transition */
+struct fader_obs {
+	struct channel *ch;
+	obs_source_t *transition;
+};
+
+static unsigned fader_begin(void *ctx, bool *fixed)
+{
+	struct fader_obs *f = ctx;
+
+	/* The main output is only meaningful in Studio Mode */
+	if (f->ch->input.channel == 0 && !obs_frontend_preview_program_mode_active())
+		return TBAR_FADER_IGNORED;
+
+	f->transition = obs_get_output_source((uint32_t)f->ch->input.channel);
+	if (!f->transition)
+		return TBAR_FADER_NO_TRANSITION;
+	/* Some transitions (e.g. Cut) are fixed/instant and can't be driven manually */
+	*fixed = obs_transition_fixed(f->transition);
+	return 0;
+}
+
+static unsigned fader_load_scenes(void *ctx)
+{
+	struct fader_obs *f = ctx;
+	channel_get_scenes(f->ch, f->transition);
+	if (!f->ch->program || !f->ch->preview)
+		return TBAR_FADER_NO_SCENES;
+	return f->ch->program == f->ch->preview ? TBAR_FADER_SAME_SCENE : 0;
+}
+
+static bool fader_start(void *ctx)
+{
+	struct fader_obs *f = ctx;
+
+	/* duration_ms is required; manual mode uses manual_time for progress */
+	uint32_t dur = (uint32_t)obs_frontend_get_transition_duration();
+	if (dur < 50)
+		dur = 300;
+	if (!obs_transition_start(f->transition, OBS_TRANSITION_MODE_MANUAL, dur, f->ch->preview))
+		return false;
+	live_set_transition(f->ch, f->transition);
+	return true;
+}
+
+static void fader_set_time(void *ctx, double t)
+{
+	struct fader_obs *f = ctx;
+	obs_transition_set_manual_time(f->transition, (float)t);
+}
+
+static void fader_finish(void *ctx)
+{
+	struct fader_obs *f = ctx;
+	struct channel *ch = f->ch;
+
+	obs_transition_set_manual_time(f->transition, 1.0f);
+	/* Commit swap in Studio Mode: program becomes old preview; preview becomes old program */
+	if (ch->preview && ch->program) {
+		if (ch->input.channel == 0) {
+			obs_frontend_set_current_scene(ch->preview);
+			obs_frontend_set_current_preview_scene(ch->program);
+		} else {
+			channel_swap_scenes(ch);
 		}
 	}
+}
 
-	/* Drive the transition */
-	if (g_manual_active)
-		obs_transition_set_manual_time(transition, (float)t);
+static void fader_cancel(void *ctx)
+{
+	struct fader_obs *f = ctx;
 
-	/* Optional release: finish (near 1) or cancel (near 0) and reset state */
-	if (d->release) {
-		uint64_t now = get_tick64_ms();
-		if (now - g_last_release_tick < 250) {
-			obs_log(LOG_INFO, "tbar-web: release ignored (debounce)");
-		} else {
-			g_last_release_tick = now;
+	obs_transition_set_manual_time(f->transition, 0.0f);
+	obs_transition_force_stop(f->transition);
+	/* Stopping leaves the destination showing; outside Studio Mode nothing puts it back */
+	if (f->ch->input.channel != 0 && f->ch->program)
+		obs_transition_set(f->transition, f->ch->program);
+}
 
-			const double t_finish = (double)(TBAR_MAX - TBAR_CLAMP) / (double)TBAR_MAX;
-			const double t_cancel = (double)TBAR_CLAMP / (double)TBAR_MAX;
+static void fader_cut(void *ctx)
+{
+	struct fader_obs *f = ctx;
 
-			if (fixed && t >= t_finish) {
-				/* Cut/etc: do an actual program transition via frontend */
-				obs_frontend_preview_program_trigger_transition();
-				obs_log(LOG_INFO, "tbar-web: fixed transition trigger");
-#ifdef _WIN32
-				g_srv.last_position = 0.0;
-#endif
-				manual_clear_state();
-			} else if (g_manual_active && t >= t_finish) {
-				obs_transition_set_manual_time(transition, 1.0f);
-				/* Commit swap in Studio Mode: program becomes old preview; preview becomes old program */
-				if (g_manual_preview && g_manual_program) {
-					obs_frontend_set_current_scene(g_manual_preview);
-					obs_frontend_set_current_preview_scene(g_manual_program);
-				}
-				obs_log(LOG_INFO, "tbar-web: manual transition finish+swap");
-#ifdef _WIN32
-				g_srv.last_position = 0.0;
-#endif
-				manual_clear_state();
-			} else if (g_manual_active && t <= t_cancel) {
-				obs_transition_set_manual_time(transition, 0.0f);
-				obs_transition_force_stop(transition);
-				obs_log(LOG_INFO, "tbar-web: manual transition cancel");
-#ifdef _WIN32
-				g_srv.last_position = 0.0;
+	/* Cut/etc: do an actual program transition via frontend */
+	if (f->ch->input.channel == 0)
+		obs_frontend_preview_program_trigger_transition();
+	else
+		channel_cut(f->ch, f->transition);
+}
+
+static void fader_clear(void *ctx)
+{
+	struct fader_obs *f = ctx;
+	manual_clear_state(f->ch);
+}
+
+static void fader_end(void *ctx)
+{
+	struct fader_obs *f = ctx;
+	obs_source_release(f->transition);
+}
+
+static const struct tbar_fader_backend g_fader_obs = {
+	.begin = fader_begin,
+	.load_scenes = fader_load_scenes,
+	.start = fader_start,
+	.set_time = fader_set_time,
+	.finish = fader_finish,
+	.cancel = fader_cancel,
+	.cut = fader_cut,
+	.clear = fader_clear,
+	.end = fader_end,
+};
 #endif
-				manual_clear_state();
-			}
-		}
-	}
 
-	obs_source_release(transition);
+/* UI thread. Returns where the fader is left: `pos`, or 0 once a release has
+   finished or cancelled the move. Logs through TBAR_LOG, as a controller can
+   hit the same message on every update. */
+static double apply_position(struct channel *ch, double pos, bool release)
+{
+#ifdef ENABLE_FRONTEND_API
+	const int channel = ch->input.channel;
+	struct fader_obs ctx = {.ch = ch};
+	double t;
+	unsigned flags = tbar_fader_update(&ch->fader, &g_fader_obs, &ctx, pos, release, get_tick64_ms(), &t);
+
+	if (flags & TBAR_FADER_IGNORED)
+		TBAR_LOG(LOG_INFO, "tbar-web: ignored (not in Studio Mode)");
+	if (flags & TBAR_FADER_NO_TRANSITION)
+		TBAR_LOG(LOG_WARNING, "tbar-web: no transition output source on channel %d", channel);
+	if (flags & TBAR_FADER_NO_SCENES)
+		TBAR_LOG(LOG_WARNING, "tbar-web: missing program/preview scene on channel %d", channel);
+	if (flags & TBAR_FADER_SAME_SCENE)
+		TBAR_LOG(LOG_INFO, "tbar-web: program == preview (nothing to transition)");
+	if (flags & TBAR_FADER_FIXED)
+		TBAR_LOG(LOG_INFO,
+			 "tbar-web: current transition is fixed; manual tbar disabled (will trigger on release)");
+	if (flags & TBAR_FADER_START_FAILED)
+		TBAR_LOG(LOG_WARNING, "tbar-web: failed to start manual transition");
+	if (flags & TBAR_FADER_STARTED) {
+		tbar_metrics_add(TBAR_THREAD_UI, TBAR_COUNTER_MANUAL_START, 1);
+		push_event(channel, "start");
+		TBAR_LOG(LOG_INFO, "tbar-web: manual transition started on channel %d", channel);
+	}
+	if (flags & TBAR_FADER_DEBOUNCED)
+		TBAR_LOG(LOG_INFO, "tbar-web: release ignored (debounce)");
+	if (flags & TBAR_FADER_CUT) {
+		tbar_metrics_add(TBAR_THREAD_UI, TBAR_COUNTER_FIXED_TRIGGER, 1);
+		push_event(channel, "fixed_trigger");
+		TBAR_LOG(LOG_INFO, "tbar-web: fixed transition trigger on channel %d", channel);
+	}
+	if (flags & TBAR_FADER_FINISHED) {
+		tbar_metrics_add(TBAR_THREAD_UI, TBAR_COUNTER_MANUAL_FINISH, 1);
+		push_event(channel, "finish");
+		TBAR_LOG(LOG_INFO, "tbar-web: manual transition finish+swap on channel %d", channel);
+	}
+	if (flags & TBAR_FADER_CANCELLED) {
+		tbar_metrics_add(TBAR_THREAD_UI, TBAR_COUNTER_MANUAL_CANCEL, 1);
+		push_event(channel, "cancel");
+		TBAR_LOG(LOG_INFO, "tbar-web: manual transition cancel on channel %d", channel);
+	}
+	return t;
 #else
-	(void)d;
+	(void)ch;
+	(void)release;
+	return pos;
 #endif
-	free(d);
-}
-
-static void handle_request(SOCKET s, const char *req, const char *body, int body_len)
-{
-	(void)body_len;
-
-	char method[16] = {0};
-	char path[256] = {0};
-
-	if (sscanf(req, "%15s %255s", method, path) != 2) {
-		http_send(s, 400, "Bad Request", "text/plain; charset=utf-8", "bad request");
-		return;
-	}
-
-	if (strcmp(method, "OPTIONS") == 0) {
-		http_send(s, 204, "No Content", NULL, "");
-		return;
-	}
-
-	if (strcmp(path, "/favicon.ico") == 0) {
-		http_send(s, 204, "No Content", NULL, "");
-		return;
-	}
-
-	if (strcmp(method, "GET") == 0 && (strcmp(path, "/") == 0 || strcmp(path, "/index.html") == 0)) {
-		const char *html =
-			"<!doctype html>\n"
-			"<html lang=\"en\">\n"
-			"<head>\n"
-			"  <meta charset=\"utf-8\" />\n"
-			"  <meta name=\"viewport\" content=\"width=device-width, initial-scale=1\" />\n"
-			"  <title>OBS T-bar test</title>\n"
-			"  <style>\n"
-			"    :root { color-scheme: dark; }\n"
-			"    body { margin: 0; font-family: system-ui, -apple-system, Segoe UI, Roboto, Arial; background:#0b0f14; color:#e8eef7; }\n"
-			"    .wrap { max-width: 760px; margin: 40px auto; padding: 0 16px; }\n"
-			"    .card { background:#121a24; border:1px solid #223247; border-radius: 14px; padding: 18px; }\n"
-			"    h1 { font-size: 18px; margin: 0 0 12px; }\n"
-			"    .row { display:flex; align-items:center; gap: 12px; }\n"
-			"    input[type=range] { width: 100%; }\n"
-			"    .mono { font-family: ui-monospace, SFMono-Regular, Menlo, Consolas, monospace; opacity: .9; }\n"
-			"    .muted { opacity: .75; font-size: 13px; margin-top: 10px; }\n"
-			"    .ok { color:#6ee7b7; }\n"
-			"    .bad { color:#fca5a5; }\n"
-			"    button { background:#1b2a3d; color:#e8eef7; border:1px solid #2c425f; border-radius: 10px; padding: 8px 10px; cursor:pointer; }\n"
-			"    button:hover { background:#22324a; }\n"
-			"    label { user-select: none; }\n"
-			"    input[type=number] { width: 110px; background:#0b0f14; color:#e8eef7; border:1px solid #2c425f; border-radius: 10px; padding: 6px 8px; }\n"
-			"    input[type=checkbox] { transform: scale(1.1); }\n"
-			"    .hr { height:1px; background:#223247; margin: 14px 0; }\n"
-			"  </style>\n"
-			"</head>\n"
-			"<body>\n"
-			"  <div class=\"wrap\">\n"
-			"    <div class=\"card\">\n"
-			"      <h1>OBS T-bar test</h1>\n"
-			"      <div class=\"row\">\n"
-			"        <input id=\"slider\" type=\"range\" min=\"0\" max=\"1023\" step=\"1\" value=\"0\" />\n"
-			"        <div class=\"mono\" style=\"min-width: 120px; text-align:right;\">\n"
-			"          <div><span id=\"pct\">0.0</span>%</div>\n"
-			"          <div style=\"opacity:.7\">(<span id=\"raw\">0</span>)</div>\n"
-			"        </div>\n"
-			"      </div>\n"
-			"      <div class=\"row\" style=\"margin-top: 12px; justify-content: space-between;\">\n"
-			"        <div class=\"mono\">Status: <span id=\"status\" class=\"muted\">—</span></div>\n"
-			"        <div class=\"row\">\n"
-			"          <button id=\"btn0\" type=\"button\">0%</button>\n"
-			"          <button id=\"btn50\" type=\"button\">50%</button>\n"
-			"          <button id=\"btn100\" type=\"button\">100%</button>\n"
-			"        </div>\n"
-			"      </div>\n"
-			"      <div class=\"muted\">\n"
-			"        Tip: keep OBS in Studio Mode while testing. This page sends POST <span class=\"mono\">/tbar</span>.\n"
-			"      </div>\n"
-			"      <div class=\"hr\"></div>\n"
-			"      <div class=\"row\" style=\"justify-content: space-between; align-items: flex-start; gap: 16px;\">\n"
-			"        <div>\n"
-			"          <div class=\"mono\" style=\"margin-bottom: 6px;\">Settings</div>\n"
-			"          <div class=\"row\" style=\"gap:10px; flex-wrap: wrap;\">\n"
-			"            <label class=\"row\" style=\"gap:8px;\"><input id=\"cfgEnabled\" type=\"checkbox\" /> enabled</label>\n"
-			"            <label class=\"row\" style=\"gap:8px;\">port <input id=\"cfgPort\" type=\"number\" min=\"1\" max=\"65535\" /></label>\n"
-			"            <button id=\"cfgSave\" type=\"button\">Save</button>\n"
-			"          </div>\n"
-			"          <div class=\"muted\" id=\"cfgHint\"></div>\n"
-			"        </div>\n"
-			"        <div class=\"mono\" style=\"text-align:right; opacity:.8;\">\n"
-			"          <div>GET <span class=\"mono\">/config</span></div>\n"
-			"          <div>POST <span class=\"mono\">/config</span></div>\n"
-			"        </div>\n"
-			"      </div>\n"
-			"    </div>\n"
-			"  </div>\n"
-			"\n"
-			"  <script>\n"
-			"    const slider = document.getElementById('slider');\n"
-			"    const pct = document.getElementById('pct');\n"
-			"    const raw = document.getElementById('raw');\n"
-			"    const status = document.getElementById('status');\n"
-			"    const cfgEnabled = document.getElementById('cfgEnabled');\n"
-			"    const cfgPort = document.getElementById('cfgPort');\n"
-			"    const cfgSave = document.getElementById('cfgSave');\n"
-			"    const cfgHint = document.getElementById('cfgHint');\n"
-			"\n"
-			"    function setUi(v) {\n"
-			"      const n = Number(v);\n"
-			"      raw.textContent = String(n);\n"
-			"      pct.textContent = (n / 1023 * 100).toFixed(1);\n"
-			"    }\n"
-			"\n"
-			"    function setStatus(ok, text) {\n"
-			"      status.textContent = text;\n"
-			"      status.className = ok ? 'ok mono' : 'bad mono';\n"
-			"    }\n"
-			"\n"
-			"    function setCfgHint(ok, text) {\n"
-			"      cfgHint.textContent = text || '';\n"
-			"      cfgHint.className = ok ? 'muted ok' : 'muted bad';\n"
-			"    }\n"
-			"\n"
-			"    let inflight = false;\n"
-			"    let pending = null;\n"
-			"    let paused = false;\n"
-			"    let released = false;\n"
-			"    let releaseInFlight = false;\n"
-			"\n"
-			"    async function waitForIdle() {\n"
-			"      while (inflight) {\n"
-			"        await new Promise(r => setTimeout(r, 10));\n"
-			"      }\n"
-			"    }\n"
-			"\n"
-			"    async function send(v) {\n"
-			"      if (paused) return;\n"
-			"      pending = v;\n"
-			"      if (inflight) return;\n"
-			"      inflight = true;\n"
-			"      while (pending !== null && !paused) {\n"
-			"        const cur = pending;\n"
-			"        pending = null;\n"
-			"        try {\n"
-			"          const position = cur / 1023;\n"
-			"          const r = await fetch('/tbar', {\n"
-			"            method: 'POST',\n"
-			"            headers: { 'Content-Type': 'application/json' },\n"
-			"            body: JSON.stringify({ position })\n"
-			"          });\n"
-			"          if (!r.ok) throw new Error('HTTP ' + r.status);\n"
-			"          setStatus(true, 'OK');\n"
-			"        } catch (e) {\n"
-			"          setStatus(false, String(e));\n"
-			"        }\n"
-			"      }\n"
-			"      inflight = false;\n"
-			"    }\n"
-			"\n"
-			"    async function releaseIfAtMax() {\n"
-			"      const v = Number(slider.value);\n"
-			"      const max = Number(slider.max);\n"
-			"      const clamp = 10;\n"
-			"      if (v < (max - clamp)) return;\n"
-			"      if (released || releaseInFlight) return;\n"
-			"      try {\n"
-			"        releaseInFlight = true;\n"
-			"        // Stop sending new position updates; wait for the last in-flight POST to finish.\n"
-			"        paused = true;\n"
-			"        pending = null;\n"
-			"        await waitForIdle();\n"
-			"        const r = await fetch('/tbar', {\n"
-			"          method: 'POST',\n"
-			"          headers: { 'Content-Type': 'application/json' },\n"
-			"          body: JSON.stringify({ position: 1.0, release: true })\n"
-			"        });\n"
-			"        if (!r.ok) throw new Error('HTTP ' + r.status);\n"
-			"        released = true;\n"
-			"        // Reset UI, then after a short delay reset OBS tbar to 0 so next run starts clean.\n"
-			"        slider.value = 0;\n"
-			"        setUi(0);\n"
-			"        setStatus(true, 'release');\n"
-			"      } catch (e) {\n"
-			"        setStatus(false, 'release: ' + String(e));\n"
-			"      } finally {\n"
-			"        releaseInFlight = false;\n"
-			"        paused = false;\n"
-			"      }\n"
-			"    }\n"
-			"\n"
-			"    slider.addEventListener('input', () => {\n"
-			"      const v = Number(slider.value);\n"
-			"      if (v < (Number(slider.max) - 10)) released = false;\n"
-			"      setUi(v);\n"
-			"      send(v);\n"
-			"    });\n"
-			"\n"
-			"    slider.addEventListener('pointerup', releaseIfAtMax);\n"
-			"\n"
-			"    document.getElementById('btn0').onclick = () => { slider.value = 0; slider.dispatchEvent(new Event('input')); };\n"
-			"    document.getElementById('btn50').onclick = () => { slider.value = 512; slider.dispatchEvent(new Event('input')); };\n"
-			"    document.getElementById('btn100').onclick = () => { slider.value = 1023; slider.dispatchEvent(new Event('input')); releaseIfAtMax(); };\n"
-			"\n"
-			"    (async function init() {\n"
-			"      try {\n"
-			"        const rc = await fetch('/config');\n"
-			"        if (rc.ok) {\n"
-			"          const c = await rc.json();\n"
-			"          cfgEnabled.checked = !!c.enabled;\n"
-			"          cfgPort.value = String(c.port || 4455);\n"
-			"          setCfgHint(true, '');\n"
-			"        }\n"
-			"        cfgSave.onclick = async () => {\n"
-			"          try {\n"
-			"            const newPort = Number(cfgPort.value);\n"
-			"            const payload = { enabled: !!cfgEnabled.checked, port: newPort };\n"
-			"            const r = await fetch('/config', { method: 'POST', headers: { 'Content-Type': 'application/json' }, body: JSON.stringify(payload) });\n"
-			"            if (!r.ok) throw new Error('HTTP ' + r.status);\n"
-			"            const j = await r.json();\n"
-			"            if (j.port && j.port != location.port) {\n"
-			"              setCfgHint(true, 'Port changed. Open: http://127.0.0.1:' + j.port + '/');\n"
-			"            } else {\n"
-			"              setCfgHint(true, 'Saved');\n"
-			"            }\n"
-			"          } catch (e) {\n"
-			"            setCfgHint(false, String(e));\n"
-			"          }\n"
-			"        };\n"
-			"\n"
-			"        const r = await fetch('/tbar');\n"
-			"        if (r.ok) {\n"
-			"          const j = await r.json();\n"
-			"          const v = Math.round((Number(j.position) || 0) * 1023);\n"
-			"          slider.value = v;\n"
-			"          setUi(v);\n"
-			"          setStatus(true, 'ready');\n"
-			"        }\n"
-			"      } catch (_) {}\n"
-			"    })();\n"
-			"  </script>\n"
-			"</body>\n"
-			"</html>\n";
-
-		http_send(s, 200, "OK", "text/html; charset=utf-8", html);
-		return;
-	}
-
-	if (strcmp(path, "/config") == 0) {
-		if (strcmp(method, "GET") == 0) {
-			char resp[128];
-			snprintf(resp, sizeof(resp), "{\"enabled\":%s,\"port\":%d}",
-				 g_cfg.enabled ? "true" : "false", g_cfg.port);
-			http_send(s, 200, "OK", "application/json; charset=utf-8", resp);
-			return;
-		}
+}
 
-		if (strcmp(method, "POST") == 0) {
-			/* Minimal parsing: { "enabled": true/false, "port": 4455 } */
-			bool enabled = g_cfg.enabled;
-			int port = g_cfg.port;
-
-			const char *p_enabled = strstr(body, "enabled");
-			if (p_enabled) {
-				const char *c = strchr(p_enabled, ':');
-				if (c) {
-					c++;
-					while (*c && isspace((unsigned char)*c))
-						c++;
-					if (str_case_starts_with(c, "true"))
-						enabled = true;
-					else if (str_case_starts_with(c, "false"))
-						enabled = false;
-				}
-			}
+/* ------------------------------ */
+/* Position mailbox               */
+/* ------------------------------ */
 
-			const char *p_port = strstr(body, "port");
-			if (p_port) {
-				const char *c = strchr(p_port, ':');
-				if (c) {
-					c++;
-					while (*c && isspace((unsigned char)*c))
-						c++;
-					int v = atoi(c);
-					if (v > 0 && v <= 65535)
-						port = v;
-				}
-			}
+static struct {
+	volatile long submitted;
+	volatile long coalesced; /* overwritten before a consumer saw them */
+} g_updates;
 
-			g_cfg.enabled = enabled;
-			g_cfg.port = port;
-			cfg_save();
+static long mailbox_encode(double pos, bool release)
+{
+	return (long)(pos * (double)MAILBOX_ONE + 0.5) << 1 | (release ? 1L : 0L);
+}
 
-			/* Apply asynchronously; we can't stop/restart server on the server thread. */
-			obs_queue_task(OBS_TASK_UI, cfg_apply_task, NULL, false);
+static double mailbox_position(long v)
+{
+	return (double)(v >> 1) / (double)MAILBOX_ONE;
+}
 
-			char resp[128];
-			snprintf(resp, sizeof(resp), "{\"ok\":true,\"enabled\":%s,\"port\":%d}",
-				 g_cfg.enabled ? "true" : "false", g_cfg.port);
-			http_send(s, 200, "OK", "application/json; charset=utf-8", resp);
+static void mailbox_put(struct pos_mailbox *box, long v)
+{
+	for (;;) {
+		long old = os_atomic_load_long(&box->slot);
+		/* A pending release is not lost when newer positions overtake it */
+		long next = old != MAILBOX_EMPTY ? v | (old & 1) : v;
+		if (os_atomic_compare_swap_long(&box->slot, old, next)) {
+			if (old != MAILBOX_EMPTY)
+				os_atomic_inc_long(&g_updates.coalesced);
 			return;
 		}
+	}
+}
 
-		http_send(s, 405, "Method Not Allowed", "application/json; charset=utf-8",
-			  "{\"error\":\"method_not_allowed\"}");
+static long mailbox_take(struct pos_mailbox *box)
+{
+	return os_atomic_exchange_long(&box->slot, MAILBOX_EMPTY);
+}
+
+static void notify_applied(void)
+{
+	/* Let the socket thread push the applied state to WebSocket and SSE clients */
+	os_atomic_set_bool(&g_srv.state_dirty, true);
+	if (g_srv.running)
+		tbar_server_wake();
+}
+
+static void set_pos_task(void *param)
+{
+	struct pos_mailbox *box = param;
+	struct channel *ch = &g_channels[box->channel];
+
+	/* Clear the flag before taking the slot: a value stored after the take
+	   then always finds the flag clear and queues a new task. */
+	os_atomic_set_bool(&box->task_queued, false);
+	long v = mailbox_take(box);
+	if (v == MAILBOX_EMPTY)
 		return;
-	}
 
-	if (strcmp(path, "/status") == 0) {
-		if (strcmp(method, "GET") == 0) {
-			const char *manual_active_str = "false";
+	uint64_t start_ns = os_gettime_ns();
+	uint64_t recv_ns = ch->last_submit_ns;
+	tbar_metrics_observe(TBAR_THREAD_UI, TBAR_HIST_APPLY_LATENCY, start_ns - recv_ns);
+
+	double pos = apply_position(ch, mailbox_position(v), (v & 1) != 0);
+
+	struct tbar_snapshot_ui *s = tbar_snapshot_begin();
+	s->channels[box->channel].position = pos;
+	s->channels[box->channel].position_ns = os_gettime_ns();
+	s->channels[box->channel].manual_active = ch->fader.manual_active;
+	s->applied++;
+	tbar_snapshot_end();
+	notify_applied();
+	tbar_record_apply(box->channel, TBAR_SOURCE_NONE, TBAR_THREAD_UI, recv_ns, start_ns, mailbox_position(v),
+			  (v & 1) != 0);
+
+	tbar_metrics_observe(TBAR_THREAD_UI, TBAR_HIST_UI_TASK, os_gettime_ns() - start_ns);
+}
+
+static void queue_ui_apply(struct pos_mailbox *box, long v)
+{
+	mailbox_put(box, v);
+	/* Frontend calls must stay on the UI thread */
+	if (!os_atomic_exchange_bool(&box->task_queued, true))
+		obs_queue_task(OBS_TASK_UI, set_pos_task, box, false);
+}
+
+/* Changes made by the video tick, published together at the end of the frame */
+static struct {
+	long applied; /* channel bits */
+	double position[TBAR_MAX_CHANNELS];
+	uint64_t count;
+	long sampled; /* channel bits with a new readback sample */
+} g_frame;
+
+/* On the OBS video thread: plain position updates for a running manual
+   transition are applied right here, in step with rendering; starting and
+   releasing need the frontend API and are passed on to the UI thread.
+   `submitted` is false for positions generated on the tick itself. */
+static void apply_on_tick(struct channel *ch, long v, bool submitted)
+{
 #ifdef ENABLE_FRONTEND_API
-			manual_active_str = g_manual_active ? "true" : "false";
-#endif
-			char resp[256];
-			snprintf(resp, sizeof(resp),
-				 "{\"ok\":true,\"enabled\":%s,\"port\":%d,\"manual_active\":%s,\"last_position\":%.6f}",
-				 g_cfg.enabled ? "true" : "false", g_cfg.port, manual_active_str, g_srv.last_position);
-			http_send(s, 200, "OK", "application/json; charset=utf-8", resp);
+	if (!(v & 1)) {
+		live_lock(ch);
+		obs_source_t *transition = ch->live;
+		if (transition)
+			obs_transition_set_manual_time(transition, (float)mailbox_position(v));
+		live_unlock(ch);
+
+		if (transition) {
+			uint64_t now_ns = os_gettime_ns();
+			uint64_t recv_ns = submitted ? ch->last_submit_ns : now_ns;
+			if (submitted)
+				tbar_metrics_observe(TBAR_THREAD_VIDEO, TBAR_HIST_APPLY_LATENCY, now_ns - recv_ns);
+			tbar_record_apply(ch->input.channel, submitted ? TBAR_SOURCE_NONE : TBAR_SOURCE_TRAJECTORY,
+					  TBAR_THREAD_VIDEO, recv_ns, now_ns, mailbox_position(v), false);
+			g_frame.applied |= 1L << ch->input.channel;
+			g_frame.position[ch->input.channel] = mailbox_position(v);
+			g_frame.count++;
 			return;
 		}
-		http_send(s, 405, "Method Not Allowed", "application/json; charset=utf-8",
-			  "{\"error\":\"method_not_allowed\"}");
+	}
+#else
+	(void)submitted;
+#endif
+
+	queue_ui_apply(&ch->ui_input, v);
+}
+
+/* Runs on the OBS video thread once per frame while tick_apply is on */
+static void tick_apply(void *param, float seconds)
+{
+	(void)param;
+	(void)seconds;
+
+	long used = os_atomic_load_long(&g_channels_used);
+	uint64_t now_ns = g_srv.interp != TBAR_INTERP_OFF ? os_gettime_ns() : 0;
+	for (int i = 0; i < TBAR_MAX_CHANNELS; i++) {
+		if (!(used & (1L << i)))
+			continue;
+
+		struct channel *ch = &g_channels[i];
+		long v = MAILBOX_EMPTY;
+		if (g_srv.interp != TBAR_INTERP_OFF) {
+			double pos;
+			bool release;
+			if (tbar_jitter_read(&ch->jitter, now_ns, g_srv.jitter_delay_ns, g_srv.interp, &pos, &release))
+				v = mailbox_encode(pos, release);
+		} else {
+			v = mailbox_take(&ch->input);
+		}
+		if (v != MAILBOX_EMPTY)
+			apply_on_tick(ch, v, true);
+	}
+}
+
+/* ------------------------------ */
+/* Live readback                  */
+/* ------------------------------ */
+
+/* Progress of each used channel's transition, whoever drives it (this plugin,
+   the OBS T-bar, a hotkey or an auto transition). Sampled on the video thread
+   once per frame and published in the snapshot when it changes, so GET /tbar
+   reads it from the socket thread without a lock or a UI-thread hop. */
+static void on_transition_start(void *data, calldata_t *cd)
+{
+	struct channel *ch = data;
+	(void)cd;
+	os_atomic_set_bool(&ch->active, true);
+}
+
+static void on_transition_stop(void *data, calldata_t *cd)
+{
+	struct channel *ch = data;
+	(void)cd;
+	os_atomic_set_bool(&ch->active, false);
+}
+
+/* Takes over the caller's reference to `transition` */
+static void readback_attach(struct channel *ch, obs_source_t *transition)
+{
+	if (ch->readback) {
+		signal_handler_t *sh = obs_source_get_signal_handler(ch->readback);
+		signal_handler_disconnect(sh, "transition_start", on_transition_start, ch);
+		signal_handler_disconnect(sh, "transition_stop", on_transition_stop, ch);
+		obs_source_release(ch->readback);
+	}
+
+	ch->readback = transition;
+	os_atomic_set_bool(&ch->active, false);
+	if (transition) {
+		signal_handler_t *sh = obs_source_get_signal_handler(transition);
+		signal_handler_connect(sh, "transition_start", on_transition_start, ch);
+		signal_handler_connect(sh, "transition_stop", on_transition_stop, ch);
+	}
+}
+
+static void readback_sample(struct channel *ch)
+{
+	/* Follows the user switching transitions */
+	obs_source_t *transition = obs_get_output_source((uint32_t)ch->input.channel);
+	if (transition != ch->readback)
+		readback_attach(ch, transition);
+	else
+		obs_source_release(transition);
+	if (!ch->readback)
 		return;
+
+	bool active = os_atomic_load_bool(&ch->active);
+	double t = active ? (double)obs_transition_get_time(ch->readback) : 0.0;
+	if (!(t >= 0.0))
+		t = 0.0;
+	if (t > 1.0)
+		t = 1.0;
+
+	/* Idle frames publish nothing */
+	long v = mailbox_encode(t, active);
+	if (v != ch->live_last) {
+		ch->live_last = v;
+		g_frame.sampled |= 1L << ch->input.channel;
 	}
+}
 
-	if (strcmp(path, "/tbar") != 0) {
-		http_send(s, 404, "Not Found", "application/json; charset=utf-8",
-			  "{\"error\":\"not_found\"}");
+/* Only once the tick is unregistered: writes the tick's snapshot section */
+static void readback_detach_all(void)
+{
+	struct tbar_snapshot_tick *s = tbar_snapshot_tick_begin();
+	for (int i = 0; i < TBAR_MAX_CHANNELS; i++) {
+		readback_attach(&g_channels[i], NULL);
+		g_channels[i].live_last = MAILBOX_EMPTY;
+		s->channels[i].live_valid = false;
+		s->channels[i].live_active = false;
+		s->channels[i].live_position = 0.0;
+	}
+	tbar_snapshot_tick_end();
+}
+
+/* ------------------------------ */
+/* Trajectory playback            */
+/* ------------------------------ */
+
+/* Moves uploaded with POST /tbar/trajectory, played on channel 0. Every
+   upload or abort bumps `gen` under the mutex; the video tick copies `next`
+   when it sees a new generation, so the per-frame path takes no lock. */
+static struct {
+	pthread_mutex_t mutex;
+	struct tbar_trajectory next; /* guarded by mutex; count 0 = abort */
+	volatile long gen;
+	volatile bool playing;
+
+	/* Video thread only */
+	struct tbar_trajectory cur;
+	long cur_gen;
+	uint64_t start_ns; /* frame time of the first sample, 0 until then */
+	long last;         /* last value applied */
+} g_traj = {
+	.mutex = PTHREAD_MUTEX_INITIALIZER,
+};
+
+/* NULL aborts the running move, leaving the fader where it is */
+static void trajectory_set(const struct tbar_trajectory *traj)
+{
+	pthread_mutex_lock(&g_traj.mutex);
+	if (traj)
+		g_traj.next = *traj;
+	else
+		g_traj.next.count = 0;
+	os_atomic_inc_long(&g_traj.gen);
+	os_atomic_set_bool(&g_traj.playing, traj != NULL);
+	pthread_mutex_unlock(&g_traj.mutex);
+}
+
+/* Samples the move at this frame's timestamp; MAILBOX_EMPTY when idle or unchanged */
+static long trajectory_tick(void)
+{
+	if (os_atomic_load_long(&g_traj.gen) != g_traj.cur_gen) {
+		pthread_mutex_lock(&g_traj.mutex);
+		g_traj.cur = g_traj.next;
+		g_traj.cur_gen = os_atomic_load_long(&g_traj.gen);
+		pthread_mutex_unlock(&g_traj.mutex);
+		g_traj.start_ns = 0;
+		g_traj.last = MAILBOX_EMPTY;
+	}
+	if (!g_traj.cur.count)
+		return MAILBOX_EMPTY;
+
+	uint64_t frame_ns = obs_get_video_frame_time();
+	if (!g_traj.start_ns)
+		g_traj.start_ns = frame_ns;
+	double t_ms = (double)(frame_ns - g_traj.start_ns) / 1000000.0;
+
+	double pos = tbar_trajectory_sample(&g_traj.cur, t_ms);
+	bool done = t_ms >= tbar_trajectory_duration_ms(&g_traj.cur);
+	long v = mailbox_encode(pos, done && g_traj.cur.release);
+	if (done) {
+		g_traj.cur.count = 0;
+		/* Unless a new move was uploaded meanwhile */
+		pthread_mutex_lock(&g_traj.mutex);
+		if (os_atomic_load_long(&g_traj.gen) == g_traj.cur_gen)
+			os_atomic_set_bool(&g_traj.playing, false);
+		pthread_mutex_unlock(&g_traj.mutex);
+	}
+
+	/* Holding still costs nothing */
+	if (v == g_traj.last)
+		return MAILBOX_EMPTY;
+	g_traj.last = v;
+	return v;
+}
+
+static void video_tick(void *param, float seconds)
+{
+	/* A move in progress owns the main fader; any other update aborts it first */
+	long v = trajectory_tick();
+	if (v != MAILBOX_EMPTY)
+		apply_on_tick(&g_channels[0], v, false);
+	else if (g_srv.tick_apply)
+		tick_apply(param, seconds);
+
+	long used = os_atomic_load_long(&g_channels_used);
+	for (int i = 0; i < TBAR_MAX_CHANNELS; i++) {
+		if (used & (1L << i))
+			readback_sample(&g_channels[i]);
+	}
+
+	if (!g_frame.applied && !g_frame.sampled)
+		return;
+
+	/* The tick's own section: publishing never waits on the UI thread */
+	struct tbar_snapshot_tick *s = tbar_snapshot_tick_begin();
+	uint64_t now_ns = g_frame.applied ? os_gettime_ns() : 0;
+	for (int i = 0; i < TBAR_MAX_CHANNELS; i++) {
+		if (g_frame.applied & (1L << i)) {
+			s->channels[i].position = g_frame.position[i];
+			s->channels[i].position_ns = now_ns;
+		}
+		if (g_frame.sampled & (1L << i)) {
+			s->channels[i].live_valid = true;
+			s->channels[i].live_active = (g_channels[i].live_last & 1) != 0;
+			s->channels[i].live_position = mailbox_position(g_channels[i].live_last);
+		}
+	}
+	s->applied += g_frame.count;
+	bool changed = tbar_snapshot_tick_end();
+	g_frame.applied = 0;
+	g_frame.sampled = 0;
+	g_frame.count = 0;
+
+	if (changed)
+		notify_applied();
+}
+
+void tbar_web_submit_timed_position(int channel, enum tbar_record_source source, double pos, bool release,
+				    double sender_ms)
+{
+	if (channel < 0 || channel >= TBAR_MAX_CHANNELS)
+		return;
+	struct channel *ch = &g_channels[channel];
+
+	/* Also catches NaN */
+	if (!(pos >= 0.0))
+		pos = 0.0;
+	if (pos > 1.0)
+		pos = 1.0;
+	/* A release at either end leaves the fader back at 0 */
+	ch->requested = release && (pos >= TBAR_T_FINISH || pos <= TBAR_T_CANCEL) ? 0.0 : pos;
+
+	/* Taking over by hand stops a trajectory where it is */
+	if (channel == 0 && os_atomic_load_bool(&g_traj.playing))
+		trajectory_set(NULL);
+
+	/* A timestamp that is not a plain millisecond count (NaN, inf, beyond 2^53)
+	   counts as none rather than reaching the jitter buffer's clock mapping */
+	if (!(sender_ms >= 0.0 && sender_ms < 9007199254740992.0))
+		sender_ms = -1.0;
+
+	uint64_t now_ns = os_gettime_ns();
+	os_atomic_inc_long(&g_updates.submitted);
+	ch->last_submit_ns = now_ns;
+	tbar_record_ingest(channel, source, now_ns, pos, release, sender_ms);
+	channel_mark_used(channel);
+	if (g_srv.interp != TBAR_INTERP_OFF) {
+		tbar_jitter_push(&ch->jitter, pos, release, sender_ms, now_ns);
 		return;
 	}
 
-	if (strcmp(method, "GET") == 0) {
-		char resp[128];
-		/* We currently report the last position we applied via POST.
-		   (We can later add true readback if we find a get API or a signal.) */
-		snprintf(resp, sizeof(resp), "{\"position\":%.6f,\"source\":\"cached\"}", g_srv.last_position);
-		http_send(s, 200, "OK", "application/json; charset=utf-8", resp);
+	long v = mailbox_encode(pos, release);
+	if (g_srv.tick_apply)
+		mailbox_put(&ch->input, v);
+	else
+		queue_ui_apply(&ch->input, v);
+}
+
+void tbar_web_submit_position(int channel, enum tbar_record_source source, double pos, bool release)
+{
+	tbar_web_submit_timed_position(channel, source, pos, release, -1.0);
+}
+
+double tbar_web_last_position(int channel)
+{
+	return channel >= 0 && channel < TBAR_MAX_CHANNELS ? g_channels[channel].requested : 0.0;
+}
+
+#define STATE_JSON_SIZE 1024
+/* Shared buffer tag of the WebSocket state push; a newer one replaces it */
+#define WS_STATE_TAG 1
+
+/* The WebSocket state frame for the main output, or with `tally` the /events
+   one, which adds the program/preview scenes. The version comes last; its
+   offset goes to `version_at`, so callers can compare frames without it. */
+static int format_state_json(char *buf, size_t size, const struct tbar_snapshot *s, bool tally, int *version_at)
+{
+	const struct tbar_snapshot_channel *sc = &s->channels[0];
+	int n = snprintf(buf, size, "{\"position\":%.6f,\"manual_active\":%s", sc->position,
+			 sc->manual_active ? "true" : "false");
+	if (tally && n > 0 && (size_t)n < size) {
+		char program[2 * TBAR_SNAPSHOT_NAME];
+		char preview[2 * TBAR_SNAPSHOT_NAME];
+		json_escape(program, sizeof(program), s->program);
+		json_escape(preview, sizeof(preview), s->preview);
+		n += snprintf(buf + n, size - (size_t)n, ",\"program\":\"%s\",\"preview\":\"%s\"", program, preview);
+	}
+	if (n <= 0 || (size_t)n >= size)
+		return -1;
+
+	if (version_at)
+		*version_at = n;
+	n += snprintf(buf + n, size - (size_t)n, ",\"version\":%llu}", (unsigned long long)s->version);
+	return (size_t)n < size ? n : -1;
+}
+
+void tbar_web_on_wake(struct tbar_conn *conns, int count)
+{
+	struct event events[EVENT_QUEUE_SIZE];
+	int event_count = take_events(events, EVENT_QUEUE_SIZE);
+	for (int i = 0; i < event_count; i++) {
+		char data[64];
+		int n = snprintf(data, sizeof(data), "{\"event\":\"%s\",\"channel\":%d}", events[i].name,
+				 events[i].channel);
+		tbar_sse_publish(conns, count, TBAR_SSE_TRANSITION, "transition", data, (size_t)n, false);
+	}
+
+	if (!os_atomic_set_bool(&g_srv.state_dirty, false))
 		return;
+
+	struct tbar_snapshot snap;
+	tbar_snapshot_read(&snap);
+
+	char msg[STATE_JSON_SIZE];
+	int n = format_state_json(msg, sizeof(msg), &snap, false, NULL);
+	if (n <= 0)
+		return;
+
+	tbar_ws_broadcast_text(conns, count, WS_STATE_TAG, msg, (size_t)n);
+
+	if (tbar_sse_subscribers()) {
+		/* A start or release wakes us from both the tick and the UI thread,
+		   and the version also moves for other channels; viewers only need to
+		   hear about an actual change once */
+		static char last_state[STATE_JSON_SIZE];
+		static int last_len;
+		char state[STATE_JSON_SIZE];
+		int cmp_len = 0;
+		int len = format_state_json(state, sizeof(state), &snap, true, &cmp_len);
+		if (len > 0 && (cmp_len != last_len || memcmp(state, last_state, (size_t)cmp_len) != 0)) {
+			memcpy(last_state, state, (size_t)cmp_len);
+			last_len = cmp_len;
+			tbar_sse_publish(conns, count, TBAR_SSE_STATE, "state", state, (size_t)len, true);
+		}
 	}
+}
 
-	if (strcmp(method, "POST") == 0) {
-		double pos = 0.0;
-		if (!parse_json_position(body, &pos)) {
-			http_send(s, 400, "Bad Request", "application/json; charset=utf-8",
-				  "{\"error\":\"invalid_json\"}");
+void tbar_web_handle_ws_message(struct tbar_conn *c, bool binary, const char *data, size_t len)
+{
+	double pos = 0.0;
+	bool release = false;
+	double sender_ms = -1.0;
+	struct tbar_json_fields f;
+	bool have_fields = false;
+
+	if (binary) {
+		/* Compact form: float32 little-endian position, then a flags byte (bit 0 = release),
+		   optionally followed by a float64 little-endian timestamp in milliseconds */
+		if (len < 5) {
+			tbar_ws_send_text(c, "{\"error\":\"invalid_frame\"}", 25);
 			return;
 		}
-
-		g_srv.last_position = pos;
-
-		struct set_pos_task_data *d = malloc(sizeof(*d));
-		if (!d) {
-			http_send(s, 500, "Internal Server Error", "application/json; charset=utf-8",
-				  "{\"error\":\"oom\"}");
+		const uint8_t *p = (const uint8_t *)data;
+		uint32_t bits = (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+		float f;
+		memcpy(&f, &bits, sizeof(f));
+		if (!(f >= 0.0f && f <= 1.0f)) {
+			tbar_ws_send_text(c, "{\"error\":\"invalid_frame\"}", 25);
 			return;
 		}
-		d->pos = pos;
-		d->release = false;
-		(void)parse_json_release(body, &d->release);
-		/* Always execute on UI task queue to keep frontend calls off the socket thread. */
-		obs_queue_task(OBS_TASK_UI, set_pos_task, d, false);
+		pos = f;
+		release = (p[4] & 1) != 0;
+		if (len >= 13) {
+			uint64_t tbits = 0;
+			for (int i = 7; i >= 0; i--)
+				tbits = tbits << 8 | p[5 + i];
+			memcpy(&sender_ms, &tbits, sizeof(sender_ms));
+		}
+	} else {
+		if (!tbar_json_extract(data, len, &f)) {
+			tbar_ws_send_text(c, "{\"error\":\"invalid_json\"}", 24);
+			return;
+		}
+		/* {"ping":n} is answered right here with {"pong":n}, so the round trip
+		   measures the transport and the socket thread, not the apply path */
+		if (f.present & TBAR_JSON_PING) {
+			char pong[64];
+			int n = snprintf(pong, sizeof(pong), "{\"pong\":%.17g}", isfinite(f.ping) ? f.ping : 0.0);
+			tbar_ws_send_text(c, pong, (size_t)n);
+			if (!(f.present & TBAR_JSON_POSITION))
+				return;
+		}
+		if (!position_from_fields(&f, &pos, &release, &sender_ms)) {
+			tbar_ws_send_text(c, "{\"error\":\"invalid_json\"}", 24);
+			return;
+		}
+		have_fields = true;
+	}
 
-		http_send(s, 200, "OK", "application/json; charset=utf-8",
-			  "{\"ok\":true}");
+	/* Binary frames carry no client id or seq: they arbitrate as the anonymous client */
+	char resp[256];
+	if (arbitrate(0, have_fields ? &f : NULL, release, resp, sizeof(resp)) != 200) {
+		tbar_ws_send_text(c, resp, strlen(resp));
 		return;
 	}
+	tbar_web_submit_timed_position(0, TBAR_SOURCE_WS, pos, release, sender_ms);
+}
 
-	http_send(s, 405, "Method Not Allowed", "application/json; charset=utf-8",
-		  "{\"error\":\"method_not_allowed\"}");
+/* One gauge with a series per channel in use */
+static bool format_channel_gauge(char *buf, size_t size, size_t *len, const struct tbar_snapshot *s,
+				 const char *name, const char *help, bool position)
+{
+	long used = os_atomic_load_long(&g_channels_used);
+	int n = snprintf(buf + *len, size - *len, "# HELP %s %s\n# TYPE %s gauge\n", name, help, name);
+	for (int i = 0; i < TBAR_MAX_CHANNELS && n > 0 && (size_t)n < size - *len; i++) {
+		if (!(used & (1L << i)))
+			continue;
+		*len += (size_t)n;
+		const struct tbar_snapshot_channel *ch = &s->channels[i];
+		if (position)
+			n = snprintf(buf + *len, size - *len, "%s{channel=\"%d\"} %.6f\n", name, i, ch->position);
+		else
+			n = snprintf(buf + *len, size - *len, "%s{channel=\"%d\"} %d\n", name, i, ch->manual_active);
+	}
+	if (n <= 0 || (size_t)n >= size - *len)
+		return false;
+	*len += (size_t)n;
+	return true;
 }
 
-static unsigned __stdcall server_thread(void *unused)
+/* Prometheus text exposition; only ever built on the socket thread */
+static void handle_metrics(struct tbar_conn *c)
 {
-	(void)unused;
+	static char buf[16384];
+	static struct tbar_snapshot snap;
+	size_t len = 0;
+	tbar_snapshot_read(&snap);
+
+	long jitter_overflow = 0;
+	for (int i = 0; i < TBAR_MAX_CHANNELS; i++)
+		jitter_overflow += os_atomic_load_long(&g_channels[i].jitter.overflow);
+
+	bool ok = tbar_metrics_format(buf, sizeof(buf), &len) &&
+		  tbar_metrics_format_value(buf, sizeof(buf), &len, "tbar_updates_submitted_total", "counter",
+					    "Positions received from all transports",
+					    (uint64_t)os_atomic_load_long(&g_updates.submitted)) &&
+		  tbar_metrics_format_value(buf, sizeof(buf), &len, "tbar_updates_applied_total", "counter",
+					    "Positions applied to the transition",
+					    snap.applied) &&
+		  tbar_metrics_format_value(buf, sizeof(buf), &len, "tbar_updates_coalesced_total", "counter",
+					    "Positions replaced by a newer one before being applied",
+					    (uint64_t)os_atomic_load_long(&g_updates.coalesced)) &&
+		  tbar_metrics_format_value(buf, sizeof(buf), &len, "tbar_jitter_overflow_total", "counter",
+					    "Positions dropped because the jitter buffer was full",
+					    (uint64_t)jitter_overflow) &&
+		  tbar_metrics_format_value(buf, sizeof(buf), &len, "tbar_udp_dropped_stale_total", "counter",
+					    "Datagrams dropped for an old sequence number",
+					    (uint64_t)os_atomic_load_long(&tbar_udp_stats.dropped_stale)) &&
+		  tbar_metrics_format_value(buf, sizeof(buf), &len, "tbar_udp_invalid_total", "counter",
+					    "Datagrams that could not be parsed",
+					    (uint64_t)os_atomic_load_long(&tbar_udp_stats.invalid)) &&
+		  tbar_metrics_format_value(buf, sizeof(buf), &len, "tbar_sse_subscribers", "gauge",
+					    "Connected /events subscribers", (uint64_t)tbar_sse_subscribers()) &&
+		  tbar_metrics_format_value(buf, sizeof(buf), &len, "tbar_log_suppressed_total", "counter",
+					    "Hot-path log messages dropped by rate limiting",
+					    (uint64_t)tbar_log_suppressed_total());
+
+	ok = ok &&
+	     format_channel_gauge(buf, sizeof(buf), &len, &snap, "tbar_manual_active",
+				  "Whether a manual transition is running", false) &&
+	     format_channel_gauge(buf, sizeof(buf), &len, &snap, "tbar_position", "Last applied T-bar position",
+				  true) &&
+	     tbar_metrics_format_value(buf, sizeof(buf), &len, "tbar_state_version", "counter",
+				       "Published state snapshots", snap.version);
+
+	if (!ok) {
+		http_send(c, 500, "Internal Server Error", NULL, "metrics buffer too small");
+		return;
+	}
+	http_send(c, 200, "OK", "text/plain; version=0.0.4; charset=utf-8", buf);
+}
 
-	WSADATA wsa;
-	if (WSAStartup(MAKEWORD(2, 2), &wsa) != 0) {
-		obs_log(LOG_ERROR, "tbar-web: WSAStartup failed");
-		return 0;
+/* The control page, served from prebuilt (and gzip) responses by tbar-static.c */
+static const char g_index_html[] =
+	"<!doctype html>\n"
+	"<html lang=\"en\">\n"
+	"<head>\n"
+	"  <meta charset=\"utf-8\" />\n"
+	"  <meta name=\"viewport\" content=\"width=device-width, initial-scale=1\" />\n"
+	"  <title>OBS T-bar test</title>\n"
+	"  <style>\n"
+	"    :root { color-scheme: dark; }\n"
+	"    body { margin: 0; font-family: system-ui, -apple-system, Segoe UI, Roboto, Arial; background:#0b0f14; color:#e8eef7; }\n"
+	"    .wrap { max-width: 760px; margin: 40px auto; padding: 0 16px; }\n"
+	"    .card { background:#121a24; border:1px solid #223247; border-radius: 14px; padding: 18px; }\n"
+	"    h1 { font-size: 18px; margin: 0 0 12px; }\n"
+	"    .row { display:flex; align-items:center; gap: 12px; }\n"
+	"    input[type=range] { width: 100%; touch-action: none; }\n"
+	"    .mono { font-family: ui-monospace, SFMono-Regular, Menlo, Consolas, monospace; opacity: .9; }\n"
+	"    .muted { opacity: .75; font-size: 13px; margin-top: 10px; }\n"
+	"    .ok { color:#6ee7b7; }\n"
+	"    .bad { color:#fca5a5; }\n"
+	"    button { background:#1b2a3d; color:#e8eef7; border:1px solid #2c425f; border-radius: 10px; padding: 8px 10px; cursor:pointer; }\n"
+	"    button:hover { background:#22324a; }\n"
+	"    label { user-select: none; }\n"
+	"    input[type=number] { width: 110px; background:#0b0f14; color:#e8eef7; border:1px solid #2c425f; border-radius: 10px; padding: 6px 8px; }\n"
+	"    input[type=checkbox] { transform: scale(1.1); }\n"
+	"    .hr { height:1px; background:#223247; margin: 14px 0; }\n"
+	"    canvas { display:block; width: 100%; height: 90px; background:#0b0f14; border:1px solid #223247; border-radius: 10px; }\n"
+	"    .key { display:inline-block; width: 10px; height: 3px; margin: 0 4px 3px 10px; }\n"
+	"  </style>\n"
+	"</head>\n"
+	"<body>\n"
+	"  <div class=\"wrap\">\n"
+	"    <div class=\"card\">\n"
+	"      <h1>OBS T-bar test</h1>\n"
+	"      <div class=\"row\">\n"
+	"        <input id=\"slider\" type=\"range\" min=\"0\" max=\"1023\" step=\"1\" value=\"0\" />\n"
+	"        <div class=\"mono\" style=\"min-width: 120px; text-align:right;\">\n"
+	"          <div><span id=\"pct\">0.0</span>%</div>\n"
+	"          <div style=\"opacity:.7\">(<span id=\"raw\">0</span>)</div>\n"
+	"        </div>\n"
+	"      </div>\n"
+	"      <div class=\"row\" style=\"margin-top: 12px; justify-content: space-between;\">\n"
+	"        <div class=\"mono\">Status: <span id=\"status\" class=\"muted\">—</span></div>\n"
+	"        <div class=\"row\">\n"
+	"          <button id=\"btn0\" type=\"button\">0%</button>\n"
+	"          <button id=\"btn50\" type=\"button\">50%</button>\n"
+	"          <button id=\"btn100\" type=\"button\">100%</button>\n"
+	"        </div>\n"
+	"      </div>\n"
+	"      <div class=\"muted\">\n"
+	"        Tip: keep OBS in Studio Mode while testing. This page streams to <span class=\"mono\">/tbar/ws</span>, or sends POST <span class=\"mono\">/tbar</span> when the WebSocket is unavailable.\n"
+	"      </div>\n"
+	"      <div class=\"hr\"></div>\n"
+	"      <div class=\"row\" style=\"justify-content: space-between; margin-bottom: 8px;\">\n"
+	"        <div class=\"mono\">Link: <span id=\"link\">—</span></div>\n"
+	"        <div class=\"mono\" style=\"font-size: 13px;\">\n"
+	"          <span class=\"key\" style=\"background:#6ee7b7\"></span>RTT <span id=\"rtt\">—</span>\n"
+	"          <span class=\"key\" style=\"background:#60a5fa\"></span><span id=\"rate\">0</span> upd/s\n"
+	"          <span style=\"opacity:.7\">(<span id=\"samples\">0</span> samples/s)</span>\n"
+	"        </div>\n"
+	"      </div>\n"
+	"      <canvas id=\"graph\"></canvas>\n"
+	"      <div class=\"hr\"></div>\n"
+	"      <div class=\"row\" style=\"justify-content: space-between; align-items: flex-start; gap: 16px;\">\n"
+	"        <div>\n"
+	"          <div class=\"mono\" style=\"margin-bottom: 6px;\">Settings</div>\n"
+	"          <div class=\"row\" style=\"gap:10px; flex-wrap: wrap;\">\n"
+	"            <label class=\"row\" style=\"gap:8px;\"><input id=\"cfgEnabled\" type=\"checkbox\" /> enabled</label>\n"
+	"            <label class=\"row\" style=\"gap:8px;\">port <input id=\"cfgPort\" type=\"number\" min=\"1\" max=\"65535\" /></label>\n"
+	"            <button id=\"cfgSave\" type=\"button\">Save</button>\n"
+	"          </div>\n"
+	"          <div class=\"muted\" id=\"cfgHint\"></div>\n"
+	"        </div>\n"
+	"        <div class=\"mono\" style=\"text-align:right; opacity:.8;\">\n"
+	"          <div>GET <span class=\"mono\">/config</span></div>\n"
+	"          <div>POST <span class=\"mono\">/config</span></div>\n"
+	"        </div>\n"
+	"      </div>\n"
+	"    </div>\n"
+	"  </div>\n"
+	"\n"
+	"  <script>\n"
+	"    const slider = document.getElementById('slider');\n"
+	"    const pct = document.getElementById('pct');\n"
+	"    const raw = document.getElementById('raw');\n"
+	"    const status = document.getElementById('status');\n"
+	"    const cfgEnabled = document.getElementById('cfgEnabled');\n"
+	"    const cfgPort = document.getElementById('cfgPort');\n"
+	"    const cfgSave = document.getElementById('cfgSave');\n"
+	"    const cfgHint = document.getElementById('cfgHint');\n"
+	"\n"
+	"    function setUi(v) {\n"
+	"      const n = Number(v);\n"
+	"      raw.textContent = String(n);\n"
+	"      pct.textContent = (n / 1023 * 100).toFixed(1);\n"
+	"    }\n"
+	"\n"
+	"    function setStatus(ok, text) {\n"
+	"      status.textContent = text;\n"
+	"      status.className = ok ? 'ok mono' : 'bad mono';\n"
+	"    }\n"
+	"\n"
+	"    function setCfgHint(ok, text) {\n"
+	"      cfgHint.textContent = text || '';\n"
+	"      cfgHint.className = ok ? 'muted ok' : 'muted bad';\n"
+	"    }\n"
+	"\n"
+	"    let released = false;\n"
+	"    // Identifies this page to the plugin's arbitration; seq lets it drop reordered updates\n"
+	"    const clientId = 'page-' + Math.random().toString(36).slice(2, 10);\n"
+	"    let seq = 0;\n"
+	"\n"
+	"    function message(position, release, timestamp) {\n"
+	"      const m = { position, seq: ++seq, client_id: clientId };\n"
+	"      if (release) m.release = true;\n"
+	"      // Sampling time of the pointer event, so the plugin's jitter buffer sees real motion timing\n"
+	"      if (timestamp !== undefined) m.timestamp = timestamp;\n"
+	"      return JSON.stringify(m);\n"
+	"    }\n"
+	"\n"
+	"    // Telemetry: round-trip times and counts, folded into one graph point every 250 ms\n"
+	"    const TELE_MS = 250;\n"
+	"    const TELE_POINTS = 120;\n"
+	"    const tele = { rtt: [], sent: 0, samples: 0, history: [] };\n"
+	"\n"
+	"    function noteRtt(ms) {\n"
+	"      tele.rtt.push(ms);\n"
+	"    }\n"
+	"\n"
+	"    // Transport: the WebSocket while it is open, POST /tbar otherwise. Only the\n"
+	"    // latest position matters, so at most one waits behind a request in flight.\n"
+	"    let ws = null;\n"
+	"    let wsOpen = false;\n"
+	"    let wsRetryMs = 250;\n"
+	"    let httpBusy = false;\n"
+	"    let httpNext = null;\n"
+	"\n"
+	"    function connect() {\n"
+	"      const url = (location.protocol === 'https:' ? 'wss://' : 'ws://') + location.host + '/tbar/ws';\n"
+	"      try {\n"
+	"        ws = new WebSocket(url);\n"
+	"      } catch (_) {\n"
+	"        setLink();\n"
+	"        return;\n"
+	"      }\n"
+	"      ws.onopen = () => {\n"
+	"        wsOpen = true;\n"
+	"        wsRetryMs = 250;\n"
+	"        setLink();\n"
+	"      };\n"
+	"      ws.onclose = () => {\n"
+	"        wsOpen = false;\n"
+	"        ws = null;\n"
+	"        setLink();\n"
+	"        setTimeout(connect, wsRetryMs);\n"
+	"        wsRetryMs = Math.min(wsRetryMs * 2, 5000);\n"
+	"      };\n"
+	"      ws.onmessage = (ev) => {\n"
+	"        let j;\n"
+	"        try { j = JSON.parse(ev.data); } catch (_) { return; }\n"
+	"        if (j.pong !== undefined) noteRtt(performance.now() - j.pong);\n"
+	"        else if (j.queued) setStatus(false, 'queued');\n"
+	"        else if (j.error) setStatus(false, j.error + (j.owner ? ' (' + j.owner + ')' : ''));\n"
+	"      };\n"
+	"    }\n"
+	"\n"
+	"    function setLink() {\n"
+	"      document.getElementById('link').textContent = wsOpen ? 'WebSocket' : 'HTTP';\n"
+	"    }\n"
+	"\n"
+	"    function post(body) {\n"
+	"      httpNext = body;\n"
+	"      if (httpBusy) return;\n"
+	"      httpBusy = true;\n"
+	"      const cur = httpNext;\n"
+	"      httpNext = null;\n"
+	"      const t0 = performance.now();\n"
+	"      fetch('/tbar', { method: 'POST', headers: { 'Content-Type': 'application/json' }, body: cur })\n"
+	"        .then((r) => {\n"
+	"          noteRtt(performance.now() - t0);\n"
+	"          if (r.status === 202) setStatus(false, 'queued');\n"
+	"          else if (!r.ok) throw new Error('HTTP ' + r.status);\n"
+	"          else setStatus(true, 'OK');\n"
+	"        })\n"
+	"        .catch((e) => setStatus(false, String(e)))\n"
+	"        .finally(() => {\n"
+	"          httpBusy = false;\n"
+	"          if (httpNext !== null) post(httpNext);\n"
+	"        });\n"
+	"    }\n"
+	"\n"
+	"    function send(position, release, timestamp) {\n"
+	"      const body = message(position, release, timestamp);\n"
+	"      tele.sent++;\n"
+	"      if (wsOpen) {\n"
+	"        ws.send(body);\n"
+	"        setStatus(true, 'OK');\n"
+	"      } else {\n"
+	"        post(body);\n"
+	"      }\n"
+	"    }\n"
+	"\n"
+	"    // Pointer samples and input events only record the newest value; it is sent\n"
+	"    // once per display frame, so the update rate follows the screen, not the mouse.\n"
+	"    let target = null;\n"
+	"    let targetTime;\n"
+	"    let frameQueued = false;\n"
+	"\n"
+	"    function schedule(v, timestamp) {\n"
+	"      target = v;\n"
+	"      targetTime = timestamp;\n"
+	"      if (!frameQueued) {\n"
+	"        frameQueued = true;\n"
+	"        requestAnimationFrame(flushFrame);\n"
+	"      }\n"
+	"    }\n"
+	"\n"
+	"    function flushFrame() {\n"
+	"      frameQueued = false;\n"
+	"      if (target === null) return;\n"
+	"      const v = target;\n"
+	"      target = null;\n"
+	"      send(v / 1023, false, targetTime);\n"
+	"    }\n"
+	"\n"
+	"    function setValue(v, timestamp) {\n"
+	"      if (v < (Number(slider.max) - 10)) released = false;\n"
+	"      slider.value = v;\n"
+	"      setUi(v);\n"
+	"      schedule(v, timestamp);\n"
+	"    }\n"
+	"\n"
+	"    function releaseIfAtMax() {\n"
+	"      const v = Number(slider.value);\n"
+	"      const max = Number(slider.max);\n"
+	"      const clamp = 10;\n"
+	"      if (v < (max - clamp)) return;\n"
+	"      if (released) return;\n"
+	"      released = true;\n"
+	"      // Drop the position still waiting for a frame; the release supersedes it\n"
+	"      target = null;\n"
+	"      send(1.0, true, performance.now());\n"
+	"      // Reset UI so the next run starts clean\n"
+	"      slider.value = 0;\n"
+	"      setUi(0);\n"
+	"      setStatus(true, 'release');\n"
+	"    }\n"
+	"\n"
+	"    // The slider is driven from pointer events directly: every coalesced sample\n"
+	"    // between two frames counts, and the newest one wins.\n"
+	"    let dragging = false;\n"
+	"\n"
+	"    function valueAt(ev) {\n"
+	"      const r = slider.getBoundingClientRect();\n"
+	"      const x = Math.min(Math.max((ev.clientX - r.left) / r.width, 0), 1);\n"
+	"      return Math.round(x * Number(slider.max));\n"
+	"    }\n"
+	"\n"
+	"    slider.addEventListener('pointerdown', (ev) => {\n"
+	"      if (ev.button !== 0) return;\n"
+	"      ev.preventDefault();\n"
+	"      dragging = true;\n"
+	"      slider.setPointerCapture(ev.pointerId);\n"
+	"      slider.focus();\n"
+	"      tele.samples++;\n"
+	"      setValue(valueAt(ev), ev.timeStamp);\n"
+	"    });\n"
+	"\n"
+	"    slider.addEventListener('pointermove', (ev) => {\n"
+	"      if (!dragging) return;\n"
+	"      const events = ev.getCoalescedEvents ? ev.getCoalescedEvents() : [];\n"
+	"      const last = events.length ? events[events.length - 1] : ev;\n"
+	"      tele.samples += events.length || 1;\n"
+	"      setValue(valueAt(last), last.timeStamp);\n"
+	"    });\n"
+	"\n"
+	"    function endDrag() {\n"
+	"      if (!dragging) return;\n"
+	"      dragging = false;\n"
+	"      releaseIfAtMax();\n"
+	"    }\n"
+	"\n"
+	"    slider.addEventListener('pointerup', endDrag);\n"
+	"    slider.addEventListener('pointercancel', endDrag);\n"
+	"\n"
+	"    // Keyboard and other non-pointer changes\n"
+	"    slider.addEventListener('input', () => {\n"
+	"      if (!dragging) setValue(Number(slider.value), performance.now());\n"
+	"    });\n"
+	"\n"
+	"    document.getElementById('btn0').onclick = () => setValue(0, performance.now());\n"
+	"    document.getElementById('btn50').onclick = () => setValue(512, performance.now());\n"
+	"    document.getElementById('btn100').onclick = () => { setValue(1023, performance.now()); releaseIfAtMax(); };\n"
+	"\n"
+	"    const graph = document.getElementById('graph');\n"
+	"    const rttText = document.getElementById('rtt');\n"
+	"    const rateText = document.getElementById('rate');\n"
+	"    const samplesText = document.getElementById('samples');\n"
+	"\n"
+	"    function drawGraph() {\n"
+	"      const dpr = window.devicePixelRatio || 1;\n"
+	"      const w = Math.round(graph.clientWidth * dpr);\n"
+	"      const h = Math.round(graph.clientHeight * dpr);\n"
+	"      if (graph.width !== w || graph.height !== h) {\n"
+	"        graph.width = w;\n"
+	"        graph.height = h;\n"
+	"      }\n"
+	"      const g = graph.getContext('2d');\n"
+	"      g.clearRect(0, 0, w, h);\n"
+	"      const pts = tele.history;\n"
+	"      const step = w / (TELE_POINTS - 1);\n"
+	"      const x0 = w - (pts.length - 1) * step;\n"
+	"      // Each series scales to its own peak so both stay readable\n"
+	"      const maxRate = Math.max(60, ...pts.map((p) => p.rate));\n"
+	"      const maxRtt = Math.max(5, ...pts.map((p) => p.rtt || 0));\n"
+	"\n"
+	"      g.fillStyle = 'rgba(96,165,250,.35)';\n"
+	"      pts.forEach((p, i) => {\n"
+	"        const bh = p.rate / maxRate * (h - 4);\n"
+	"        g.fillRect(x0 + i * step - step / 2, h - bh, Math.max(step - 1, 1), bh);\n"
+	"      });\n"
+	"\n"
+	"      g.strokeStyle = '#6ee7b7';\n"
+	"      g.lineWidth = 1.5 * dpr;\n"
+	"      g.beginPath();\n"
+	"      let pen = false;\n"
+	"      pts.forEach((p, i) => {\n"
+	"        if (p.rtt === null) { pen = false; return; }\n"
+	"        const y = h - 2 - p.rtt / maxRtt * (h - 4);\n"
+	"        if (pen) g.lineTo(x0 + i * step, y); else g.moveTo(x0 + i * step, y);\n"
+	"        pen = true;\n"
+	"      });\n"
+	"      g.stroke();\n"
+	"\n"
+	"      g.fillStyle = 'rgba(232,238,247,.6)';\n"
+	"      g.font = (11 * dpr) + 'px ui-monospace, monospace';\n"
+	"      g.fillText(maxRtt.toFixed(1) + ' ms / ' + maxRate + ' upd/s', 6 * dpr, 14 * dpr);\n"
+	"    }\n"
+	"\n"
+	"    setInterval(() => {\n"
+	"      // A round trip every tick keeps the RTT live even while the fader is idle\n"
+	"      if (wsOpen) ws.send(JSON.stringify({ ping: performance.now() }));\n"
+	"\n"
+	"      const rtts = tele.rtt.sort((a, b) => a - b);\n"
+	"      const rtt = rtts.length ? rtts[Math.floor(rtts.length / 2)] : null;\n"
+	"      const rate = Math.round(tele.sent * 1000 / TELE_MS);\n"
+	"      tele.history.push({ rtt, rate });\n"
+	"      if (tele.history.length > TELE_POINTS) tele.history.shift();\n"
+	"\n"
+	"      if (rtt !== null) {\n"
+	"        const p95 = rtts[Math.min(rtts.length - 1, Math.floor(rtts.length * 0.95))];\n"
+	"        rttText.textContent = rtt.toFixed(1) + ' ms (p95 ' + p95.toFixed(1) + ')';\n"
+	"      }\n"
+	"      rateText.textContent = String(rate);\n"
+	"      samplesText.textContent = String(Math.round(tele.samples * 1000 / TELE_MS));\n"
+	"      tele.rtt = [];\n"
+	"      tele.sent = 0;\n"
+	"      tele.samples = 0;\n"
+	"      drawGraph();\n"
+	"    }, TELE_MS);\n"
+	"\n"
+	"    connect();\n"
+	"    setLink();\n"
+	"\n"
+	"    (async function init() {\n"
+	"      try {\n"
+	"        const rc = await fetch('/config');\n"
+	"        if (rc.ok) {\n"
+	"          const c = await rc.json();\n"
+	"          cfgEnabled.checked = !!c.enabled;\n"
+	"          cfgPort.value = String(c.port || 4455);\n"
+	"          setCfgHint(true, '');\n"
+	"        }\n"
+	"        cfgSave.onclick = async () => {\n"
+	"          try {\n"
+	"            const newPort = Number(cfgPort.value);\n"
+	"            const payload = { enabled: !!cfgEnabled.checked, port: newPort };\n"
+	"            const r = await fetch('/config', { method: 'POST', headers: { 'Content-Type': 'application/json' }, body: JSON.stringify(payload) });\n"
+	"            if (!r.ok) throw new Error('HTTP ' + r.status);\n"
+	"            const j = await r.json();\n"
+	"            if (j.port && j.port != location.port) {\n"
+	"              setCfgHint(true, 'Port changed. Open: http://127.0.0.1:' + j.port + '/');\n"
+	"            } else {\n"
+	"              setCfgHint(true, 'Saved');\n"
+	"            }\n"
+	"          } catch (e) {\n"
+	"            setCfgHint(false, String(e));\n"
+	"          }\n"
+	"        };\n"
+	"\n"
+	"        const r = await fetch('/tbar');\n"
+	"        if (r.ok) {\n"
+	"          const j = await r.json();\n"
+	"          const v = Math.round((Number(j.position) || 0) * 1023);\n"
+	"          slider.value = v;\n"
+	"          setUi(v);\n"
+	"          setStatus(true, 'ready');\n"
+	"        }\n"
+	"      } catch (_) {}\n"
+	"    })();\n"
+	"  </script>\n"
+	"</body>\n"
+	"</html>\n";
+
+/* POST /tbar/trajectory: {"keyframes":[[ms,pos],...]} or {"duration_ms":...,
+   "from":...,"to":...}, each with optional "easing" and "release" (default
+   true); {"abort":true} stops the running move. */
+static void handle_trajectory(struct tbar_conn *c, const char *body, int body_len)
+{
+	struct tbar_json_keyframe keyframes[TBAR_TRAJECTORY_MAX_POINTS];
+	struct tbar_json_fields f;
+	if (!tbar_json_extract_keyframes(body, (size_t)body_len, &f, keyframes, TBAR_TRAJECTORY_MAX_POINTS)) {
+		http_send(c, 400, "Bad Request", "application/json; charset=utf-8", "{\"error\":\"invalid_json\"}");
+		return;
 	}
 
-	g_srv.listen_sock = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
-	if (g_srv.listen_sock == INVALID_SOCKET) {
-		obs_log(LOG_ERROR, "tbar-web: socket() failed");
-		WSACleanup();
-		return 0;
+	char resp[256];
+	int status = arbitrate(0, &f, false, resp, sizeof(resp));
+	if (status != 200) {
+		http_send(c, status, status == 202 ? "Accepted" : "Conflict", "application/json; charset=utf-8", resp);
+		return;
+	}
+
+	if ((f.present & TBAR_JSON_ABORT) && f.abort) {
+		bool playing = os_atomic_load_bool(&g_traj.playing);
+		trajectory_set(NULL);
+		http_send(c, 200, "OK", "application/json; charset=utf-8",
+			  playing ? "{\"ok\":true,\"aborted\":true}" : "{\"ok\":true,\"aborted\":false}");
+		return;
 	}
 
-	BOOL opt = TRUE;
-	setsockopt(g_srv.listen_sock, SOL_SOCKET, SO_REUSEADDR, (const char *)&opt, sizeof(opt));
+	struct tbar_trajectory traj;
+	memset(&traj, 0, sizeof(traj));
+	traj.release = f.present & TBAR_JSON_RELEASE ? f.release : true;
+	if ((f.present & TBAR_JSON_EASING) && !tbar_easing_from_name(f.easing, &traj.easing)) {
+		http_send(c, 400, "Bad Request", "application/json; charset=utf-8", "{\"error\":\"invalid_easing\"}");
+		return;
+	}
 
-	struct sockaddr_in addr;
-	memset(&addr, 0, sizeof(addr));
-	addr.sin_family = AF_INET;
-	addr.sin_port = htons((u_short)g_srv.port);
-	inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+	if (f.present & TBAR_JSON_KEYFRAMES) {
+		traj.count = f.num_keyframes;
+		for (int i = 0; i < traj.count; i++) {
+			traj.points[i].t_ms = keyframes[i].time_ms;
+			traj.points[i].pos = normalize_position(keyframes[i].position);
+		}
+	} else if (f.present & TBAR_JSON_DURATION) {
+		/* From where a running transition is now, unless told otherwise */
+		struct tbar_snapshot snap;
+		tbar_snapshot_read(&snap);
+		const struct tbar_snapshot_channel *sc = &snap.channels[0];
+		double from = sc->live_valid && sc->live_active ? sc->live_position : 0.0;
+		traj.count = 2;
+		traj.points[0].pos = f.present & TBAR_JSON_FROM ? normalize_position(f.from) : from;
+		traj.points[1].t_ms = f.duration_ms;
+		traj.points[1].pos = f.present & TBAR_JSON_TO ? normalize_position(f.to) : 1.0;
+	}
+	if (!tbar_trajectory_validate(&traj)) {
+		http_send(c, 400, "Bad Request", "application/json; charset=utf-8", "{\"error\":\"invalid_trajectory\"}");
+		return;
+	}
 
-	if (bind(g_srv.listen_sock, (struct sockaddr *)&addr, (int)sizeof(addr)) != 0) {
-		obs_log(LOG_ERROR, "tbar-web: bind(127.0.0.1:%d) failed", g_srv.port);
-		closesocket(g_srv.listen_sock);
-		g_srv.listen_sock = INVALID_SOCKET;
-		WSACleanup();
+	trajectory_set(&traj);
+	snprintf(resp, sizeof(resp), "{\"ok\":true,\"duration_ms\":%.3f}", tbar_trajectory_duration_ms(&traj));
+	http_send(c, 200, "OK", "application/json; charset=utf-8", resp);
+}
+
+/* "/tbar" is channel 0 and "/tbar/{channel}" any of them; -1 for other paths */
+static int path_channel(struct tbar_http_str path)
+{
+	if (tbar_http_str_eq(path, "/tbar"))
 		return 0;
+	if (path.len <= 6 || memcmp(path.ptr, "/tbar/", 6) != 0)
+		return -1;
+
+	const char *p = path.ptr + 6;
+	const char *end = path.ptr + path.len;
+	if (*p == '0' && end - p > 1)
+		return -1;
+	int channel = 0;
+	for (; p < end; p++) {
+		if (*p < '0' || *p > '9')
+			return -1;
+		channel = channel * 10 + (*p - '0');
+		if (channel >= TBAR_MAX_CHANNELS)
+			return -1;
 	}
+	return channel;
+}
 
-	if (listen(g_srv.listen_sock, SOMAXCONN) != 0) {
-		obs_log(LOG_ERROR, "tbar-web: listen() failed");
-		closesocket(g_srv.listen_sock);
-		g_srv.listen_sock = INVALID_SOCKET;
-		WSACleanup();
-		return 0;
+/* Routes the web root must not shadow */
+static bool is_api_path(struct tbar_http_str path)
+{
+	return tbar_http_str_eq(path, "/tbar") || (path.len > 6 && memcmp(path.ptr, "/tbar/", 6) == 0) ||
+	       tbar_http_str_eq(path, "/config") || tbar_http_str_eq(path, "/status") ||
+	       tbar_http_str_eq(path, "/metrics") || tbar_http_str_eq(path, "/events") ||
+	       tbar_http_str_eq(path, "/log");
+}
+
+void tbar_web_handle_request(struct tbar_conn *c, const struct tbar_http_request *req, const char *body,
+			     int body_len)
+{
+	enum tbar_http_method method = req->method;
+	struct tbar_http_str path = tbar_http_span_str(req, req->path);
+
+	if (method == TBAR_HTTP_OPTIONS) {
+		http_send(c, 204, "No Content", NULL, "");
+		return;
+	}
+
+	/* Custom control surfaces first; the built-in page is the fallback */
+	if (!is_api_path(path) && tbar_webroot_serve(c, req))
+		return;
+
+	if (tbar_http_str_eq(path, "/favicon.ico")) {
+		http_send(c, 204, "No Content", NULL, "");
+		return;
 	}
 
-	obs_log(LOG_INFO, "tbar-web: listening on http://127.0.0.1:%d", g_srv.port);
+	if (tbar_static_serve(c, req))
+		return;
+
+	if (tbar_http_str_eq(path, "/config")) {
+		static struct tbar_snapshot snap;
+		tbar_snapshot_read(&snap);
+		const struct tbar_snapshot_config *cfg = &snap.config;
 
-	while (!g_srv.stop) {
-		SOCKET client = accept(g_srv.listen_sock, NULL, NULL);
-		if (client == INVALID_SOCKET) {
-			/* likely closed during shutdown */
-			break;
+		if (method == TBAR_HTTP_GET) {
+			char resp[384];
+			snprintf(resp, sizeof(resp),
+				 "{\"enabled\":%s,\"port\":%d,\"udp_enabled\":%s,\"udp_port\":%d,\"tick_apply\":%s,"
+				 "\"interpolation\":\"%s\",\"jitter_delay_ms\":%d,\"header_timeout_ms\":%d,"
+				 "\"body_timeout_ms\":%d,\"max_connections\":%d,\"lease_mode\":\"%s\",\"lease_ms\":%d}",
+				 cfg->enabled ? "true" : "false", cfg->port, cfg->udp_enabled ? "true" : "false",
+				 cfg->udp_port, cfg->tick_apply ? "true" : "false", interp_name(cfg->interpolation),
+				 cfg->jitter_delay_ms, cfg->header_timeout_ms, cfg->body_timeout_ms,
+				 cfg->max_connections, lease_mode_name(cfg->lease_mode), cfg->lease_ms);
+			http_send(c, 200, "OK", "application/json; charset=utf-8", resp);
+			return;
 		}
 
-		char buf[8192];
-		int got = recv(client, buf, (int)sizeof(buf) - 1, 0);
-		if (got <= 0) {
-			closesocket(client);
-			continue;
+		if (method == TBAR_HTTP_POST) {
+			/* { "enabled": true/false, "port": 4455 }; absent fields keep their value */
+			struct tbar_json_fields f;
+			if (!tbar_json_extract(body, (size_t)body_len, &f)) {
+				http_send(c, 400, "Bad Request", "application/json; charset=utf-8",
+					  "{\"error\":\"invalid_json\"}");
+				return;
+			}
+
+			bool enabled = f.present & TBAR_JSON_ENABLED ? f.enabled : cfg->enabled;
+			int port = cfg->port;
+			if ((f.present & TBAR_JSON_PORT) && f.port > 0 && f.port <= 65535)
+				port = f.port;
+
+			/* Saved and applied on the UI thread; we can't stop/restart the server here,
+			   and a hot reload of the file may be rewriting g_cfg there */
+			obs_data_t *update = obs_data_create();
+			if (f.present & TBAR_JSON_ENABLED)
+				obs_data_set_bool(update, "enabled", enabled);
+			if (port != cfg->port)
+				obs_data_set_int(update, "port", port);
+			obs_queue_task(OBS_TASK_UI, cfg_update_task, update, false);
+
+			char resp[128];
+			snprintf(resp, sizeof(resp), "{\"ok\":true,\"enabled\":%s,\"port\":%d}",
+				 enabled ? "true" : "false", port);
+			http_send(c, 200, "OK", "application/json; charset=utf-8", resp);
+			return;
 		}
-		buf[got] = '\0';
 
-		const char *header_end = strstr(buf, "\r\n\r\n");
-		const char *body = "";
-		if (header_end) {
-			body = header_end + 4;
+		http_send(c, 405, "Method Not Allowed", "application/json; charset=utf-8",
+			  "{\"error\":\"method_not_allowed\"}");
+		return;
+	}
+
+	if (tbar_http_str_eq(path, "/log")) {
+		if (method == TBAR_HTTP_GET) {
+			static char buf[65536];
+			if (tbar_log_format_json(buf, sizeof(buf)) < 0) {
+				http_send(c, 500, "Internal Server Error", NULL, "log buffer too small");
+				return;
+			}
+			http_send(c, 200, "OK", "application/json; charset=utf-8", buf);
+			return;
 		}
+		http_send(c, 405, "Method Not Allowed", "application/json; charset=utf-8",
+			  "{\"error\":\"method_not_allowed\"}");
+		return;
+	}
+
+	if (tbar_http_str_eq(path, "/metrics")) {
+		if (method == TBAR_HTTP_GET) {
+			handle_metrics(c);
+			return;
+		}
+		http_send(c, 405, "Method Not Allowed", NULL, "method not allowed");
+		return;
+	}
+
+	if (tbar_http_str_eq(path, "/status")) {
+		if (method == TBAR_HTTP_GET) {
+			static struct tbar_snapshot snap;
+			tbar_snapshot_read(&snap);
+			const struct tbar_snapshot_channel *ch = &snap.channels[0];
+			char resp[448];
+			snprintf(resp, sizeof(resp),
+				 "{\"ok\":true,\"enabled\":%s,\"port\":%d,\"manual_active\":%s,\"last_position\":%.6f,"
+				 "\"version\":%llu,\"updates\":{\"submitted\":%ld,\"applied\":%llu,"
+				 "\"applied_on_tick\":%llu,\"coalesced\":%ld},"
+				 "\"udp\":{\"port\":%d,\"received\":%ld,\"applied\":%ld,\"dropped_stale\":%ld,"
+				 "\"invalid\":%ld}}",
+				 snap.config.enabled ? "true" : "false", snap.config.port, ch->manual_active ? "true" : "false",
+				 ch->position,
+				 (unsigned long long)snap.version, os_atomic_load_long(&g_updates.submitted),
+				 (unsigned long long)snap.applied, (unsigned long long)snap.applied_on_tick,
+				 os_atomic_load_long(&g_updates.coalesced),
+				 g_srv.udp_port, os_atomic_load_long(&tbar_udp_stats.received),
+				 os_atomic_load_long(&tbar_udp_stats.applied),
+				 os_atomic_load_long(&tbar_udp_stats.dropped_stale),
+				 os_atomic_load_long(&tbar_udp_stats.invalid));
+			http_send(c, 200, "OK", "application/json; charset=utf-8", resp);
+			return;
+		}
+		http_send(c, 405, "Method Not Allowed", "application/json; charset=utf-8",
+			  "{\"error\":\"method_not_allowed\"}");
+		return;
+	}
 
-		/* Best effort: if Content-Length exists and body incomplete, read more. */
-		int content_len = 0;
-		const char *cl = find_header_value(buf, "Content-Length");
-		if (cl) {
-			content_len = atoi(cl);
+	if (tbar_http_str_eq(path, "/events")) {
+		if (method == TBAR_HTTP_GET) {
+			tbar_sse_accept(c);
+			/* Start the stream with the current state */
+			struct tbar_snapshot snap;
+			tbar_snapshot_read(&snap);
+			char state[STATE_JSON_SIZE];
+			int n = format_state_json(state, sizeof(state), &snap, true, NULL);
+			if (n > 0)
+				tbar_sse_send(c, "state", state, (size_t)n);
+			return;
 		}
+		http_send(c, 405, "Method Not Allowed", "application/json; charset=utf-8",
+			  "{\"error\":\"method_not_allowed\"}");
+		return;
+	}
 
-		/* If declared content length larger than what we already have, read remaining (up to buffer). */
-		int have_body = (int)strlen(body);
-		if (content_len > have_body && header_end) {
-			int remaining = content_len - have_body;
-			int space = (int)sizeof(buf) - 1 - got;
-			if (remaining > 0 && space > 0) {
-				int to_read = remaining < space ? remaining : space;
-				int got2 = recv(client, buf + got, to_read, 0);
-				if (got2 > 0) {
-					got += got2;
-					buf[got] = '\0';
-					header_end = strstr(buf, "\r\n\r\n");
-					body = header_end ? header_end + 4 : "";
-				}
+	if (tbar_http_str_eq(path, "/tbar/ws")) {
+		if (method == TBAR_HTTP_GET) {
+			if (tbar_ws_accept(c, req)) {
+				/* Start the stream with the current state */
+				struct tbar_snapshot snap;
+				tbar_snapshot_read(&snap);
+				char msg[STATE_JSON_SIZE];
+				int n = format_state_json(msg, sizeof(msg), &snap, false, NULL);
+				if (n > 0)
+					tbar_ws_send_text(c, msg, (size_t)n);
 			}
+			return;
 		}
+		http_send(c, 405, "Method Not Allowed", "application/json; charset=utf-8",
+			  "{\"error\":\"method_not_allowed\"}");
+		return;
+	}
 
-		handle_request(client, buf, body, content_len);
-		closesocket(client);
+	if (tbar_http_str_eq(path, "/tbar/trajectory")) {
+		if (method == TBAR_HTTP_GET) {
+			http_send(c, 200, "OK", "application/json; charset=utf-8",
+				  os_atomic_load_bool(&g_traj.playing) ? "{\"playing\":true}" : "{\"playing\":false}");
+			return;
+		}
+		if (method == TBAR_HTTP_POST) {
+			handle_trajectory(c, body, body_len);
+			return;
+		}
+		http_send(c, 405, "Method Not Allowed", "application/json; charset=utf-8",
+			  "{\"error\":\"method_not_allowed\"}");
+		return;
 	}
 
-	if (g_srv.listen_sock != INVALID_SOCKET) {
-		closesocket(g_srv.listen_sock);
-		g_srv.listen_sock = INVALID_SOCKET;
+	int channel = path_channel(path);
+	if (channel < 0) {
+		http_send(c, 404, "Not Found", "application/json; charset=utf-8",
+			  "{\"error\":\"not_found\"}");
+		return;
+	}
+	struct channel *ch = &g_channels[channel];
+
+	if (method == TBAR_HTTP_GET) {
+		char resp[160];
+		struct tbar_snapshot snap;
+		tbar_snapshot_read(&snap);
+		const struct tbar_snapshot_channel *sc = &snap.channels[channel];
+		if (sc->live_valid) {
+			snprintf(resp, sizeof(resp),
+				 "{\"position\":%.6f,\"active\":%s,\"source\":\"live\",\"version\":%llu}",
+				 sc->live_position, sc->live_active ? "true" : "false",
+				 (unsigned long long)snap.version);
+		} else {
+			/* No frame rendered yet (or the channel was never used): the last position applied */
+			snprintf(resp, sizeof(resp), "{\"position\":%.6f,\"source\":\"cached\",\"version\":%llu}",
+				 sc->position, (unsigned long long)snap.version);
+		}
+		/* Sampled from the next frame on */
+		channel_mark_used(channel);
+		http_send(c, 200, "OK", "application/json; charset=utf-8", resp);
+		return;
 	}
-	WSACleanup();
 
-	obs_log(LOG_INFO, "tbar-web: stopped");
-	return 0;
+	if (method == TBAR_HTTP_POST) {
+		double pos = 0.0;
+		bool release = false;
+		double sender_ms = -1.0;
+		struct tbar_json_fields f;
+		if (!parse_position_json(body, (size_t)body_len, &f, &pos, &release, &sender_ms)) {
+			http_send(c, 400, "Bad Request", "application/json; charset=utf-8",
+				  "{\"error\":\"invalid_json\"}");
+			return;
+		}
+
+		char resp[256];
+		int status = arbitrate(channel, &f, release, resp, sizeof(resp));
+		if (status != 200) {
+			http_send(c, status, status == 202 ? "Accepted" : "Conflict", "application/json; charset=utf-8",
+				  resp);
+			return;
+		}
+
+		/* The main output follows the Studio Mode preview instead */
+		if (channel != 0 && (f.present & TBAR_JSON_SCENE)) {
+			pthread_mutex_lock(&ch->scene_mutex);
+			memcpy(ch->next_scene, f.scene, sizeof(ch->next_scene));
+			pthread_mutex_unlock(&ch->scene_mutex);
+		}
+		tbar_web_submit_timed_position(channel, TBAR_SOURCE_HTTP, pos, release, sender_ms);
+
+		http_send(c, 200, "OK", "application/json; charset=utf-8",
+			  "{\"ok\":true}");
+		return;
+	}
+
+	http_send(c, 405, "Method Not Allowed", "application/json; charset=utf-8",
+		  "{\"error\":\"method_not_allowed\"}");
 }
 
 bool tbar_web_start(int port)
@@ -886,58 +2231,117 @@ bool tbar_web_start(int port)
 	if (port <= 0 || port > 65535)
 		port = 4455;
 
-	g_srv.port = port;
-	g_srv.stop = false;
-	g_srv.listen_sock = INVALID_SOCKET;
-	g_srv.last_position = 0.0;
+	int udp_port = g_cfg.udp_enabled ? g_cfg.udp_port : 0;
 
-	uintptr_t th = _beginthreadex(NULL, 0, server_thread, NULL, 0, NULL);
-	if (th == 0) {
-		obs_log(LOG_ERROR, "tbar-web: failed to start thread (_beginthreadex)");
+	g_srv.port = port;
+	g_srv.udp_port = udp_port;
+	g_srv.tick_apply = g_cfg.tick_apply;
+	g_srv.interp = g_cfg.tick_apply ? g_cfg.interpolation : TBAR_INTERP_OFF;
+	g_srv.jitter_delay_ns = (uint64_t)g_cfg.jitter_delay_ms * 1000000;
+	g_srv.limits.header_timeout_ms = g_cfg.header_timeout_ms;
+	g_srv.limits.body_timeout_ms = g_cfg.body_timeout_ms;
+	g_srv.limits.max_conns = g_cfg.max_connections;
+	tbar_http_set_limits(&g_srv.limits);
+	g_srv.lease_mode = g_cfg.lease_mode;
+	g_srv.lease_ns = (uint64_t)g_cfg.lease_ms * 1000000;
+	channels_init();
+	for (int i = 0; i < TBAR_MAX_CHANNELS; i++) {
+		g_channels[i].requested = 0.0;
+		tbar_jitter_reset(&g_channels[i].jitter);
+	}
+	tbar_udp_reset();
+	tbar_arbiter_reset(g_srv.lease_mode, g_srv.lease_ns);
+
+	/* Nothing records before the server and the tick are up */
+	snprintf(g_srv.record_path, sizeof(g_srv.record_path), "%s", g_cfg.record_path);
+	g_srv.record_max_mb = g_cfg.record_max_mb;
+	if (g_srv.record_path[0])
+		tbar_record_open(g_srv.record_path, (size_t)g_srv.record_max_mb << 20);
+
+	snprintf(g_srv.web_root, sizeof(g_srv.web_root), "%s", g_cfg.web_root);
+	g_srv.web_cache_mb = g_cfg.web_cache_mb;
+	tbar_webroot_open(g_srv.web_root, (size_t)g_srv.web_cache_mb << 20);
+
+	tbar_static_add("/index.html", "text/html; charset=utf-8", g_index_html, sizeof(g_index_html) - 1);
+	tbar_static_init();
+
+	if (!tbar_server_start(port, udp_port)) {
+		tbar_static_free();
+		tbar_webroot_close();
+		tbar_record_close();
+		g_srv.tick_apply = false;
 		return false;
 	}
 
-	g_srv.thread = (HANDLE)th;
 	g_srv.running = true;
+	tbar_log_start();
+	obs_add_tick_callback(video_tick, NULL);
+#ifdef ENABLE_FRONTEND_API
+	obs_frontend_add_event_callback(on_frontend_event, NULL);
+	refresh_tally();
+#endif
 	return true;
 }
 
+/* UI thread, with the tick and the server stopped: a restart begins from a
+   clean fader on every channel. A manual transition still running is cancelled
+   rather than left for a later update to drive through a stale reference. */
+static void channels_reset(void)
+{
+	struct tbar_snapshot_ui *s = tbar_snapshot_begin();
+	for (int i = 0; i < TBAR_MAX_CHANNELS; i++) {
+		struct channel *ch = &g_channels[i];
+		/* A set_pos_task still queued finds nothing to apply */
+		mailbox_take(&ch->input);
+		mailbox_take(&ch->ui_input);
+#ifdef ENABLE_FRONTEND_API
+		if (ch->fader.manual_active && ch->live) {
+			struct fader_obs ctx = {.ch = ch, .transition = ch->live};
+			fader_cancel(&ctx);
+			obs_log(LOG_INFO, "tbar-web: cancelled the manual transition on channel %d", i);
+		}
+		manual_clear_state(ch);
+#endif
+		memset(&ch->fader, 0, sizeof(ch->fader));
+		s->channels[i].manual_active = false;
+	}
+	tbar_snapshot_end();
+}
+
 void tbar_web_stop(void)
 {
 	if (!g_srv.running)
 		return;
 
-	g_srv.stop = true;
-	/* Force accept() to wake up */
-	if (g_srv.listen_sock != INVALID_SOCKET) {
-		closesocket(g_srv.listen_sock);
-		g_srv.listen_sock = INVALID_SOCKET;
-	}
+	/* Unregistering waits for a running tick, so it can no longer wake the server */
+	obs_remove_tick_callback(video_tick, NULL);
+	g_srv.tick_apply = false;
+	trajectory_set(NULL);
+	readback_detach_all();
+#ifdef ENABLE_FRONTEND_API
+	obs_frontend_remove_event_callback(on_frontend_event, NULL);
+#endif
 
-	WaitForSingleObject(g_srv.thread, INFINITE);
-	CloseHandle(g_srv.thread);
-	g_srv.thread = NULL;
+	tbar_server_stop();
+	channels_reset();
+	/* Connections may have referenced the prebuilt responses until now */
+	tbar_static_free();
+	tbar_webroot_close();
+	tbar_record_close();
+	tbar_log_stop();
 	g_srv.running = false;
 }
 
 void tbar_web_apply_config(void)
 {
+	g_cfg_closing = false;
 	cfg_load();
+	tbar_config_open(cfg_path(), cfg_changed);
 	cfg_apply();
 }
 
-#else /* _WIN32 */
-
-bool tbar_web_start(int port)
+void tbar_web_close_config(void)
 {
-	(void)port;
-	obs_log(LOG_WARNING, "tbar-web: HTTP server not implemented on this platform yet");
-	return false;
+	g_cfg_closing = true;
+	tbar_config_close();
 }
-
-void tbar_web_stop(void) {}
-
-void tbar_web_apply_config(void) {}
-
-#endif
-
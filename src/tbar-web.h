@@ -18,6 +18,8 @@ with this program. If not, see <https://www.gnu.org/licenses/>
 
 #pragma once
 
+#include "tbar-record.h"
+
 #include <stdbool.h>
 
 #ifdef __cplusplus
@@ -27,8 +29,27 @@ extern "C" {
 bool tbar_web_start(int port);
 void tbar_web_stop(void);
 
-/* Loads config (enabled/port) from module config path and (re)starts server accordingly */
+/* Loads config (enabled/port) from module config path and (re)starts server accordingly.
+   Later edits to the file are picked up while OBS runs (Linux). */
 void tbar_web_apply_config(void);
+/* Flushes a config write still pending and stops watching the file. Config
+   changes still queued for the UI thread are dropped from then on; call it
+   before tbar_web_stop() when unloading. */
+void tbar_web_close_config(void);
+
+/* OBS output channels with a T-bar of their own (0 is the main program output) */
+#define TBAR_MAX_CHANNELS 8
+
+/* Internal, used by the transports (HTTP, WebSocket, UDP): hands a position
+   (0..1) for output `channel` to the UI thread. Never blocks or allocates; if
+   the UI thread has not caught up, the previous pending position is replaced.
+   `source` is noted in the session recording. */
+void tbar_web_submit_position(int channel, enum tbar_record_source source, double pos, bool release);
+/* Same, with the controller's timestamp in milliseconds (any epoch) for the
+   jitter buffer; a negative, non-finite or out-of-range (>= 2^53) value means none */
+void tbar_web_submit_timed_position(int channel, enum tbar_record_source source, double pos, bool release,
+				    double sender_ms);
+double tbar_web_last_position(int channel);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,466 @@
+/*
+Plugin Name
+Copyright (C) <Year> <Developer> <Email Address>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include "tbar-webroot.h"
+
+#include <obs-module.h>
+#include <plugin-support.h>
+#include <util/platform.h>
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#define MAX_ENTRIES 64
+#define MAX_URL_PATH 256
+#define REVALIDATE_NS 1000000000ULL /* stat() a cached file at most this often */
+
+/* What tells two versions of a file apart */
+struct file_id {
+	uint64_t size;
+	uint64_t mtime_ns;
+	uint64_t ino;
+};
+
+struct entry {
+	char path[MAX_URL_PATH]; /* decoded request path; empty if the slot is free */
+	struct tbar_shared_buf *body;
+	const char *content_type;
+	char etag[48];
+	struct file_id id;
+	uint64_t checked_ns;
+	uint64_t last_used;
+};
+
+static struct {
+	char dir[512];
+	size_t max_bytes;
+	size_t bytes; /* cached file contents */
+	uint64_t use_clock;
+	struct entry entries[MAX_ENTRIES];
+} g_root;
+
+static const struct {
+	const char *ext;
+	const char *type;
+} g_mime[] = {
+	{"html", "text/html; charset=utf-8"},
+	{"htm", "text/html; charset=utf-8"},
+	{"js", "text/javascript; charset=utf-8"},
+	{"mjs", "text/javascript; charset=utf-8"},
+	{"css", "text/css; charset=utf-8"},
+	{"json", "application/json; charset=utf-8"},
+	{"map", "application/json; charset=utf-8"},
+	{"webmanifest", "application/manifest+json"},
+	{"txt", "text/plain; charset=utf-8"},
+	{"svg", "image/svg+xml"},
+	{"png", "image/png"},
+	{"jpg", "image/jpeg"},
+	{"jpeg", "image/jpeg"},
+	{"gif", "image/gif"},
+	{"webp", "image/webp"},
+	{"ico", "image/x-icon"},
+	{"woff", "font/woff"},
+	{"woff2", "font/woff2"},
+	{"ttf", "font/ttf"},
+	{"otf", "font/otf"},
+	{"wasm", "application/wasm"},
+	{"mp3", "audio/mpeg"},
+	{"wav", "audio/wav"},
+	{"mp4", "video/mp4"},
+	{"webm", "video/webm"},
+};
+
+static const char *mime_type(const char *path)
+{
+	const char *dot = strrchr(path, '.');
+	if (!dot || strchr(dot, '/'))
+		return "application/octet-stream";
+
+	char ext[16];
+	size_t n = 0;
+	for (const char *p = dot + 1; *p && n + 1 < sizeof(ext); p++)
+		ext[n++] = (char)(*p >= 'A' && *p <= 'Z' ? *p - 'A' + 'a' : *p);
+	ext[n] = '\0';
+
+	for (size_t i = 0; i < sizeof(g_mime) / sizeof(g_mime[0]); i++) {
+		if (strcmp(ext, g_mime[i].ext) == 0)
+			return g_mime[i].type;
+	}
+	return "application/octet-stream";
+}
+
+static int hex_digit(char ch)
+{
+	if (ch >= '0' && ch <= '9')
+		return ch - '0';
+	if (ch >= 'a' && ch <= 'f')
+		return ch - 'a' + 10;
+	if (ch >= 'A' && ch <= 'F')
+		return ch - 'A' + 10;
+	return -1;
+}
+
+/* Percent-decodes the request path into `out` and refuses anything that could
+   leave the web root: "." or ".." segments, backslashes, drive colons, control
+   characters. A trailing slash means index.html. */
+static bool decode_path(struct tbar_http_str path, char *out, size_t size)
+{
+	if (!path.len || path.ptr[0] != '/')
+		return false;
+
+	size_t o = 0;
+	for (size_t i = 0; i < path.len; i++) {
+		char ch = path.ptr[i];
+		if (ch == '%') {
+			int hi = i + 2 < path.len ? hex_digit(path.ptr[i + 1]) : -1;
+			int lo = i + 2 < path.len ? hex_digit(path.ptr[i + 2]) : -1;
+			if (hi < 0 || lo < 0)
+				return false;
+			ch = (char)(hi << 4 | lo);
+			i += 2;
+		}
+		if ((unsigned char)ch < 0x20 || ch == '\\' || ch == ':' || o + 1 >= size)
+			return false;
+		out[o++] = ch;
+	}
+	out[o] = '\0';
+
+	for (const char *seg = out; seg; seg = strchr(seg + 1, '/')) {
+		if (strncmp(seg, "/./", 3) == 0 || strcmp(seg, "/.") == 0 || strncmp(seg, "/../", 4) == 0 ||
+		    strcmp(seg, "/..") == 0)
+			return false;
+	}
+
+	if (out[o - 1] == '/') {
+		if (o + sizeof("index.html") > size)
+			return false;
+		memcpy(out + o, "index.html", sizeof("index.html"));
+	}
+	return true;
+}
+
+static bool stat_file(const char *file, struct file_id *id)
+{
+	struct stat st;
+#ifdef _WIN32
+	if (os_stat(file, &st) != 0 || (st.st_mode & _S_IFMT) != _S_IFREG)
+		return false;
+	id->mtime_ns = (uint64_t)st.st_mtime * 1000000000ULL;
+	id->ino = 0;
+#else
+	if (stat(file, &st) != 0 || !S_ISREG(st.st_mode))
+		return false;
+#ifdef __APPLE__
+	id->mtime_ns = (uint64_t)st.st_mtimespec.tv_sec * 1000000000ULL + (uint64_t)st.st_mtimespec.tv_nsec;
+#else
+	id->mtime_ns = (uint64_t)st.st_mtim.tv_sec * 1000000000ULL + (uint64_t)st.st_mtim.tv_nsec;
+#endif
+	id->ino = (uint64_t)st.st_ino;
+#endif
+	id->size = (uint64_t)st.st_size;
+	return true;
+}
+
+static void free_bytes(const char *bytes, size_t len)
+{
+	(void)len;
+	free((void *)bytes);
+}
+
+/* Reads the whole file into the heap. Not mmap(): the files are meant to be
+   edited while OBS runs, and touching a mapping of a file truncated in place
+   raises SIGBUS. Reads to EOF whatever the earlier stat() said and corrects
+   `id->size`; an edit racing the read shows up as a changed mtime on the
+   next revalidation. Gives up (NULL, `*too_big`) past `max` bytes. */
+static struct tbar_shared_buf *load_file(const char *file, struct file_id *id, size_t max, bool *too_big)
+{
+	*too_big = false;
+	FILE *f = os_fopen(file, "rb");
+	if (!f)
+		return NULL;
+
+	size_t cap = (size_t)id->size + 1;
+	size_t len = 0;
+	char *bytes = malloc(cap);
+	while (bytes) {
+		len += fread(bytes + len, 1, cap - len, f);
+		if (len < cap)
+			break;
+		if (len > max) {
+			/* Grew past the cache limit since it was stat()ed */
+			*too_big = true;
+			free(bytes);
+			bytes = NULL;
+			break;
+		}
+		char *grown = realloc(bytes, cap * 2);
+		if (!grown)
+			free(bytes);
+		bytes = grown;
+		cap *= 2;
+	}
+	bool ok = bytes && !ferror(f);
+	fclose(f);
+	if (!ok) {
+		free(bytes);
+		return NULL;
+	}
+	id->size = len;
+	return tbar_shared_buf_wrap(bytes, len, free_bytes);
+}
+
+static void entry_drop(struct entry *e)
+{
+	g_root.bytes -= e->body->len;
+	tbar_shared_buf_release(e->body);
+	memset(e, 0, sizeof(*e));
+}
+
+/* A free slot with room for `len` more bytes, evicting least recently used entries */
+static struct entry *entry_alloc(size_t len)
+{
+	for (;;) {
+		struct entry *lru = NULL;
+		struct entry *free_slot = NULL;
+		for (int i = 0; i < MAX_ENTRIES; i++) {
+			struct entry *e = &g_root.entries[i];
+			if (!e->path[0])
+				free_slot = free_slot ? free_slot : e;
+			else if (!lru || e->last_used < lru->last_used)
+				lru = e;
+		}
+		if (free_slot && g_root.bytes + len <= g_root.max_bytes)
+			return free_slot;
+		if (!lru)
+			return NULL;
+		entry_drop(lru);
+	}
+}
+
+static struct entry *lookup(const char *path, uint64_t now_ns)
+{
+	struct entry *e = NULL;
+	for (int i = 0; i < MAX_ENTRIES && !e; i++) {
+		if (g_root.entries[i].path[0] && strcmp(g_root.entries[i].path, path) == 0)
+			e = &g_root.entries[i];
+	}
+	if (!e || now_ns - e->checked_ns < REVALIDATE_NS)
+		return e;
+
+	char file[sizeof(g_root.dir) + MAX_URL_PATH];
+	snprintf(file, sizeof(file), "%s%s", g_root.dir, path);
+	struct file_id id;
+	if (stat_file(file, &id) && memcmp(&id, &e->id, sizeof(id)) == 0) {
+		e->checked_ns = now_ns;
+		return e;
+	}
+	entry_drop(e);
+	return NULL;
+}
+
+/* Parses a single "bytes=" range against `size`. Returns 1 with [*first, *last],
+   0 to ignore the header (absent, malformed or several ranges) and -1 if it
+   cannot be satisfied. */
+static int parse_range(struct tbar_http_str value, uint64_t size, uint64_t *first, uint64_t *last)
+{
+	const char *p = value.ptr;
+	const char *end = value.ptr + value.len;
+	if (!p || value.len < 7 || memcmp(p, "bytes=", 6) != 0 || memchr(p, ',', value.len))
+		return 0;
+	p += 6;
+
+	bool has_a = false;
+	bool has_b = false;
+	uint64_t a = 0;
+	uint64_t b = 0;
+	for (; p < end && *p >= '0' && *p <= '9'; p++, has_a = true)
+		a = a * 10 + (uint64_t)(*p - '0');
+	if (p == end || *p != '-')
+		return 0;
+	for (p++; p < end && *p >= '0' && *p <= '9'; p++, has_b = true)
+		b = b * 10 + (uint64_t)(*p - '0');
+	if (p != end || (!has_a && !has_b) || (has_a && has_b && b < a))
+		return 0;
+
+	if (!has_a) {
+		/* The last b bytes */
+		if (!b || !size)
+			return -1;
+		*first = b < size ? size - b : 0;
+		*last = size - 1;
+		return 1;
+	}
+	if (a >= size)
+		return -1;
+	*first = a;
+	*last = has_b && b < size ? b : size - 1;
+	return 1;
+}
+
+static void respond(struct tbar_conn *c, const struct tbar_http_request *req, struct tbar_shared_buf *body,
+		    const char *content_type, const char *etag)
+{
+	const char *connection = c->keep_alive ? "keep-alive" : "close";
+	uint64_t size = body->len;
+	char header[640];
+	int n;
+
+	struct tbar_http_str inm = tbar_http_header(req, "If-None-Match");
+	if (inm.ptr && inm.len == strlen(etag) && memcmp(inm.ptr, etag, inm.len) == 0) {
+		n = snprintf(header, sizeof(header),
+			     "HTTP/1.1 304 Not Modified\r\n"
+			     "ETag: %s\r\n"
+			     "Cache-Control: no-cache\r\n"
+			     "Connection: %s\r\n"
+			     "\r\n",
+			     etag, connection);
+		tbar_conn_write(c, header, (size_t)n);
+		return;
+	}
+
+	/* If-Range: the range only applies to the version the client already has */
+	uint64_t first = 0;
+	uint64_t last = 0;
+	int range = 0;
+	struct tbar_http_str if_range = tbar_http_header(req, "If-Range");
+	if (!if_range.ptr || (if_range.len == strlen(etag) && memcmp(if_range.ptr, etag, if_range.len) == 0))
+		range = parse_range(tbar_http_header(req, "Range"), size, &first, &last);
+
+	if (range < 0) {
+		n = snprintf(header, sizeof(header),
+			     "HTTP/1.1 416 Range Not Satisfiable\r\n"
+			     "Content-Range: bytes */%llu\r\n"
+			     "Content-Length: 0\r\n"
+			     "Connection: %s\r\n"
+			     "\r\n",
+			     (unsigned long long)size, connection);
+		tbar_conn_write(c, header, (size_t)n);
+		return;
+	}
+
+	char content_range[96] = "";
+	if (range > 0)
+		snprintf(content_range, sizeof(content_range), "Content-Range: bytes %llu-%llu/%llu\r\n",
+			 (unsigned long long)first, (unsigned long long)last, (unsigned long long)size);
+	else if (size)
+		last = size - 1;
+	uint64_t len = size ? last - first + 1 : 0;
+
+	n = snprintf(header, sizeof(header),
+		     "HTTP/1.1 %s\r\n"
+		     "Content-Type: %s\r\n"
+		     "Content-Length: %llu\r\n"
+		     "%s"
+		     "Accept-Ranges: bytes\r\n"
+		     "ETag: %s\r\n"
+		     "Cache-Control: no-cache\r\n"
+		     "Connection: %s\r\n"
+		     "Access-Control-Allow-Origin: *\r\n"
+		     "\r\n",
+		     range > 0 ? "206 Partial Content" : "200 OK", content_type, (unsigned long long)len,
+		     content_range, etag, connection);
+	if (n <= 0 || (size_t)n >= sizeof(header)) {
+		http_send(c, 500, "Internal Server Error", NULL, "header too large");
+		return;
+	}
+	tbar_conn_write(c, header, (size_t)n);
+	if (req->method == TBAR_HTTP_GET)
+		tbar_conn_write_shared_range(c, body, (size_t)first, (size_t)len);
+}
+
+bool tbar_webroot_serve(struct tbar_conn *c, const struct tbar_http_request *req)
+{
+	if (!g_root.dir[0] || (req->method != TBAR_HTTP_GET && req->method != TBAR_HTTP_HEAD))
+		return false;
+
+	char path[MAX_URL_PATH];
+	if (!decode_path(tbar_http_span_str(req, req->path), path, sizeof(path)))
+		return false;
+
+	uint64_t now = os_gettime_ns();
+	struct entry *e = lookup(path, now);
+	if (e) {
+		e->last_used = ++g_root.use_clock;
+		respond(c, req, e->body, e->content_type, e->etag);
+		return true;
+	}
+
+	char file[sizeof(g_root.dir) + MAX_URL_PATH];
+	snprintf(file, sizeof(file), "%s%s", g_root.dir, path);
+	struct file_id id;
+	if (!stat_file(file, &id))
+		return false;
+
+	/* Every miss is read on the socket thread, so only what the cache can
+	   keep is read at all: one large asset must not stall position updates */
+	bool too_big = id.size > g_root.max_bytes;
+	struct tbar_shared_buf *body = too_big ? NULL : load_file(file, &id, g_root.max_bytes, &too_big);
+	if (too_big) {
+		http_send(c, 404, "Not Found", NULL, "file is larger than web_cache_mb");
+		return true;
+	}
+	if (!body) {
+		obs_log(LOG_WARNING, "tbar-web: could not read %s", file);
+		return false;
+	}
+
+	char etag[48];
+	snprintf(etag, sizeof(etag), "\"%llx-%llx\"", (unsigned long long)id.size, (unsigned long long)id.mtime_ns);
+	const char *content_type = mime_type(path);
+
+	e = entry_alloc(body->len);
+	if (e) {
+		snprintf(e->path, sizeof(e->path), "%s", path);
+		e->body = body;
+		e->content_type = content_type;
+		snprintf(e->etag, sizeof(e->etag), "%s", etag);
+		e->id = id;
+		e->checked_ns = now;
+		e->last_used = ++g_root.use_clock;
+		g_root.bytes += body->len;
+	}
+	respond(c, req, body, content_type, etag);
+	if (!e)
+		tbar_shared_buf_release(body);
+	return true;
+}
+
+void tbar_webroot_open(const char *dir, size_t max_bytes)
+{
+	tbar_webroot_close();
+	snprintf(g_root.dir, sizeof(g_root.dir), "%s", dir ? dir : "");
+	size_t len = strlen(g_root.dir);
+	while (len && (g_root.dir[len - 1] == '/' || g_root.dir[len - 1] == '\\'))
+		g_root.dir[--len] = '\0';
+	g_root.max_bytes = max_bytes;
+	if (len)
+		obs_log(LOG_INFO, "tbar-web: serving files from %s", g_root.dir);
+}
+
+void tbar_webroot_close(void)
+{
+	for (int i = 0; i < MAX_ENTRIES; i++) {
+		if (g_root.entries[i].path[0])
+			entry_drop(&g_root.entries[i]);
+	}
+	g_root.dir[0] = '\0';
+	g_root.use_clock = 0;
+}
@@ -0,0 +1,57 @@
+/*
+Plugin Name
+Copyright (C) <Year> <Developer> <Email Address>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#pragma once
+
+#include "tbar-http.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Files under a configurable directory (`web_root`), for custom control
+   surfaces. Server thread only.
+
+   A file is read into memory on first request (not mapped, since it may be
+   edited or truncated while it is being sent). It is then queued on every
+   connection that asks for it by reference, so a dozen tablets fetching the
+   same bundle share one copy and cost the socket thread a header each. The
+   cache is bounded by size, least recently used entries go first; an entry
+   still being sent stays alive until its last connection is done. A file
+   larger than the whole cache is refused (404) without being read. A cached
+   file is stat()ed again at most once a second and reloaded if it changed.
+
+   Responses carry a MIME type from the extension, a strong ETag
+   (If-None-Match -> 304) and support a single byte range (206/416). */
+
+/* `dir` may be empty (nothing is served); call before the server starts */
+void tbar_webroot_open(const char *dir, size_t max_bytes);
+
+/* Drops the cache; call after the server has stopped */
+void tbar_webroot_close(void);
+
+/* Answers GET/HEAD for a file under the web root. Returns false if there is
+   no such file, so the caller can fall back to the built-in assets. */
+bool tbar_webroot_serve(struct tbar_conn *c, const struct tbar_http_request *req);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,334 @@
+/*
+Plugin Name
+Copyright (C) <Year> <Developer> <Email Address>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include "tbar-ws.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define WS_GUID "258EAFA5-E914-47DA-95CA-C5AB0DC85B11"
+
+#define WS_OP_CONT 0x0
+#define WS_OP_TEXT 0x1
+#define WS_OP_BINARY 0x2
+#define WS_OP_CLOSE 0x8
+#define WS_OP_PING 0x9
+#define WS_OP_PONG 0xA
+
+#define WS_CLOSE_NORMAL 1000
+#define WS_CLOSE_PROTOCOL 1002
+#define WS_CLOSE_UNSUPPORTED 1003
+#define WS_CLOSE_TOO_BIG 1009
+
+/* ------------------------------ */
+/* SHA-1 + base64 (handshake only) */
+/* ------------------------------ */
+
+#define ROL32(v, n) (((v) << (n)) | ((v) >> (32 - (n))))
+
+static void sha1_block(uint32_t h[5], const uint8_t *p)
+{
+	uint32_t w[80];
+	for (int i = 0; i < 16; i++)
+		w[i] = (uint32_t)p[i * 4] << 24 | (uint32_t)p[i * 4 + 1] << 16 | (uint32_t)p[i * 4 + 2] << 8 |
+		       (uint32_t)p[i * 4 + 3];
+	for (int i = 16; i < 80; i++)
+		w[i] = ROL32(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+
+	uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4];
+	for (int i = 0; i < 80; i++) {
+		uint32_t f, k;
+		if (i < 20) {
+			f = (b & c) | (~b & d);
+			k = 0x5A827999;
+		} else if (i < 40) {
+			f = b ^ c ^ d;
+			k = 0x6ED9EBA1;
+		} else if (i < 60) {
+			f = (b & c) | (b & d) | (c & d);
+			k = 0x8F1BBCDC;
+		} else {
+			f = b ^ c ^ d;
+			k = 0xCA62C1D6;
+		}
+		uint32_t t = ROL32(a, 5) + f + e + k + w[i];
+		e = d;
+		d = c;
+		c = ROL32(b, 30);
+		b = a;
+		a = t;
+	}
+
+	h[0] += a;
+	h[1] += b;
+	h[2] += c;
+	h[3] += d;
+	h[4] += e;
+}
+
+static void sha1(const uint8_t *data, size_t len, uint8_t out[20])
+{
+	uint32_t h[5] = {0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0};
+	uint8_t block[64];
+	size_t i = 0;
+
+	for (; i + 64 <= len; i += 64)
+		sha1_block(h, data + i);
+
+	size_t rem = len - i;
+	memset(block, 0, sizeof(block));
+	memcpy(block, data + i, rem);
+	block[rem] = 0x80;
+	if (rem >= 56) {
+		sha1_block(h, block);
+		memset(block, 0, sizeof(block));
+	}
+
+	uint64_t bits = (uint64_t)len * 8;
+	for (int j = 0; j < 8; j++)
+		block[63 - j] = (uint8_t)(bits >> (j * 8));
+	sha1_block(h, block);
+
+	for (int j = 0; j < 5; j++) {
+		out[j * 4] = (uint8_t)(h[j] >> 24);
+		out[j * 4 + 1] = (uint8_t)(h[j] >> 16);
+		out[j * 4 + 2] = (uint8_t)(h[j] >> 8);
+		out[j * 4 + 3] = (uint8_t)h[j];
+	}
+}
+
+static size_t base64_encode(const uint8_t *in, size_t len, char *out)
+{
+	static const char tbl[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+	size_t o = 0;
+
+	for (size_t i = 0; i < len; i += 3) {
+		uint32_t v = (uint32_t)in[i] << 16;
+		if (i + 1 < len)
+			v |= (uint32_t)in[i + 1] << 8;
+		if (i + 2 < len)
+			v |= in[i + 2];
+
+		out[o++] = tbl[(v >> 18) & 63];
+		out[o++] = tbl[(v >> 12) & 63];
+		out[o++] = i + 1 < len ? tbl[(v >> 6) & 63] : '=';
+		out[o++] = i + 2 < len ? tbl[v & 63] : '=';
+	}
+	out[o] = '\0';
+	return o;
+}
+
+/* ------------------------------ */
+/* Handshake                      */
+/* ------------------------------ */
+
+bool tbar_ws_accept(struct tbar_conn *c, const struct tbar_http_request *req)
+{
+	struct tbar_http_str upgrade = tbar_http_header(req, "Upgrade");
+	struct tbar_http_str key = tbar_http_header(req, "Sec-WebSocket-Key");
+	struct tbar_http_str version = tbar_http_header(req, "Sec-WebSocket-Version");
+
+	if (!tbar_http_has_token(upgrade, "websocket") || !req->connection_upgrade ||
+	    !tbar_http_str_eq(version, "13")) {
+		http_send(c, 400, "Bad Request", "application/json; charset=utf-8",
+			  "{\"error\":\"websocket_upgrade_required\"}");
+		return false;
+	}
+
+	size_t key_len = key.len;
+	if (key_len == 0 || key_len > 64) {
+		http_send(c, 400, "Bad Request", "application/json; charset=utf-8",
+			  "{\"error\":\"bad_websocket_key\"}");
+		return false;
+	}
+
+	char concat[64 + sizeof(WS_GUID)];
+	memcpy(concat, key.ptr, key_len);
+	memcpy(concat + key_len, WS_GUID, sizeof(WS_GUID) - 1);
+
+	uint8_t digest[20];
+	sha1((const uint8_t *)concat, key_len + sizeof(WS_GUID) - 1, digest);
+
+	char accept[32];
+	base64_encode(digest, sizeof(digest), accept);
+
+	char resp[256];
+	int n = snprintf(resp, sizeof(resp),
+			 "HTTP/1.1 101 Switching Protocols\r\n"
+			 "Upgrade: websocket\r\n"
+			 "Connection: Upgrade\r\n"
+			 "Sec-WebSocket-Accept: %s\r\n"
+			 "\r\n",
+			 accept);
+	if (n <= 0)
+		return false;
+
+	tbar_conn_write(c, resp, (size_t)n);
+	c->keep_alive = true;
+	c->websocket = true;
+	return true;
+}
+
+/* ------------------------------ */
+/* Framing                        */
+/* ------------------------------ */
+
+/* Writes the header of an unmasked frame to hdr[0..10) and returns its length */
+static size_t frame_header(uint8_t *hdr, uint8_t opcode, size_t len)
+{
+	hdr[0] = 0x80 | opcode; /* FIN, never fragmented */
+	if (len < 126) {
+		hdr[1] = (uint8_t)len;
+		return 2;
+	}
+	if (len <= 0xFFFF) {
+		hdr[1] = 126;
+		hdr[2] = (uint8_t)(len >> 8);
+		hdr[3] = (uint8_t)len;
+		return 4;
+	}
+	hdr[1] = 127;
+	for (int i = 0; i < 8; i++)
+		hdr[2 + i] = (uint8_t)((uint64_t)len >> (56 - i * 8));
+	return 10;
+}
+
+static bool send_frame(struct tbar_conn *c, uint8_t opcode, const void *data, size_t len)
+{
+	uint8_t hdr[10];
+	size_t hdr_len = frame_header(hdr, opcode, len);
+	return tbar_conn_write(c, hdr, hdr_len) && tbar_conn_write(c, data, len);
+}
+
+bool tbar_ws_send_text(struct tbar_conn *c, const char *data, size_t len)
+{
+	return send_frame(c, WS_OP_TEXT, data, len);
+}
+
+void tbar_ws_broadcast_text(struct tbar_conn *conns, int count, int tag, const char *data, size_t len)
+{
+	char *frame = malloc(len + 10);
+	if (!frame)
+		return;
+	size_t hdr_len = frame_header((uint8_t *)frame, WS_OP_TEXT, len);
+	memcpy(frame + hdr_len, data, len);
+	struct tbar_shared_buf *buf = tbar_shared_buf_create(frame, hdr_len + len, tag);
+	free(frame);
+	if (!buf)
+		return;
+
+	for (int i = 0; i < count; i++) {
+		struct tbar_conn *c = &conns[i];
+		if (!c->in_use || !c->websocket || c->closing)
+			continue;
+		if (tbar_conn_replace_shared(c, buf) || c->out_pending >= TBAR_WS_MAX_BACKLOG)
+			continue;
+		tbar_conn_write_shared(c, buf);
+	}
+	tbar_shared_buf_release(buf);
+}
+
+void tbar_ws_send_ping(struct tbar_conn *c)
+{
+	send_frame(c, WS_OP_PING, NULL, 0);
+}
+
+void tbar_ws_send_close(struct tbar_conn *c, uint16_t code)
+{
+	uint8_t payload[2] = {(uint8_t)(code >> 8), (uint8_t)code};
+	send_frame(c, WS_OP_CLOSE, payload, sizeof(payload));
+	c->closing = true;
+}
+
+size_t tbar_ws_process(struct tbar_conn *c, char *buf, size_t avail)
+{
+	uint8_t *p = (uint8_t *)buf;
+	if (avail < 2)
+		return 0;
+
+	bool fin = (p[0] & 0x80) != 0;
+	uint8_t opcode = p[0] & 0x0F;
+	bool masked = (p[1] & 0x80) != 0;
+	uint64_t len = p[1] & 0x7F;
+	size_t hdr_len = 2;
+
+	if (len == 126) {
+		if (avail < 4)
+			return 0;
+		len = (uint64_t)p[2] << 8 | p[3];
+		hdr_len = 4;
+	} else if (len == 127) {
+		if (avail < 10)
+			return 0;
+		len = 0;
+		for (int i = 0; i < 8; i++)
+			len = len << 8 | p[2 + i];
+		hdr_len = 10;
+	}
+
+	/* Clients must mask and, with no extension negotiated, leave RSV1-3 clear;
+	   control frames are unfragmented and at most 125 bytes (RFC 6455 5.5) */
+	if (!masked || (p[0] & 0x70) || ((opcode & 0x8) && (len > 125 || !fin))) {
+		tbar_ws_send_close(c, WS_CLOSE_PROTOCOL);
+		return 0;
+	}
+	if (len > TBAR_CONN_IN_SIZE - 1 - hdr_len - 4) {
+		tbar_ws_send_close(c, WS_CLOSE_TOO_BIG);
+		return 0;
+	}
+
+	size_t frame_len = hdr_len + 4 + (size_t)len;
+	if (avail < frame_len)
+		return 0;
+
+	uint8_t *mask = p + hdr_len;
+	uint8_t *payload = mask + 4;
+	for (size_t i = 0; i < (size_t)len; i++)
+		payload[i] ^= mask[i & 3];
+
+	switch (opcode) {
+	case WS_OP_TEXT:
+	case WS_OP_BINARY: {
+		/* Control messages are tiny; fragmented data frames are not supported */
+		if (!fin) {
+			tbar_ws_send_close(c, WS_CLOSE_UNSUPPORTED);
+			return 0;
+		}
+		char saved = (char)payload[len];
+		payload[len] = '\0';
+		tbar_web_handle_ws_message(c, opcode == WS_OP_BINARY, (const char *)payload, (size_t)len);
+		payload[len] = (uint8_t)saved;
+		break;
+	}
+	case WS_OP_PING:
+		send_frame(c, WS_OP_PONG, payload, (size_t)len);
+		break;
+	case WS_OP_PONG:
+		break;
+	case WS_OP_CLOSE:
+		tbar_ws_send_close(c, WS_CLOSE_NORMAL);
+		break;
+	case WS_OP_CONT:
+	default:
+		tbar_ws_send_close(c, WS_CLOSE_PROTOCOL);
+		return 0;
+	}
+
+	return frame_len;
+}
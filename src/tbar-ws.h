@@ -0,0 +1,58 @@
+/*
+Plugin Name
+Copyright (C) <Year> <Developer> <Email Address>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#pragma once
+
+#include "tbar-http.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Server-side pings are sent after this long without traffic; a client that
+   stays silent for three intervals is dropped. */
+#define TBAR_WS_PING_INTERVAL_MS 15000
+
+/* Unsent bytes above which a client is skipped by tbar_ws_broadcast_text();
+   well below the input high-water mark, so pushes it has not read yet never
+   stop the server reading that client's own messages */
+#define TBAR_WS_MAX_BACKLOG 4096
+
+/* Completes the RFC 6455 handshake for an upgrade request and switches the
+   connection to frame mode. Sends 400 and returns false if the request is not
+   a valid WebSocket upgrade. */
+bool tbar_ws_accept(struct tbar_conn *c, const struct tbar_http_request *req);
+
+/* Parses one frame at `buf`. Returns the number of bytes consumed, or 0 if the
+   frame is incomplete. Data frames are passed to tbar_web_handle_ws_message(). */
+size_t tbar_ws_process(struct tbar_conn *c, char *buf, size_t avail);
+
+bool tbar_ws_send_text(struct tbar_conn *c, const char *data, size_t len);
+/* Queues one text frame on every WebSocket client in conns[0..count), latest
+   wins: a frame with the same `tag` still waiting at the end of a client's
+   queue is replaced, and a client over TBAR_WS_MAX_BACKLOG is skipped */
+void tbar_ws_broadcast_text(struct tbar_conn *conns, int count, int tag, const char *data, size_t len);
+void tbar_ws_send_ping(struct tbar_conn *c);
+void tbar_ws_send_close(struct tbar_conn *c, uint16_t code);
+
+/* Message handler, implemented in tbar-web.c. Text payloads are NUL-terminated. */
+void tbar_web_handle_ws_message(struct tbar_conn *c, bool binary, const char *data, size_t len);
+
+#ifdef __cplusplus
+}
+#endif